@@ -3,6 +3,9 @@ QT += printsupport
 
 CONFIG += c++17
 
+# zlib writes the rotated log archives as gzip
+LIBS += -lz
+
 RESOURCES += resources.qrc
 
 SOURCES += \
@@ -18,22 +21,31 @@ SOURCES += \
     gaslist.cpp \
     buhlmann.cpp \
     compartments.cpp \
+    dive_site.cpp \
     oxygen_toxicity.cpp \
     stop_steps.cpp \
     set_points.cpp \
     dive_step.cpp \
     dive_plan.cpp \
+    dive_plan_file.cpp \
+    plan_library.cpp \
+    plan_speculator.cpp \
+    compute_pool.cpp \
     parameters_gui.cpp \
     gaslist_gui.cpp \
     dive_plan_dialog.cpp \
     dive_plan_gui.cpp \
     dive_plan_gui_compartment_graph.cpp \
+    dive_plan_gui_saturation_map.cpp \
+    dive_plan_gui_gas_consumption.cpp \
+    plot_lod.cpp \
     dive_plan_gui_stopsteps.cpp \
     dive_plan_gui_plantables.cpp \
     dive_plan_gui_menu.cpp \
     dive_plan_gui_gaslist.cpp \
     dive_plan_gui_setpoints.cpp \
     dive_plan_gui_summary.cpp \
+    plan_library_gui.cpp \
     main_gui.cpp
 
 HEADERS += \
@@ -43,6 +55,8 @@ HEADERS += \
     qcustomplot.hpp \
     error_handler.hpp \
     global.hpp \
+    core_config.hpp \
+    fixed_vector.hpp \
     table_helper.hpp \
     enum.hpp \
     constants.hpp \
@@ -51,16 +65,27 @@ HEADERS += \
     gaslist.hpp \
     buhlmann.hpp \
     compartments.hpp \
+    dive_site.hpp \
+    tissue_kernel.hpp \
     oxygen_toxicity.hpp \
     stop_steps.hpp \
     set_points.hpp \
     dive_step.hpp \
     dive_plan.hpp \
+    dive_plan_file.hpp \
+    plan_library.hpp \
+    plan_speculator.hpp \
+    compute_pool.hpp \
     parameters_gui.hpp \
     gaslist_gui.hpp \
     dive_plan_dialog.hpp \
     dive_plan_gui.hpp \
     dive_plan_gui_compartment_graph.hpp \
+    dive_plan_gui_saturation_map.hpp \
+    dive_plan_gui_gas_consumption.hpp \
+    lod_levels.hpp \
+    plot_lod.hpp \
+    plan_library_gui.hpp \
     ui_utils.hpp \
     main_gui.hpp
 
@@ -0,0 +1,538 @@
+#include "batch_planner.hpp"
+#include "dive_plan.hpp"
+#include "log_info.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <iomanip>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QElapsedTimer>
+
+namespace DiveComputer {
+
+// SPEC PARSING
+
+static std::vector<std::string> splitString(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::string part;
+    std::istringstream ss(text);
+    while (std::getline(ss, part, separator)) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+static std::string trimString(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+static std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+static bool parseNumber(const std::string& text, double& value) {
+    try {
+        size_t used = 0;
+        value = std::stod(text, &used);
+        return used == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+static bool parseMode(const std::string& text, int32_t& mode) {
+    std::string lower = toLower(text);
+    if (lower == "oc") { mode = static_cast<int32_t>(diveMode::OC); return true; }
+    if (lower == "cc") { mode = static_cast<int32_t>(diveMode::CC); return true; }
+    return false;
+}
+
+static bool parseGasType(const std::string& text, int32_t& type) {
+    std::string lower = toLower(text);
+    if (lower == "bottom" || lower == "b") { type = static_cast<int32_t>(GasType::BOTTOM); return true; }
+    if (lower == "deco" || lower == "d") { type = static_cast<int32_t>(GasType::DECO); return true; }
+    if (lower == "diluent" || lower == "dil") { type = static_cast<int32_t>(GasType::DILUENT); return true; }
+    return false;
+}
+
+static bool parseWaterType(const std::string& text, int32_t& type) {
+    std::string lower = toLower(text);
+    if (lower == "salt" || lower == "s") { type = static_cast<int32_t>(WaterType::SALT); return true; }
+    if (lower == "fresh" || lower == "f") { type = static_cast<int32_t>(WaterType::FRESH); return true; }
+    return false;
+}
+
+static DivePlanFileGas defaultGas() {
+    // Same tank as a gas added in the GUI
+    GasAvailable available(Gas(g_constants.m_oxygenInAir, 0.0, GasType::BOTTOM, GasStatus::ACTIVE));
+    DivePlanFileGas gas;
+    gas.m_o2Percent = g_constants.m_oxygenInAir;
+    gas.m_gasType = static_cast<int32_t>(GasType::BOTTOM);
+    gas.m_gasStatus = static_cast<int32_t>(GasStatus::ACTIVE);
+    gas.m_nbTanks = available.m_nbTanks;
+    gas.m_tankCapacity = available.m_tankCapacity;
+    gas.m_fillingPressure = available.m_fillingPressure;
+    gas.m_reservePressure = available.m_reservePressure;
+    gas.m_endPressure = available.m_endPressure;
+    return gas;
+}
+
+// "o2/he", the mix of a gas
+static bool parseGasMix(const std::string& text, DivePlanFileGas& gas) {
+    std::vector<std::string> mix = splitString(text, '/');
+    if (mix.empty() || mix.size() > 2) return false;
+    if (!parseNumber(mix[0], gas.m_o2Percent)) return false;
+    gas.m_hePercent = 0.0;
+    return mix.size() == 1 || parseNumber(mix[1], gas.m_hePercent);
+}
+
+static void setDefaultInputs(PlanSpec& spec) {
+    DivePlanFileInputs& inputs = spec.m_inputs;
+    inputs.m_mode = static_cast<int32_t>(diveMode::OC);
+    inputs.m_bailout = false;
+    inputs.m_boosted = true;
+    inputs.m_diveNumber = 1;
+    inputs.m_mission = 0.0;
+    inputs.m_gf[0] = g_parameters.m_gf[0];
+    inputs.m_gf[1] = g_parameters.m_gf[1];
+    inputs.m_waterType = static_cast<int32_t>(WaterType::SALT);
+    inputs.m_surfacePressure = g_parameters.m_atmPressure;
+}
+
+// Values left out of the spec, and checks that would otherwise fail inside the pipeline
+static void completeInputs(PlanSpec& spec) {
+    DivePlanFileInputs& inputs = spec.m_inputs;
+
+    if (inputs.m_gases.empty()) {
+        inputs.m_gases.push_back(defaultGas());
+    }
+    if (inputs.m_setPoints.empty()) {
+        SetPoints defaults;
+        for (size_t i = 0; i < defaults.nbOfSetPoints(); ++i) {
+            inputs.m_setPoints.emplace_back(defaults.m_depths[i], defaults.m_setPoints[i]);
+        }
+    }
+
+    // Saturated at the surface of the site
+    CompartmentPressures initialPressure = compartmentPPinitialAt(inputs.m_surfacePressure);
+    inputs.m_initialPressure.assign(initialPressure.begin(), initialPressure.end());
+
+    if (inputs.m_stopSteps.empty()) {
+        spec.m_error = "missing stops";
+    } else if (inputs.m_gf[0] <= 0.0 || inputs.m_gf[1] > 100.0 || inputs.m_gf[0] > inputs.m_gf[1]) {
+        spec.m_error = "invalid gradient factors";
+    }
+    if (inputs.m_surfacePressure <= 0.0) {
+        spec.m_error = "invalid surface pressure";
+    }
+    for (const auto& stopStep : inputs.m_stopSteps) {
+        if (stopStep.first <= 0.0 || stopStep.second < 0.0) spec.m_error = "invalid stop";
+    }
+    for (const auto& gas : inputs.m_gases) {
+        if (gas.m_o2Percent <= 0.0 || gas.m_hePercent < 0.0 || gas.m_o2Percent + gas.m_hePercent > 100.0) {
+            spec.m_error = "invalid gas";
+        }
+    }
+}
+
+static void parseJsonSpec(const std::string& line, PlanSpec& spec) {
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromStdString(line), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        spec.m_error = "invalid JSON: " + parseError.errorString().toStdString();
+        return;
+    }
+
+    QJsonObject object = document.object();
+    DivePlanFileInputs& inputs = spec.m_inputs;
+
+    // Numbers are accepted as identifiers too
+    QJsonValue id = object.value("id");
+    spec.m_id = id.isDouble() ? QString::number(id.toDouble()).toStdString() : id.toString().toStdString();
+
+    if (object.contains("mode") && !parseMode(object.value("mode").toString().toStdString(), inputs.m_mode)) {
+        spec.m_error = "invalid mode";
+        return;
+    }
+
+    QJsonArray gf = object.value("gf").toArray();
+    if (gf.size() == 2) {
+        inputs.m_gf[0] = gf.at(0).toDouble();
+        inputs.m_gf[1] = gf.at(1).toDouble();
+    }
+
+    for (const QJsonValue& value : object.value("stops").toArray()) {
+        QJsonArray stop = value.toArray();
+        inputs.m_stopSteps.emplace_back(stop.at(0).toDouble(), stop.at(1).toDouble());
+    }
+
+    for (const QJsonValue& value : object.value("setpoints").toArray()) {
+        QJsonArray setPoint = value.toArray();
+        inputs.m_setPoints.emplace_back(setPoint.at(0).toDouble(), setPoint.at(1).toDouble());
+    }
+
+    for (const QJsonValue& value : object.value("gases").toArray()) {
+        DivePlanFileGas gas = defaultGas();
+        if (value.isString()) {
+            if (!parseGasMix(value.toString().toStdString(), gas)) {
+                spec.m_error = "invalid gas";
+                return;
+            }
+        } else {
+            QJsonObject gasObject = value.toObject();
+            gas.m_o2Percent = gasObject.value("o2").toDouble(gas.m_o2Percent);
+            gas.m_hePercent = gasObject.value("he").toDouble(0.0);
+            if (gasObject.contains("type") && !parseGasType(gasObject.value("type").toString().toStdString(), gas.m_gasType)) {
+                spec.m_error = "invalid gas type";
+                return;
+            }
+            gas.m_nbTanks = gasObject.value("tanks").toInt(gas.m_nbTanks);
+            gas.m_tankCapacity = gasObject.value("capacity").toDouble(gas.m_tankCapacity);
+            gas.m_fillingPressure = gasObject.value("filling").toDouble(gas.m_fillingPressure);
+            gas.m_reservePressure = gasObject.value("reserve").toDouble(gas.m_reservePressure);
+        }
+        gas.m_endPressure = gas.m_fillingPressure;
+        inputs.m_gases.push_back(gas);
+    }
+
+    inputs.m_bailout = object.value("bailout").toBool(inputs.m_bailout);
+    inputs.m_boosted = object.value("boosted").toBool(inputs.m_boosted);
+    inputs.m_waypoints = object.value("waypoints").toBool(inputs.m_waypoints);
+    inputs.m_mission = object.value("mission").toDouble(inputs.m_mission);
+    inputs.m_diveNumber = object.value("diveNumber").toInt(inputs.m_diveNumber);
+
+    if (object.contains("water") && !parseWaterType(object.value("water").toString().toStdString(), inputs.m_waterType)) {
+        spec.m_error = "invalid water";
+        return;
+    }
+    inputs.m_surfacePressure = object.value("surfacePressure").toDouble(inputs.m_surfacePressure);
+}
+
+// Space separated "a:b" pairs
+static bool parsePairs(const std::string& text, std::vector<std::pair<double, double>>& pairs) {
+    for (const std::string& item : splitString(text, ' ')) {
+        std::vector<std::string> values = splitString(item, ':');
+        double first, second;
+        if (values.size() != 2 || !parseNumber(values[0], first) || !parseNumber(values[1], second)) return false;
+        pairs.emplace_back(first, second);
+    }
+    return true;
+}
+
+static void parseCsvSpec(const std::string& line, PlanSpec& spec) {
+    // Empty columns are kept, so a column can be left to its default
+    std::vector<std::string> columns;
+    std::string column;
+    std::istringstream ss(line);
+    while (std::getline(ss, column, ',')) {
+        columns.push_back(trimString(column));
+    }
+    if (!line.empty() && line.back() == ',') {
+        columns.push_back("");
+    }
+
+    enum { ID, MODE, GF_LOW, GF_HIGH, STOPS, GASES, SET_POINTS, BAILOUT, WATER, SURFACE_PRESSURE };
+    if (columns.size() <= GASES) {
+        spec.m_error = "expected id,mode,gfLow,gfHigh,stops,gases[,setpoints[,bailout[,water[,surfacePressure]]]]";
+        return;
+    }
+
+    DivePlanFileInputs& inputs = spec.m_inputs;
+    spec.m_id = columns[ID];
+
+    if (!columns[MODE].empty() && !parseMode(columns[MODE], inputs.m_mode)) {
+        spec.m_error = "invalid mode";
+        return;
+    }
+    if ((!columns[GF_LOW].empty() && !parseNumber(columns[GF_LOW], inputs.m_gf[0])) ||
+        (!columns[GF_HIGH].empty() && !parseNumber(columns[GF_HIGH], inputs.m_gf[1]))) {
+        spec.m_error = "invalid gradient factors";
+        return;
+    }
+    if (!parsePairs(columns[STOPS], inputs.m_stopSteps)) {
+        spec.m_error = "invalid stops";
+        return;
+    }
+
+    for (const std::string& item : splitString(columns[GASES], ' ')) {
+        std::vector<std::string> fields = splitString(item, ':');
+        DivePlanFileGas gas = defaultGas();
+        double tanks = gas.m_nbTanks;
+        bool ok = !fields.empty() && parseGasMix(fields[0], gas) &&
+                  (fields.size() < 2 || parseGasType(fields[1], gas.m_gasType)) &&
+                  (fields.size() < 3 || parseNumber(fields[2], tanks)) &&
+                  (fields.size() < 4 || parseNumber(fields[3], gas.m_tankCapacity)) &&
+                  (fields.size() < 5 || parseNumber(fields[4], gas.m_fillingPressure)) &&
+                  (fields.size() < 6 || parseNumber(fields[5], gas.m_reservePressure));
+        if (!ok || fields.size() > 6) {
+            spec.m_error = "invalid gas " + item;
+            return;
+        }
+        gas.m_nbTanks = static_cast<int32_t>(tanks);
+        gas.m_endPressure = gas.m_fillingPressure;
+        inputs.m_gases.push_back(gas);
+    }
+
+    if (columns.size() > SET_POINTS && !parsePairs(columns[SET_POINTS], inputs.m_setPoints)) {
+        spec.m_error = "invalid setpoints";
+        return;
+    }
+    if (columns.size() > BAILOUT && !columns[BAILOUT].empty()) {
+        std::string bailout = toLower(columns[BAILOUT]);
+        inputs.m_bailout = (bailout == "1" || bailout == "true" || bailout == "yes");
+    }
+    if (columns.size() > WATER && !columns[WATER].empty() && !parseWaterType(columns[WATER], inputs.m_waterType)) {
+        spec.m_error = "invalid water";
+        return;
+    }
+    if (columns.size() > SURFACE_PRESSURE && !columns[SURFACE_PRESSURE].empty() &&
+        !parseNumber(columns[SURFACE_PRESSURE], inputs.m_surfacePressure)) {
+        spec.m_error = "invalid surface pressure";
+        return;
+    }
+}
+
+bool parsePlanSpec(const std::string& line, PlanSpec& spec) {
+    std::string text = trimString(line);
+    if (text.empty() || text[0] == '#' || text.compare(0, 3, "id,") == 0) {
+        return false;
+    }
+
+    spec.m_id.clear();
+    spec.m_error.clear();
+    spec.m_inputs = DivePlanFileInputs();
+    setDefaultInputs(spec);
+
+    if (text[0] == '{') {
+        parseJsonSpec(text, spec);
+    } else {
+        parseCsvSpec(text, spec);
+    }
+
+    if (spec.m_error.empty()) {
+        completeInputs(spec);
+    }
+    return true;
+}
+
+std::vector<PlanSpec> readPlanSpecs(std::istream& in, const std::string& sourceName) {
+    std::vector<PlanSpec> specs;
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        PlanSpec spec;
+        if (parsePlanSpec(line, spec)) {
+            spec.m_source = sourceName + ":" + std::to_string(lineNumber);
+            // Results of a batch are matched to their specs by id
+            if (spec.m_error.empty() && spec.m_id.empty()) {
+                spec.m_error = "missing id";
+            }
+            specs.push_back(std::move(spec));
+        }
+    }
+    return specs;
+}
+
+// RESULT FORMATTING
+
+static const char* CSV_HEADER =
+    "id,ok,error,mode,gf_low,gf_high,max_depth,run_time,tts,tts_delta,ap,max_time,max_tts,"
+    "tp,turn_tts,no_fly_time,cns,otu,stops,gases";
+
+std::string batchHeader(BatchFormat format) {
+    return (format == BatchFormat::CSV) ? CSV_HEADER : "";
+}
+
+static std::string formatError(const PlanSpec& spec, const std::string& error, BatchFormat format) {
+    if (format == BatchFormat::CSV) {
+        std::string message = error;
+        std::replace(message.begin(), message.end(), ',', ';');
+        return spec.m_id + ",0," + spec.m_source + " " + message + ",,,,,,,,,,,,,,,,,";
+    }
+
+    // The planning service leaves out the id and source, its requests are matched by their RPC id
+    QJsonObject result;
+    if (!spec.m_id.empty()) result["id"] = QString::fromStdString(spec.m_id);
+    result["ok"] = false;
+    result["error"] = QString::fromStdString(spec.m_source.empty() ? error : spec.m_source + " " + error);
+    return QJsonDocument(result).toJson(QJsonDocument::Compact).toStdString();
+}
+
+static std::string formatResult(const PlanSpec& spec, DivePlan& plan, BatchFormat format) {
+    const DiveStep& lastStep = plan.m_diveProfile.back();
+    double maxDepth = 0.0;
+    for (const DiveStep& step : plan.m_diveProfile) {
+        maxDepth = std::max(maxDepth, std::max(step.m_startDepth, step.m_endDepth));
+    }
+    double noFlyTime = plan.getNoFlyTime();
+
+    // Stops of the ascent, with the gas breathed
+    std::vector<const DiveStep*> stops;
+    for (const DiveStep& step : plan.m_diveProfile) {
+        if (step.m_phase == Phase::DECO && step.m_time > 0.0) stops.push_back(&step);
+    }
+
+    if (format == BatchFormat::CSV) {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(1);
+        ss << spec.m_id << ",1,," << getDiveModeString(plan.m_mode) << ","
+           << plan.m_gf[0] << "," << plan.m_gf[1] << ","
+           << maxDepth << "," << lastStep.m_runTime << ","
+           << plan.m_tts << "," << plan.m_ttsDelta << "," << plan.m_ap << ","
+           << plan.m_maxResult.first << "," << plan.m_maxResult.second << ","
+           << plan.m_tp << "," << plan.m_turnTts << "," << noFlyTime << ","
+           << lastStep.m_cnsTotalSingleDive << "," << lastStep.m_otuTotal << ",";
+        for (size_t i = 0; i < stops.size(); ++i) {
+            ss << (i ? " " : "") << stops[i]->m_endDepth << ":" << stops[i]->m_time;
+        }
+        ss << ",";
+        for (size_t i = 0; i < plan.m_gasAvailable.size(); ++i) {
+            const GasAvailable& gas = plan.m_gasAvailable[i];
+            ss << (i ? " " : "") << gas.m_gas.m_o2Percent << "/" << gas.m_gas.m_hePercent
+               << ":" << gas.m_consumption << ":" << gas.m_endPressure;
+        }
+        return ss.str();
+    }
+
+    QJsonObject result;
+    if (!spec.m_id.empty()) result["id"] = QString::fromStdString(spec.m_id);
+    result["ok"] = true;
+    result["mode"] = QString::fromStdString(getDiveModeString(plan.m_mode));
+    result["gf"] = QJsonArray{plan.m_gf[0], plan.m_gf[1]};
+    result["maxDepth"] = maxDepth;
+    result["runTime"] = lastStep.m_runTime;
+    result["tts"] = plan.m_tts;
+    result["ttsDelta"] = plan.m_ttsDelta;
+    result["ap"] = plan.m_ap;
+    result["maxTime"] = plan.m_maxResult.first;
+    result["maxTts"] = plan.m_maxResult.second;
+    result["tp"] = plan.m_tp;
+    result["turnTts"] = plan.m_turnTts;
+    result["noFlyTime"] = noFlyTime;
+    result["cns"] = lastStep.m_cnsTotalSingleDive;
+    result["otu"] = lastStep.m_otuTotal;
+
+    QJsonArray stopArray;
+    for (const DiveStep* stop : stops) {
+        QJsonObject stopObject;
+        stopObject["depth"] = stop->m_endDepth;
+        stopObject["time"] = stop->m_time;
+        stopObject["runTime"] = stop->m_runTime;
+        stopObject["o2"] = stop->m_o2Percent;
+        stopObject["he"] = stop->m_hePercent;
+        stopArray.append(stopObject);
+    }
+    result["stops"] = stopArray;
+
+    QJsonArray gasArray;
+    for (const GasAvailable& gas : plan.m_gasAvailable) {
+        QJsonObject gasObject;
+        gasObject["o2"] = gas.m_gas.m_o2Percent;
+        gasObject["he"] = gas.m_gas.m_hePercent;
+        gasObject["consumption"] = gas.m_consumption;
+        gasObject["endPressure"] = gas.m_endPressure;
+        gasArray.append(gasObject);
+    }
+    result["gases"] = gasArray;
+
+    return QJsonDocument(result).toJson(QJsonDocument::Compact).toStdString();
+}
+
+bool computePlanResult(const PlanSpec& spec, BatchFormat format, std::string& line) {
+    if (!spec.m_error.empty()) {
+        line = formatError(spec, spec.m_error, format);
+        return false;
+    }
+
+    try {
+        std::unique_ptr<DivePlan> plan = DivePlan::createFromInputs(spec.m_inputs);
+        plan->buildDivePlan();
+        plan->calculateDivePlan(false);
+        plan->calculateGasConsumption(false);
+        plan->calculateDiveSummary(false);
+        if (plan->m_diveProfile.empty()) {
+            line = formatError(spec, "empty dive profile", format);
+            return false;
+        }
+        line = formatResult(spec, *plan, format);
+        return true;
+    } catch (const std::exception& e) {
+        line = formatError(spec, e.what(), format);
+        return false;
+    }
+}
+
+// BATCH
+
+BatchPlanner::BatchPlanner(BatchFormat format, int threads)
+    : m_format(format), m_threads(std::max(1, threads)) {
+}
+
+int BatchPlanner::run(const std::vector<PlanSpec>& specs, std::ostream& out) {
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<std::string> results(specs.size());
+    std::vector<char> done(specs.size(), 0);
+    std::atomic<int> failed{0};
+    std::atomic<size_t> nextSpec{0};
+    std::mutex mutex;
+    std::condition_variable resultReady;
+
+    auto worker = [&]() {
+        for (size_t i = nextSpec++; i < specs.size(); i = nextSpec++) {
+            std::string result;
+            if (!computePlanResult(specs[i], m_format, result)) {
+                ++failed;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                results[i] = std::move(result);
+                done[i] = 1;
+            }
+            resultReady.notify_one();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    int nbWorkers = static_cast<int>(std::min<size_t>(m_threads, specs.size()));
+    for (int i = 0; i < nbWorkers; ++i) {
+        workers.emplace_back(worker);
+    }
+
+    // Write the results in input order as soon as they are available
+    for (size_t i = 0; i < specs.size(); ++i) {
+        std::string result;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            resultReady.wait(lock, [&] { return done[i] != 0; });
+            result.swap(results[i]);
+        }
+        out << result << '\n';
+        if (i % 64 == 63) out.flush();
+    }
+    out.flush();
+
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    logWrite("BatchPlanner::run() computed ", specs.size(), " plans on ", nbWorkers, " threads in ", timer.elapsed(), " ms");
+    return failed;
+}
+
+} // namespace DiveComputer
@@ -0,0 +1,65 @@
+#ifndef BATCH_PLANNER_HPP
+#define BATCH_PLANNER_HPP
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "dive_plan_file.hpp"
+
+namespace DiveComputer {
+
+// Plan specs are read one per line, either as a JSON object:
+//   {"id": "wreck-40", "mode": "OC", "gf": [30, 80], "stops": [[40, 25]],
+//    "gases": [{"o2": 21, "he": 35, "type": "bottom", "tanks": 2, "capacity": 12},
+//              {"o2": 50, "type": "deco"}],
+//    "setpoints": [[0, 0.7], [20, 1.3]], "bailout": false, "boosted": true, "mission": 0,
+//    "water": "fresh", "surfacePressure": 0.82, "waypoints": false}
+// or as CSV columns:
+//   id,mode,gfLow,gfHigh,stops,gases[,setpoints[,bailout[,water[,surfacePressure]]]]
+//   wreck-40,OC,30,80,40:25,21/35:bottom:2:12 50/0:deco
+// where the lists are space separated, stops are depth:time, setpoints depth:setpoint and
+// gases o2/he[:type[:tanks[:capacity[:filling[:reserve]]]]].
+// Only id and stops are required; the other values default to the parameters, air, the
+// default setpoints and salt water, the tissues saturated at the surface pressure (in bar).
+// With "waypoints", the stops are dived in their order, down and up, as logged; otherwise
+// the deepest first. Blank lines, lines starting with '#' and a CSV header starting with
+// "id," are skipped.
+
+enum class BatchFormat {
+    NDJSON,
+    CSV
+};
+
+struct PlanSpec {
+    std::string m_id;
+    std::string m_source;         // file and line, for error messages
+    DivePlanFileInputs m_inputs;
+    std::string m_error;          // set if the line could not be parsed
+};
+
+// False for skipped lines; a line that cannot be parsed gives a spec with m_error set
+bool parsePlanSpec(const std::string& line, PlanSpec& spec);
+std::vector<PlanSpec> readPlanSpecs(std::istream& in, const std::string& sourceName);
+
+// Runs the DivePlan pipeline of the GUI and formats the result, or the error, as one output line.
+// Returns false if the plan failed.
+bool computePlanResult(const PlanSpec& spec, BatchFormat format, std::string& line);
+std::string batchHeader(BatchFormat format);
+
+// Computes specs on several threads and writes their results in input order
+// as soon as each one and all those before it are done
+class BatchPlanner {
+public:
+    BatchPlanner(BatchFormat format, int threads);
+
+    // Returns the number of plans that failed
+    int run(const std::vector<PlanSpec>& specs, std::ostream& out);
+
+private:
+    BatchFormat m_format;
+    int m_threads;
+};
+
+} // namespace DiveComputer
+
+#endif // BATCH_PLANNER_HPP
@@ -33,6 +33,17 @@ const CompartmentPP compartmentAir(
     (g_constants.m_atmPressureStp - g_constants.m_pH2O) * (1.0 - g_constants.m_oxygenInAir / 100.0)
 );
 
-std::vector<CompartmentPP> compartmentPPinitialAir(NUM_COMPARTMENTS, compartmentAir);
+static CompartmentPressures initialPressures(const CompartmentPP& pressure) {
+    CompartmentPressures pressures;
+    pressures.fill(pressure);
+    return pressures;
+}
+
+CompartmentPressures compartmentPPinitialAir = initialPressures(compartmentAir);
+
+CompartmentPressures compartmentPPinitialAt(double surfacePressure) {
+    double pN2 = (surfacePressure - g_constants.m_pH2O) * (1.0 - g_constants.m_oxygenInAir / 100.0);
+    return initialPressures(CompartmentPP(pN2, 0.0, pN2));
+}
 
 } // namespace DiveComputer
\ No newline at end of file
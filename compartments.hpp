@@ -2,7 +2,8 @@
 #define COMPARTMENTS_HPP
 
 #include "constants.hpp"
-#include <vector>
+#include "enum.hpp"
+#include <array>
 
 namespace DiveComputer {
 
@@ -42,7 +43,19 @@ public:
     double m_pInert{0.0};  // Max value for Inert Gas (based on gas composition)
 };
 
-extern std::vector<CompartmentPP> compartmentPPinitialAir;
+// Partial pressures of all compartments, held in place
+using CompartmentPressures = std::array<CompartmentPP, NUM_COMPARTMENTS>;
+
+// Compartment and gas driving a ceiling or a GF at the surface, -1 when not calculated
+struct TissueLimit {
+    int m_compartment{-1};
+    LimitingGas m_gas{LimitingGas::INERT};
+};
+
+extern CompartmentPressures compartmentPPinitialAir;
+
+// Compartments saturated with air at a surface pressure, for a first dive at altitude
+CompartmentPressures compartmentPPinitialAt(double surfacePressure);
 
 } // namespace DiveComputer
 
@@ -0,0 +1,146 @@
+#include "compute_pool.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace DiveComputer {
+
+namespace {
+
+thread_local bool t_onWorkerThread = false;
+std::atomic<int> s_instanceThreads{0};
+
+} // namespace
+
+ComputePool::ComputePool(int threads) {
+    for (int i = 0; i < std::max(1, threads); i++) {
+        m_threads.emplace_back(&ComputePool::workLoop, this);
+    }
+}
+
+ComputePool::~ComputePool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskReady.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+ComputePool& ComputePool::instance() {
+    static ComputePool pool(s_instanceThreads > 0 ? s_instanceThreads.load()
+                                                  : static_cast<int>(std::max(2u, std::thread::hardware_concurrency())));
+    return pool;
+}
+
+void ComputePool::setInstanceThreads(int threads) {
+    s_instanceThreads = threads;
+}
+
+bool ComputePool::onWorkerThread() {
+    return t_onWorkerThread;
+}
+
+void ComputePool::setPriority(const void* owner, ComputePriority priority) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Client& client = m_clients[owner];
+    if (client.m_priority == priority) {
+        return;
+    }
+
+    // Queued tasks move along with their owner
+    if (!client.m_tasks.empty()) {
+        removeReady(owner, client.m_priority);
+        m_ready[static_cast<int>(priority)].push_back(owner);
+    }
+    client.m_priority = priority;
+}
+
+void ComputePool::cancel(const void* owner) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto client = m_clients.find(owner);
+    if (client == m_clients.end()) {
+        return;
+    }
+
+    // Destroyed outside the lock: dropping a task breaks its promise
+    std::deque<std::function<void()>> dropped;
+    if (!client->second.m_tasks.empty()) {
+        removeReady(owner, client->second.m_priority);
+        dropped.swap(client->second.m_tasks);
+    }
+    m_taskDone.wait(lock, [&]() { return m_clients[owner].m_running == 0; });
+    lock.unlock();
+}
+
+void ComputePool::release(const void* owner) {
+    cancel(owner);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto client = m_clients.find(owner);
+    if (client != m_clients.end() && client->second.m_tasks.empty() && client->second.m_running == 0) {
+        m_clients.erase(client);
+    }
+}
+
+void ComputePool::enqueue(std::function<void()> task, const void* owner) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Client& client = m_clients[owner];
+        if (client.m_tasks.empty()) {
+            m_ready[static_cast<int>(client.m_priority)].push_back(owner);
+        }
+        client.m_tasks.push_back(std::move(task));
+    }
+    m_taskReady.notify_one();
+}
+
+bool ComputePool::nextTask(std::function<void()>& task, const void*& owner) {
+    // First owner of the highest priority, back in line if it has more tasks
+    for (auto& ready : m_ready) {
+        if (ready.empty()) {
+            continue;
+        }
+        owner = ready.front();
+        ready.pop_front();
+
+        Client& client = m_clients[owner];
+        task = std::move(client.m_tasks.front());
+        client.m_tasks.pop_front();
+        if (!client.m_tasks.empty()) {
+            ready.push_back(owner);
+        }
+        client.m_running++;
+        return true;
+    }
+    return false;
+}
+
+void ComputePool::removeReady(const void* owner, ComputePriority priority) {
+    auto& ready = m_ready[static_cast<int>(priority)];
+    ready.erase(std::remove(ready.begin(), ready.end(), owner), ready.end());
+}
+
+void ComputePool::workLoop() {
+    t_onWorkerThread = true;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        std::function<void()> task;
+        const void* owner = nullptr;
+        m_taskReady.wait(lock, [&]() { return nextTask(task, owner) || m_stop; });
+        if (!task) {
+            break;    // stopped, and every task submitted ran
+        }
+
+        lock.unlock();
+        task();
+        task = nullptr;
+        lock.lock();
+
+        m_clients[owner].m_running--;
+        m_taskDone.notify_all();
+    }
+}
+
+} // namespace DiveComputer
@@ -0,0 +1,89 @@
+#ifndef COMPUTE_POOL_HPP
+#define COMPUTE_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace DiveComputer {
+
+// Order in which the clients of the pool get its threads
+enum class ComputePriority {
+    FOCUSED,       // window the user works in, and callers without an owner
+    VISIBLE,       // other windows on screen
+    BACKGROUND,    // hidden windows and speculative what-ifs
+};
+
+// Threads shared by the calculations of the process, one per core. Tasks belong to an owner,
+// usually a window: the owners with the highest priority run first, and owners of the same
+// priority take one task each in turn, so a window queuing many tasks does not hold up the
+// others. Tasks must not wait for other tasks of the pool: when all the threads wait, nothing
+// is left to run what they wait for. Code that may run on the pool checks onWorkerThread()
+// and calculates inline instead.
+class ComputePool {
+public:
+    explicit ComputePool(int threads);
+    ~ComputePool();
+
+    // Pool of the process, started on first use
+    static ComputePool& instance();
+
+    // Threads of the pool of the process, one per core when 0. Set before its first use.
+    static void setInstanceThreads(int threads);
+
+    // True on the threads of a pool
+    static bool onWorkerThread();
+
+    template <typename Task>
+    auto submit(Task task, const void* owner = nullptr) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> future = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); }, owner);
+        return future;
+    }
+
+    // Priority of the tasks of an owner, queued ones included
+    void setPriority(const void* owner, ComputePriority priority);
+
+    // Drops the queued tasks of an owner and returns once none runs. Their futures report a
+    // broken promise. Not for the tasks of the pool.
+    void cancel(const void* owner);
+
+    // Cancels and forgets an owner, before it is destroyed
+    void release(const void* owner);
+
+    int threadCount() const { return static_cast<int>(m_threads.size()); }
+
+private:
+    static constexpr int NUM_PRIORITIES = 3;
+
+    struct Client {
+        ComputePriority m_priority{ComputePriority::FOCUSED};
+        std::deque<std::function<void()>> m_tasks;
+        int m_running{0};
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskReady;
+    std::condition_variable m_taskDone;
+    std::unordered_map<const void*, Client> m_clients;
+    std::deque<const void*> m_ready[NUM_PRIORITIES];    // owners with queued tasks, next turn first
+    bool m_stop{false};
+    std::vector<std::thread> m_threads;
+
+    void enqueue(std::function<void()> task, const void* owner);
+    bool nextTask(std::function<void()>& task, const void*& owner);
+    void removeReady(const void* owner, ComputePriority priority);
+    void workLoop();
+};
+
+} // namespace DiveComputer
+
+#endif // COMPUTE_POOL_HPP
@@ -0,0 +1,50 @@
+#ifndef CORE_CONFIG_HPP
+#define CORE_CONFIG_HPP
+
+#include <cstddef>
+
+// Build configuration of the planning core.
+//
+// DIVECOMPUTER_EMBEDDED builds the core for microcontroller-class targets (divecomputer-core.pro):
+// - containers have a fixed capacity, so nothing is allocated once a plan is set up,
+// - nothing throws, and the core builds with -fno-exceptions,
+// - Qt, the log, the files and the time profile of the graphs are left out.
+// The summary what-ifs work on a copy of the plan, which the caller provides (DivePlan::setScratchPlan).
+//
+// The desktop build keeps std::vector and the application services.
+
+#ifdef DIVECOMPUTER_EMBEDDED
+#include "fixed_vector.hpp"
+#else
+#include <vector>
+#include <QElapsedTimer>
+#endif
+
+namespace DiveComputer {
+
+// Capacities of the embedded build
+constexpr size_t MAX_DIVE_STEPS = 160;     // ascent stops, their ascents and the gas switches
+constexpr size_t MAX_STOP_STEPS = 16;
+constexpr size_t MAX_GASES = 10;
+constexpr size_t MAX_SET_POINTS = 8;
+
+#ifdef DIVECOMPUTER_EMBEDDED
+template <typename T, size_t N>
+using CoreVector = FixedVector<T, N>;
+
+// Timings are only written to the log, which the embedded build leaves out
+class CoreTimer {
+public:
+    void start() {}
+    long long elapsed() const { return 0; }
+};
+#else
+template <typename T, size_t N>
+using CoreVector = std::vector<T>;
+
+using CoreTimer = QElapsedTimer;
+#endif
+
+} // namespace DiveComputer
+
+#endif // CORE_CONFIG_HPP
@@ -1,12 +1,21 @@
 #include "dive_plan.hpp"
+#ifndef DIVECOMPUTER_EMBEDDED
+#include "dive_plan_file.hpp"
+#include "compute_pool.hpp"
+#include <chrono>
 #include <random>
+#include <ctime>
+#endif
 
 
 namespace DiveComputer {
 
-DivePlan::DivePlan(double depth, double time, diveMode mode, int diveNumber, std::vector<CompartmentPP> initialPressure){
+DivePlan::DivePlan(double depth, double time, diveMode mode, int diveNumber, const CompartmentPressures& initialPressure){
     m_diveNumber = diveNumber;
     m_mode = mode;
+    m_gf[0] = g_parameters.m_gf[0];
+    m_gf[1] = g_parameters.m_gf[1];
+    m_site = DiveSite(WaterType::SALT, g_parameters.m_atmPressure);
 
     m_initialPressure = initialPressure;
     
@@ -20,6 +29,13 @@ DivePlan::DivePlan(double depth, double time, diveMode mode, int diveNumber, std
     buildDivePlan();
 }
 
+// Empty plan filled in by the loaders, without building a profile that would be thrown away
+DivePlan::DivePlan() : m_mode(diveMode::OC), m_firstDecoDepth(0.0) {
+    m_maxResult = std::make_pair(0.0, 0.0);
+    m_gf[0] = g_parameters.m_gf[0];
+    m_gf[1] = g_parameters.m_gf[1];
+}
+
 // Core methods
 void DivePlan::loadAvailableGases() {
     m_gasAvailable.clear();
@@ -38,15 +54,39 @@ void DivePlan::loadAvailableGases() {
     }
 }
 
+void DivePlan::reloadAvailableGases() {
+    CoreVector<GasAvailable, MAX_GASES> previous = m_gasAvailable;
+    loadAvailableGases();
+
+    // Same mix and use as before: the tanks set on the plan are kept
+    for (auto& gas : m_gasAvailable) {
+        for (const auto& old : previous) {
+            if (old.m_gas.m_o2Percent == gas.m_gas.m_o2Percent &&
+                old.m_gas.m_hePercent == gas.m_gas.m_hePercent &&
+                old.m_gas.m_gasType == gas.m_gas.m_gasType) {
+                gas.m_nbTanks = old.m_nbTanks;
+                gas.m_tankCapacity = old.m_tankCapacity;
+                gas.m_fillingPressure = old.m_fillingPressure;
+                gas.m_reservePressure = old.m_reservePressure;
+                break;
+            }
+        }
+    }
+}
+
 void DivePlan::buildDivePlan(){
+    // Depths and pressures of the site of the plan, for this thread
+    DiveSiteScope site(m_site);
+
     // Log performance
-    QElapsedTimer timer;
+    CoreTimer timer;
     timer.start();
 
     clear();
 
     // Set mode
     stepMode activeMode = (m_mode == diveMode::CC) ? stepMode::CC : stepMode::OC;
+    stepMode ascentMode = (m_mode == diveMode::CC) ? (m_bailout ? stepMode::BAILOUT : stepMode::CC) : stepMode::OC;
 
     // Add initial surface step
     auto& surfaceStep = addStep(0, 0, 0, Phase::STOP, activeMode);
@@ -54,41 +94,72 @@ void DivePlan::buildDivePlan(){
 
     if (m_stopSteps.nbOfStopSteps() == 0) return;
 
-    // Sort and get deepest stop
-    m_stopSteps.sortDescending();
-    double maxDepth = m_stopSteps.m_stopSteps[0].m_depth;
-
-    // Add descending phase and initial deep stop
-    addStep(0.0, 0.0, 0, Phase::GAS_SWITCH, activeMode);
-    addStep(0.0, maxDepth, maxDepth / g_parameters.m_maxDescentRate, Phase::DESCENDING, activeMode);
-    addStep(maxDepth, maxDepth, m_stopSteps.m_stopSteps[0].m_time, Phase::STOP, activeMode);
-    
-    // Collect all stops in one pass
-    std::set<double> allStops = { maxDepth, 0.0 };
-    
-    // Add planned stops
-    for (int i = 1; i < m_stopSteps.nbOfStopSteps(); i++) {
-        allStops.insert(m_stopSteps.m_stopSteps[i].m_depth);
+    // A plan dives its deepest stop first and the others on the ascent,
+    // a waypoint profile its stop steps in their order. The stop steps keep the order
+    // they were entered in, so that a plan can be switched back to waypoints.
+    StopSteps ordered = m_stopSteps;
+    if (!m_waypoints) {
+        ordered.sortDescending();
     }
-    
-    // Add required intermediate stops at multiples of m_depthIncrement
+    const auto& waypoints = ordered.m_stopSteps;
+    double maxDepth = m_stopSteps.maxDepth();
+
+    // Depths a deco stop can be added at, deepest first: multiples of m_depthIncrement
+    // from the first stop, and the last stop. Each ascent takes those it passes.
+    // Each stop adds at least two steps: stops that do not fit make the profile overflow too
+    CoreVector<double, MAX_DIVE_STEPS> decoDepths;
     for (double depth = calculateFirstStopDepth(maxDepth); 
          depth >= g_parameters.m_lastStopDepth; 
          depth -= g_parameters.m_depthIncrement) {
-        if (std::abs(depth - maxDepth) > 0.1) {  // Skip if already added deepest stop
-            allStops.insert(depth);
+        decoDepths.push_back(depth);
+    }
+    if (decoDepths.empty() || decoDepths.back() != g_parameters.m_lastStopDepth) {
+        decoDepths.push_back(g_parameters.m_lastStopDepth);
+    }
+
+    // The ascent from the last waypoint reached going down is the final one: it is done in
+    // the ascent mode, bailout included, and the ascents before it in the mode of the bottom
+    int lastDescent = -1;
+    double depth = 0.0;
+    for (int i = 0; i < (int) waypoints.size(); i++) {
+        if (waypoints[i].m_depth > depth) {
+            lastDescent = i;
         }
+        depth = waypoints[i].m_depth;
+    }
+
+    // Build the profile in one pass over the waypoints
+    addStep(0.0, 0.0, 0, Phase::GAS_SWITCH, activeMode);
+    depth = 0.0;
+    for (int i = 0; i < (int) waypoints.size(); i++) {
+        const StopStep& waypoint = waypoints[i];
+        stepMode mode = (i <= lastDescent) ? activeMode : ascentMode;
+
+        if (waypoint.m_depth > depth) {
+            addStep(depth, waypoint.m_depth, (waypoint.m_depth - depth) / g_parameters.m_maxDescentRate, Phase::DESCENDING, mode);
+            addStep(waypoint.m_depth, waypoint.m_depth, waypoint.m_time, Phase::STOP, mode);
+        } else if (waypoint.m_depth == depth && m_diveProfile.back().m_phase == Phase::STOP) {
+            m_diveProfile.back().m_time += waypoint.m_time;    // same depth again, the stop goes on
+        } else {
+            if (waypoint.m_depth < depth) {
+                addAscent(depth, waypoint.m_depth, decoDepths.data(), decoDepths.size(), mode);
+            }
+            addStep(waypoint.m_depth, waypoint.m_depth, waypoint.m_time, Phase::STOP, mode);
+
+            // A deco stop can follow, unless the diver goes down again from there
+            bool descentNext = i + 1 < (int) waypoints.size() && waypoints[i + 1].m_depth > waypoint.m_depth;
+            if (waypoint.m_depth > 0 && !descentNext) {
+                addStep(waypoint.m_depth, waypoint.m_depth, 0, Phase::DECO, mode);
+            }
+        }
+        depth = waypoint.m_depth;
+    }
+
+    // Final ascent to the surface
+    if (depth > 0) {
+        addAscent(depth, 0.0, decoDepths.data(), decoDepths.size(), ascentMode);
+        addStep(0.0, 0.0, 0, Phase::STOP, ascentMode);
     }
-    
-    // Add last stop depth if needed
-    allStops.insert(g_parameters.m_lastStopDepth);
-    
-    // Convert to vector and sort descending
-    std::vector<double> ascentStops(allStops.begin(), allStops.end());
-    std::sort(ascentStops.begin(), ascentStops.end(), std::greater<double>());
-    
-    // Build the profile
-    processAscentStops(ascentStops);
 
     // Initialise the ppActual for Step 0
     m_diveProfile[0].m_ppActual = m_initialPressure;
@@ -98,34 +169,27 @@ void DivePlan::buildDivePlan(){
 }
 
 void DivePlan::calculateDivePlan(bool printLog) {
+    DiveSiteScope site(m_site);
+
     if (m_diveProfile.empty()) return;
 
     // Log performance
-    QElapsedTimer timer;
+    CoreTimer timer;
     timer.start();
     if (printLog) {
         logWrite("DivePlan::calculate() - START");
     }
 
-    m_firstDecoDepth = 0;
-
-    // First pass at the deco plan
+    // Predict the first deco stop from the tissues loaded on the bottom gases
     updatePpAmb();
     clearDecoSteps();
-    updateStepsPhaseFromFirstDeco();
-    applyGases();
-    applyGF();
-    calculatePPInertGas();
-    calculatePPInertGasMax();
-
-    // Returns the first deco stop, required for applying the GF
-    setFirstDecoDepth();
+    m_firstDecoDepth = predictFirstDecoDepth();
 
     // Update phase from first deco
-    // Re-apply gases after the first deco is found as the maxPPo2 will have changed for deco steps
-    // Re-calculate ppInertGas for all steps after re-applying the gas
+    // Apply the gases with the deco maxPPo2 for the deco steps
+    // Calculate ppInertGas for all steps
     // Apply the gradient factor to each step based on first deco stop determined
-    // Re-calculate the pp_max values for each step adjusted for the GF
+    // Calculate the pp_max values for each step adjusted for the GF
     updateStepsPhaseFromFirstDeco();
     applyGases();
     calculatePPInertGas();
@@ -136,7 +200,18 @@ void DivePlan::calculateDivePlan(bool printLog) {
     calculateDecoSteps();
     updateStepsPhaseFromFirstDeco();
     calculateOtherVariables(100, printLog); // GF 100 for ceiling
-    calculateTimeProfile(printLog);
+#ifndef DIVECOMPUTER_EMBEDDED
+    // Only the graphs and the files use the time profile, it is sampled again when next read
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_lazyLock.m_mutex);
+        m_timeProfileSource.reset();
+        m_timeProfile.reset();
+        m_timeProfileStale = true;
+        m_saturationMap.reset();
+    }
+#endif
+    m_revision++;
+    m_parametersEpoch = g_parameters.epoch();
 
     // Monitor performance
     if (printLog) {
@@ -146,21 +221,21 @@ void DivePlan::calculateDivePlan(bool printLog) {
 }
 
 void DivePlan::calculateOtherVariables(double GF, bool printLog){
+    DiveSiteScope site(m_site);
+
     // Log performance
-    QElapsedTimer timer;
+    CoreTimer timer;
     timer.start();
 
     updateStepsPhaseFromFirstDeco();
 
+    int stepsAboveO2Table = 0;
     for (int i = 0; i < nbOfSteps(); i++){
-        m_diveProfile[i].updatePAmb();
-        m_diveProfile[i].updateCeiling(GF);        
-        m_diveProfile[i].updateConsumption();
-        m_diveProfile[i].m_pO2Max = m_diveProfile[i].m_pAmbMax * m_diveProfile[i].m_o2Percent / 100.0;
-        m_diveProfile[i].m_n2Percent = 100.0 - m_diveProfile[i].m_o2Percent - m_diveProfile[i].m_hePercent;
-        m_diveProfile[i].updateGFSurface(&m_diveProfile[nbOfSteps() - 1]);
-        m_diveProfile[i].updateDensity();
-        m_diveProfile[i].updateEND();
+        m_diveProfile[i].updateMetrics(&m_diveProfile[nbOfSteps() - 1], GF);
+
+        if (m_diveProfile[i].m_time > 0 && g_oxygenToxicity.isAboveTable(m_diveProfile[i].m_pO2Max)) {
+            stepsAboveO2Table++;
+        }
 
         if (i > 0){
             m_diveProfile[i].updateOxygenToxicity(&m_diveProfile[i - 1]);
@@ -171,77 +246,184 @@ void DivePlan::calculateOtherVariables(double GF, bool printLog){
         }
     }
 
+    // Report once per plan rather than for each ppO2 evaluated
+    if (printLog && stepsAboveO2Table > 0) {
+        logWrite("WARNING: ppO2 is greater than the highest ppO2 value in the NOAA table for oxygen toxicity on ", stepsAboveO2Table, " step(s)");
+    }
+
     // Monitor performance
     if (printLog) {
         logWrite("DivePlan::updateVariables() took ", timer.elapsed(), " ms");
     }
 }
 
-void DivePlan::calculateTimeProfile(bool printLog){
-    // Log performance
-    QElapsedTimer timer;
-    timer.start();
-    
-    double time_increment = g_parameters.m_timeIncrementDeco;
-    int total_time_steps = (int) (m_diveProfile[nbOfSteps() - 1].m_runTime / time_increment);
+DiveStep DivePlan::sampleStep(int index, double elapsed, const DiveStep& previousSample) const {
+    // State of the step elapsed minutes after its start, the tissues being loaded from the end of the previous step
+    const DiveStep& step = m_diveProfile[index];
+    const DiveStep& previousStep = m_diveProfile[index - 1];
+    double fraction = (step.m_time > 0) ? elapsed / step.m_time : 1.0;
+
+    DiveStep sample = step;
+    sample.m_endDepth = step.m_startDepth + (step.m_endDepth - step.m_startDepth) * fraction;
+    sample.m_pAmbEndDepth = step.m_pAmbStartDepth + (step.m_pAmbEndDepth - step.m_pAmbStartDepth) * fraction;
+    sample.calculatePPInertGasForStep(previousStep, elapsed);
+
+    // Oxygen exposure integrated exactly from the start of the step
+    double ppO2Start = step.m_pAmbStartDepth * step.m_o2Percent / 100.0;
+    double ppO2Now = sample.m_pAmbEndDepth * step.m_o2Percent / 100.0;
+    sample.m_cnsTotalSingleDive = previousStep.m_cnsTotalSingleDive + g_oxygenToxicity.getCNSForRamp(ppO2Start, ppO2Now, elapsed, true);
+    sample.m_cnsTotalMultipleDives = previousStep.m_cnsTotalMultipleDives + g_oxygenToxicity.getCNSForRamp(ppO2Start, ppO2Now, elapsed, false);
+    sample.m_otuTotal = previousStep.m_otuTotal + g_oxygenToxicity.getOTUForRamp(ppO2Start, ppO2Now, elapsed);
+
+    // The sample covers the time since the previous one
+    sample.m_startDepth = previousSample.m_endDepth;
+    sample.m_runTime = step.m_runTime - step.m_time + elapsed;
+    sample.m_time = sample.m_runTime - previousSample.m_runTime;
+    sample.m_cnsStepSingleDive = sample.m_cnsTotalSingleDive - previousSample.m_cnsTotalSingleDive;
+    sample.m_cnsStepMultipleDives = sample.m_cnsTotalMultipleDives - previousSample.m_cnsTotalMultipleDives;
+    sample.m_otuStep = sample.m_otuTotal - previousSample.m_otuTotal;
+
+    // Consumption, ceiling (GF 100), GF surface, density and END of the sample
+    sample.updateMetrics(&m_diveProfile[m_diveProfile.size() - 1], 100);
+    return sample;
+}
 
-    m_timeProfile.clear();
-    m_timeProfile.resize(total_time_steps);
+#ifndef DIVECOMPUTER_EMBEDDED
+// Adaptive time profile: an interval between two samples is split in two while the state at its
+// middle is further than these from the straight line joining its ends
+static constexpr double SAMPLE_PRESSURE_TOLERANCE = 0.01;    // bar, inert gas of any compartment
+static constexpr double SAMPLE_CEILING_TOLERANCE = 0.1;      // m
+static constexpr double SAMPLE_GF_SURFACE_TOLERANCE = 0.5;   // %
+static constexpr double SAMPLE_MIN_INTERVAL = 0.1;           // min
 
-    int diveplan_index = 0;
-    int timeplan_index = 0;
-        
-    double run_time = time_increment;
-    double CNS_total_single_dive = 0;
-    double CNS_total_multiple_dives = 0;
-    double OTU_total = 0;
+// Columns of the saturation map, whatever the length of the dive
+static constexpr int SATURATION_MAP_COLUMNS = 1024;
 
-    for (diveplan_index = 1; diveplan_index < nbOfSteps(); diveplan_index++){
-        double diveplan_start_time = m_diveProfile[diveplan_index].m_runTime - m_diveProfile[diveplan_index].m_time;
-        double diveplan_end_time = m_diveProfile[diveplan_index].m_runTime;
+static bool isCurved(const DiveStep& from, const DiveStep& middle, const DiveStep& to) {
+    if (std::abs(middle.m_ceiling - (from.m_ceiling + to.m_ceiling) / 2.0) > SAMPLE_CEILING_TOLERANCE) return true;
+    if (std::abs(middle.m_gfSurface - (from.m_gfSurface + to.m_gfSurface) / 2.0) > SAMPLE_GF_SURFACE_TOLERANCE) return true;
 
-        while (diveplan_start_time < run_time && run_time <= diveplan_end_time){
-            m_timeProfile[timeplan_index] = m_diveProfile[diveplan_index];
-            
-            // Only adjusts the values which are dependant on time
-            m_timeProfile[timeplan_index].m_time = time_increment;
-            m_timeProfile[timeplan_index].m_runTime = run_time;
-
-            m_timeProfile[timeplan_index].m_stepConsumption = m_timeProfile[timeplan_index].m_ambConsumptionAtDepth * time_increment;
-            
-            m_timeProfile[timeplan_index].m_cnsStepSingleDive = 
-                (m_timeProfile[timeplan_index].m_cnsMaxMinSingleDive != 0) ? 100 * time_increment / m_timeProfile[timeplan_index].m_cnsMaxMinSingleDive : 0;
-            CNS_total_single_dive += m_timeProfile[timeplan_index].m_cnsStepSingleDive;
-            m_timeProfile[timeplan_index].m_cnsTotalSingleDive = CNS_total_single_dive;
-
-            m_timeProfile[timeplan_index].m_cnsStepMultipleDives = 
-                (m_timeProfile[timeplan_index].m_cnsMaxMinMultipleDives != 0) ? 100 * time_increment / m_timeProfile[timeplan_index].m_cnsMaxMinMultipleDives : 0;
-            CNS_total_multiple_dives += m_timeProfile[timeplan_index].m_cnsStepMultipleDives;
-            m_timeProfile[timeplan_index].m_cnsTotalMultipleDives = CNS_total_multiple_dives;
+    for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+        if (std::abs(middle.m_ppActual[j].m_pN2 - (from.m_ppActual[j].m_pN2 + to.m_ppActual[j].m_pN2) / 2.0) > SAMPLE_PRESSURE_TOLERANCE ||
+            std::abs(middle.m_ppActual[j].m_pHe - (from.m_ppActual[j].m_pHe + to.m_ppActual[j].m_pHe) / 2.0) > SAMPLE_PRESSURE_TOLERANCE) {
+            return true;
+        }
+    }
+    return false;
+}
 
-            m_timeProfile[timeplan_index].m_otuStep = time_increment * m_timeProfile[timeplan_index].m_otuPerMin;
-            OTU_total += m_timeProfile[timeplan_index].m_otuStep;
-            m_timeProfile[timeplan_index].m_otuTotal = OTU_total;
+void DivePlan::calculateTimeProfile(bool printLog) const {
+    DiveSiteScope site(m_site);
+    std::lock_guard<std::recursive_mutex> lock(m_lazyLock.m_mutex);
 
-            double pp_time = run_time - (m_diveProfile[diveplan_index].m_runTime - m_diveProfile[diveplan_index].m_time);
-            m_timeProfile[timeplan_index].calculatePPInertGasForStep(m_diveProfile[diveplan_index], pp_time);
+    // Log performance
+    CoreTimer timer;
+    timer.start();
 
-            timeplan_index++;
-            run_time += time_increment;
+    m_timeProfileSource.reset();
+    m_timeProfileStale = false;
+    m_timeProfileEpoch = g_parameters.epoch();
+
+    // A sample at the end of every step, gas switches included, and in between only where
+    // the tissues, the ceiling or the GF surface do not follow a straight line
+    auto samples = std::make_shared<std::vector<DiveStep>>();
+    for (int i = 1; i < (int) m_diveProfile.size(); i++){
+        const DiveStep& step = m_diveProfile[i];
+        if (step.m_time <= 0 && step.m_phase != Phase::GAS_SWITCH) {
+            continue;
         }
-    }
 
-    for (int i = 0; i < total_time_steps; i++){
-        m_timeProfile[i].updateGFSurface(&m_diveProfile[nbOfSteps() - 1]);
-        m_timeProfile[i].updateCeiling(100);
+        addTimeSamples(*samples, i, 0.0, sampleStep(i, 0.0, m_diveProfile[i - 1]), step.m_time, sampleStep(i, step.m_time, m_diveProfile[i - 1]));
     }
+    m_saturationMap = buildSaturationMap(*samples);
+    m_timeProfile = std::move(samples);
 
     // Monitor performance
     if (printLog) {
-        logWrite("DivePlan::updateTimeProfile() took ", timer.elapsed(), " ms");
+        logWrite("DivePlan::updateTimeProfile() took ", timer.elapsed(), " ms, ", m_timeProfile->size(), " samples");
+    }
+
+}
+
+void DivePlan::addTimeSamples(std::vector<DiveStep>& samples, int index, double from, const DiveStep& fromState, double to, const DiveStep& toState) const {
+    // Split [from, to] of the step until the states in between are close to linear, then add the sample at its end
+    double middle = (from + to) / 2.0;
+    if (to - from > SAMPLE_MIN_INTERVAL) {
+        DiveStep middleState = sampleStep(index, middle, m_diveProfile[index - 1]);
+        if (isCurved(fromState, middleState, toState)) {
+            addTimeSamples(samples, index, from, fromState, middle, middleState);
+            addTimeSamples(samples, index, middle, middleState, to, toState);
+            return;
+        }
     }
 
+    // Consumption and O2 exposure of the sample are over the time since the last one
+    const DiveStep& lastSample = (samples.empty()) ? m_diveProfile[index - 1] : samples.back();
+    samples.push_back(sampleStep(index, to, lastSample));
+}
+
+std::shared_ptr<const SaturationMap> DivePlan::buildSaturationMap(const std::vector<DiveStep>& samples) {
+    // Evenly spaced columns interpolated between the samples of the time profile, which are
+    // close to linear in between, in one sweep over the samples
+    auto map = std::make_shared<SaturationMap>();
+    if (samples.size() < 2) {
+        return map;
+    }
+
+    // Coefficients of the compartments side by side, so the inner loop has no branch
+    double aN2[NUM_COMPARTMENTS], bN2[NUM_COMPARTMENTS], aHe[NUM_COMPARTMENTS], bHe[NUM_COMPARTMENTS];
+    for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+        const CompartmentParameters& compartment = g_buhlmannModel.getCompartment(j);
+        aN2[j] = compartment.m_aN2;
+        bN2[j] = compartment.m_bN2;
+        aHe[j] = compartment.m_aHe;
+        bHe[j] = compartment.m_bHe;
+    }
+
+    const int columns = SATURATION_MAP_COLUMNS;
+    map->m_columns = columns;
+    map->m_startTime = samples.front().m_runTime;
+    map->m_endTime = samples.back().m_runTime;
+    map->m_percent.resize(columns * NUM_COMPARTMENTS);
+    map->m_leading.resize(columns);
+    map->m_controlling.resize(columns);
+    double columnTime = (map->m_endTime - map->m_startTime) / (columns - 1);
+
+    size_t k = 1;
+    for (int c = 0; c < columns; c++) {
+        double time = map->m_startTime + c * columnTime;
+        while (k < samples.size() - 1 && samples[k].m_runTime < time) {
+            k++;
+        }
+        const DiveStep& from = samples[k - 1];
+        const DiveStep& to = samples[k];
+        double span = to.m_runTime - from.m_runTime;
+        double f = (span > 0) ? std::min(1.0, std::max(0.0, (time - from.m_runTime) / span)) : 1.0;
+        double pAmb = from.m_pAmbEndDepth + (to.m_pAmbEndDepth - from.m_pAmbEndDepth) * f;
+
+        // M-value of the inert gas with the coefficients weighted by the gases of the compartment
+        float* percent = &map->m_percent[c * NUM_COMPARTMENTS];
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            double pN2 = from.m_ppActual[j].m_pN2 + (to.m_ppActual[j].m_pN2 - from.m_ppActual[j].m_pN2) * f;
+            double pHe = from.m_ppActual[j].m_pHe + (to.m_ppActual[j].m_pHe - from.m_ppActual[j].m_pHe) * f;
+            double pInert = pN2 + pHe;
+            double a = (aN2[j] * pN2 + aHe[j] * pHe) / pInert;
+            double b = (bN2[j] * pN2 + bHe[j] * pHe) / pInert;
+            percent[j] = static_cast<float>((pInert - pAmb) / (a + pAmb / b - pAmb) * 100.0);
+        }
+
+        int leading = 0;
+        for (int j = 1; j < NUM_COMPARTMENTS; j++) {
+            if (percent[j] > percent[leading]) leading = j;
+        }
+        map->m_leading[c] = static_cast<uint8_t>(leading);
+
+        // The controlling compartment is tracked by the kernel, not interpolated
+        map->m_controlling[c] = (f < 0.5) ? from.m_ceilingLimit : to.m_ceilingLimit;
+    }
+    return map;
 }
+#endif
 
 void DivePlan::calculateGasConsumption(bool printLog) {
     if (m_gasAvailable.empty() || m_diveProfile.empty()) {
@@ -249,7 +431,7 @@ void DivePlan::calculateGasConsumption(bool printLog) {
     }
     
     // Log performance
-    QElapsedTimer timer;
+    CoreTimer timer;
     timer.start();
 
     // Reset consumption for all gases
@@ -257,16 +439,11 @@ void DivePlan::calculateGasConsumption(bool printLog) {
         gas.m_consumption = 0.0;
     }
     
-    // Calculate consumption for each step
+    // Calculate consumption for each step, accumulated on the gas breathed
+    const int gasCount = (int) m_gasAvailable.size();
     for (const auto& step : m_diveProfile) {
-        // Find the matching gas for this step
-        for (auto& gas : m_gasAvailable) {
-            if (std::abs(gas.m_gas.m_o2Percent - step.m_o2Percent) < 0.1 && 
-                std::abs(gas.m_gas.m_hePercent - step.m_hePercent) < 0.1) {
-                // Add this step's consumption to the gas
-                gas.m_consumption += step.m_stepConsumption;
-                break;
-            }
+        if (step.m_gasIndex >= 0 && step.m_gasIndex < gasCount) {
+            m_gasAvailable[step.m_gasIndex].m_consumption += step.m_stepConsumption;
         }
     }
     
@@ -293,9 +470,10 @@ void DivePlan::calculateDiveSummary(bool printLog) {
     }
 
     // Log performance
-    QElapsedTimer timer;
+    CoreTimer timer;
     timer.start();
     
+#ifdef DIVECOMPUTER_EMBEDDED
     m_tts = getTTS();
     m_ttsDelta = getTTSDelta(5);
    
@@ -317,6 +495,11 @@ void DivePlan::calculateDiveSummary(bool printLog) {
     if (showTP){
         m_tp = getTP();
     }
+#else
+    // The what-ifs run concurrently, the summary takes as long as the slowest
+    SummaryWhatIfs whatIfs = startDiveSummary();
+    collectDiveSummary(whatIfs, true);
+#endif
     
     // Monitor performance
     if (printLog) {
@@ -325,6 +508,79 @@ void DivePlan::calculateDiveSummary(bool printLog) {
     }
 }
 
+#ifndef DIVECOMPUTER_EMBEDDED
+std::shared_ptr<DivePlan> DivePlan::summarySnapshot() const {
+    // The what-ifs copy the plan again: the lazily built views are left out of it
+    auto snapshot = std::make_shared<DivePlan>(*this);
+    snapshot->m_timeProfile.reset();
+    snapshot->m_timeProfileStale = true;
+    snapshot->m_timeProfileSource.reset();
+    snapshot->m_saturationMap.reset();
+    return snapshot;
+}
+
+SummaryWhatIfs DivePlan::startDiveSummary(const void* owner) {
+    SummaryWhatIfs whatIfs;
+    whatIfs.m_revision = m_revision;
+    if (m_diveProfile.empty()) return whatIfs;
+
+    bool showAP = (m_mode == diveMode::OC) || 
+                  (m_mode == diveMode::CC && m_bailout);
+    bool hasMission = (m_mission > 0);
+    bool showTP = (m_mode == diveMode::OC && hasMission);
+
+    // Replans on the pool, all reading the same snapshot. On a thread of the pool they are
+    // deferred to collectDiveSummary() instead, which must not wait for the pool.
+    std::shared_ptr<DivePlan> snapshot = summarySnapshot();
+    const bool deferred = ComputePool::onWorkerThread();
+    auto start = [deferred, owner](auto task) {
+        return deferred ? std::async(std::launch::deferred, std::move(task))
+                       : ComputePool::instance().submit(std::move(task), owner);
+    };
+
+    whatIfs.m_ttsDelta = start([snapshot]() { return snapshot->getTTSDelta(5); });
+    if (showAP) {
+        whatIfs.m_maxResult = start([snapshot]() { return snapshot->getMaxTimeAndTTS(); });
+    }
+    if (hasMission) {
+        whatIfs.m_turnTts = start([snapshot]() { return snapshot->getTurnTTS(); });
+    }
+
+    // Read from the plan, while the what-ifs run
+    m_tts = getTTS();
+    if (showAP) {
+        m_ap = getAP();
+    }
+    if (showTP) {
+        m_tp = getTP();
+    }
+    return whatIfs;
+}
+
+bool DivePlan::collectDiveSummary(SummaryWhatIfs& whatIfs, bool wait) {
+    // Results of a plan calculated again since
+    if (whatIfs.m_revision != m_revision) {
+        whatIfs = SummaryWhatIfs();
+        return true;
+    }
+
+    auto done = [wait](const auto& future) {
+        return future.valid() &&
+               (wait || future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    };
+    if (done(whatIfs.m_ttsDelta)) {
+        m_ttsDelta = whatIfs.m_ttsDelta.get();
+    }
+    if (done(whatIfs.m_maxResult)) {
+        m_maxResult = whatIfs.m_maxResult.get();
+    }
+    if (done(whatIfs.m_turnTts)) {
+        m_turnTts = whatIfs.m_turnTts.get();
+    }
+    return !whatIfs.pending();
+}
+#endif
+
 void DivePlan::clearDecoSteps(){
     for (int i = 0; i < nbOfSteps(); i++){
         if (m_diveProfile[i].m_phase == Phase::DECO){
@@ -346,16 +602,32 @@ void DivePlan::optimiseDecoGas() {
    // placeholder used for testing for now
 }
 
+int DivePlan::bottomStopIndex() const {
+    for (int i = (int) m_diveProfile.size() - 2; i > 0; i--) {
+        if (m_diveProfile[i].m_phase == Phase::DESCENDING) {
+            return (m_diveProfile[i + 1].m_phase == Phase::STOP) ? i + 1 : 0;
+        }
+    }
+    return 0;
+}
+
+int DivePlan::lastDescentIndex() const {
+    for (int i = (int) m_diveProfile.size() - 1; i > 0; i--) {
+        if (m_diveProfile[i].m_phase == Phase::DESCENDING) {
+            return i;
+        }
+    }
+    return 0;
+}
+
 double DivePlan::getTTS(){
     double endBottomTime = 0.0;
     double endDiveTime = m_diveProfile[nbOfSteps() - 1].m_runTime;
     double TTS = 0;
 
-    for (int i = 1; i < nbOfSteps(); i++){
-        if (m_diveProfile[i].m_phase == Phase::STOP){
-            endBottomTime = m_diveProfile[i].m_runTime;
-            break;
-        }
+    int bottomStop = bottomStopIndex();
+    if (bottomStop > 0){
+        endBottomTime = m_diveProfile[bottomStop].m_runTime;
     }
 
     TTS = (endDiveTime - endBottomTime);
@@ -364,31 +636,27 @@ double DivePlan::getTTS(){
 
 double DivePlan::getTTSDelta(double incrementTime){
     // Log performance
-    QElapsedTimer timer;
+    CoreTimer timer;
     timer.start();
 
+#ifdef DIVECOMPUTER_EMBEDDED
+    // The copy of the plan goes to the scratch plan rather than the stack
+    if (m_scratchPlan == nullptr) return 0.0;
+    DivePlan& tempDivePlan = *m_scratchPlan;
+    tempDivePlan = *this;
+#else
     DivePlan tempDivePlan = *this;
+#endif
 
-    // Find the deepest STOP phase in the dive profile
-    int deepestStopIndex = -1;
-    double deepestDepth = 0.0;
-    
-    for (int i = 0; i < nbOfSteps(); i++) {
-        if (tempDivePlan.m_diveProfile[i].m_phase == Phase::STOP && 
-            tempDivePlan.m_diveProfile[i].m_endDepth > deepestDepth) {
-            deepestStopIndex = i;
-            deepestDepth = tempDivePlan.m_diveProfile[i].m_endDepth;
-        }
-    }
-
-    // If no STOP phase was found, return 0
-    if (deepestStopIndex == -1) {
+    // The bottom is the stop of the last descent, if there is none return 0
+    int bottomStop = bottomStopIndex();
+    if (bottomStop == 0) {
         return 0.0;
     }
 
-    // Adjust the duration of the deepest step
-    tempDivePlan.m_diveProfile[deepestStopIndex].m_time = std::max(0.0, 
-        tempDivePlan.m_diveProfile[deepestStopIndex].m_time + incrementTime);
+    // Adjust the duration of the bottom stop
+    tempDivePlan.m_diveProfile[bottomStop].m_time = std::max(0.0, 
+        tempDivePlan.m_diveProfile[bottomStop].m_time + incrementTime);
 
     // Recalculate the dive plan
     tempDivePlan.calculateDivePlan(false);
@@ -399,24 +667,26 @@ double DivePlan::getTTSDelta(double incrementTime){
     return tempDivePlan.getTTS() - getTTS();
 }
 
-std::pair<double, double> DivePlan::getMaxTimeAndTTS() {       
+std::pair<double, double> DivePlan::getMaxTimeAndTTS() {
     // Log performance
-    QElapsedTimer timer;
+    CoreTimer timer;
     timer.start();
 
+#ifdef DIVECOMPUTER_EMBEDDED
+    if (m_scratchPlan == nullptr) return std::make_pair(0.0, 0.0);
+    DivePlan& tempDivePlan = *m_scratchPlan;
+    tempDivePlan = *this;
+#else
     DivePlan tempDivePlan = *this;
+#endif
     double maxTime = 0.0, maxTTS = 0.0;
 
-    // find the first STOP step
-    int firstStopIndex = 0;
-
-    for (int i = 1; i < nbOfSteps(); i++){
-        if (tempDivePlan.m_diveProfile[i].m_phase == Phase::STOP){
-            tempDivePlan.m_diveProfile[i].m_time = 0.0;
-            firstStopIndex = i;
-            break;
-        }
+    // Bottom time from 0, without a bottom stop there is no time to extend
+    int firstStopIndex = bottomStopIndex();
+    if (firstStopIndex == 0) {
+        return std::make_pair(0.0, 0.0);
     }
+    tempDivePlan.m_diveProfile[firstStopIndex].m_time = 0.0;
 
     // Recalculate the dive plan
     tempDivePlan.calculateDivePlan(false);
@@ -447,45 +717,28 @@ std::pair<double, double> DivePlan::getMaxTimeAndTTS() {
 
 // Function to calculate the turn pressure
 double DivePlan::getTP() {
+    DiveSiteScope site(m_site);
+
     // If no mission time is set, return the ascent pressure
     if (m_mission <= 0) {
         return getAP();
     }
     
-    // Find the deepest STOP phase in the dive profile
-    int deepestStopIndex = -1;
-    double deepestDepth = 0.0;
-    
-    for (int i = 0; i < nbOfSteps(); i++) {
-        if (m_diveProfile[i].m_phase == Phase::STOP && 
-            m_diveProfile[i].m_endDepth > deepestDepth) {
-            deepestStopIndex = i;
-            deepestDepth = m_diveProfile[i].m_endDepth;
-        }
-    }
-    
-    // If no STOP phase was found, return 0
-    if (deepestStopIndex == -1) {
+    // The mission is spent at the bottom stop, if there is none return 0
+    int bottomStop = bottomStopIndex();
+    if (bottomStop == 0) {
         return 0;
     }
     
-    // Get the deepest stop step
-    const DiveStep& deepestStop = m_diveProfile[deepestStopIndex];
+    // Get the bottom stop step and the gas being used there
+    const DiveStep& deepestStop = m_diveProfile[bottomStop];
+    double deepestDepth = deepestStop.m_endDepth;
     
-    // Find the gas being used at the deepest stop
-    const GasAvailable* matchingGas = nullptr;
-    for (const auto& gas : m_gasAvailable) {
-        if (std::abs(gas.m_gas.m_o2Percent - deepestStop.m_o2Percent) < 0.1 && 
-            std::abs(gas.m_gas.m_hePercent - deepestStop.m_hePercent) < 0.1) {
-            matchingGas = &gas;
-            break;
-        }
-    }
-    
-    // If no matching gas found, return the standard ascent pressure
-    if (!matchingGas) {
+    // If no gas is breathed from the tanks, return 0
+    if (deepestStop.m_gasIndex < 0 || deepestStop.m_gasIndex >= (int) m_gasAvailable.size()) {
         return 0;
     }
+    const GasAvailable* matchingGas = &m_gasAvailable[deepestStop.m_gasIndex];
     
     // Calculate ambient pressure at the deepest stop depth
     double ambientPressure = getPressureFromDepth(deepestDepth);
@@ -526,7 +779,7 @@ double DivePlan::getTurnTTS() {
 double DivePlan::getAP() {
     // Find the first ascent step after the bottom phase
     int firstAscentIndex = -1;
-    for (int i = 0; i < nbOfSteps(); i++) {
+    for (int i = bottomStopIndex(); i < nbOfSteps(); i++) {
         if (m_diveProfile[i].m_phase == Phase::ASCENDING) {
             firstAscentIndex = i;
             break;
@@ -538,41 +791,18 @@ double DivePlan::getAP() {
         return 0.0;
     }
     
-    // Get the initial gas mix (O2/He percentages)
-    double initialO2 = m_diveProfile[firstAscentIndex].m_o2Percent;
-    double initialHe = m_diveProfile[firstAscentIndex].m_hePercent;
+    // Get the gas used at the start of the ascent
+    int gasIndex = m_diveProfile[firstAscentIndex].m_gasIndex;
+    if (gasIndex < 0 || gasIndex >= (int) m_gasAvailable.size()) {
+        return 0.0;
+    }
     
     // Sum gas consumption until a gas switch occurs
     double totalConsumption = 0.0;
-    int i = firstAscentIndex;
-    
-    while (i < nbOfSteps()) {
-        // Check if we reached a gas switch
-        if (i > firstAscentIndex && 
-            (std::abs(m_diveProfile[i].m_o2Percent - initialO2) > 0.1 || 
-             std::abs(m_diveProfile[i].m_hePercent - initialHe) > 0.1)) {
-            break;
-        }
-        
-        // Add consumption for this step
+    for (int i = firstAscentIndex; i < nbOfSteps() && m_diveProfile[i].m_gasIndex == gasIndex; i++) {
         totalConsumption += m_diveProfile[i].m_stepConsumption;
-        i++;
-    }
-    
-    // Find the matching gas in available gases
-    const GasAvailable* matchingGas = nullptr;
-    for (const auto& gas : m_gasAvailable) {
-        if (std::abs(gas.m_gas.m_o2Percent - initialO2) < 0.1 && 
-            std::abs(gas.m_gas.m_hePercent - initialHe) < 0.1) {
-            matchingGas = &gas;
-            break;
-        }
-    }
-    
-    // If no matching gas found, return 0
-    if (!matchingGas) {
-        return 0.0;
     }
+    const GasAvailable* matchingGas = &m_gasAvailable[gasIndex];
     
     // Calculate pressure consumption based on tanks and capacity
     double pressureConsumed = 0.0;
@@ -588,8 +818,10 @@ double DivePlan::getAP() {
 }
 
 double DivePlan::getNoFlyTime(){
+    DiveSiteScope site(m_site);
+
     // Log performance
-    QElapsedTimer timer;
+    CoreTimer timer;
     timer.start();
 
     DiveStep flyDive[3];
@@ -597,10 +829,10 @@ double DivePlan::getNoFlyTime(){
     // Initialise the step with the last step of the dive profile
     flyDive[0] = m_diveProfile[nbOfSteps() - 1];
 
-    // Step to wait at the surface
-    flyDive[1].m_pAmbStartDepth = g_parameters.m_atmPressure;
-    flyDive[1].m_pAmbEndDepth = g_parameters.m_atmPressure;
-    flyDive[1].m_pAmbMax = g_parameters.m_atmPressure;
+    // Step to wait at the surface of the site
+    flyDive[1].m_pAmbStartDepth = m_site.m_surfacePressure;
+    flyDive[1].m_pAmbEndDepth = m_site.m_surfacePressure;
+    flyDive[1].m_pAmbMax = m_site.m_surfacePressure;
     flyDive[1].m_time = 0;
     flyDive[1].m_n2Percent = 100 - g_constants.m_oxygenInAir;
     flyDive[1].m_hePercent = 0;
@@ -635,6 +867,83 @@ double DivePlan::getNoFlyTime(){
     return std::ceil(flyDive[1].m_time / 60.0);
 }
 
+DiveStep DivePlan::getStateAtTime(double runTime) const {
+    DiveSiteScope site(m_site);
+
+    if (m_diveProfile.size() < 2) {
+        return m_diveProfile.empty() ? DiveStep() : m_diveProfile[0];
+    }
+
+    // First step ending at or after the run time, the state is interpolated inside it
+    auto it = std::lower_bound(m_diveProfile.begin() + 1, m_diveProfile.end(), runTime,
+        [](const DiveStep& step, double time) { return step.m_runTime < time; });
+    if (it == m_diveProfile.end()) {
+        return m_diveProfile[m_diveProfile.size() - 1];
+    }
+
+    int index = static_cast<int>(it - m_diveProfile.begin());
+    double elapsed = std::max(0.0, runTime - (it->m_runTime - it->m_time));
+    return sampleStep(index, elapsed, m_diveProfile[index - 1]);
+}
+
+#ifdef DIVECOMPUTER_EMBEDDED
+bool DivePlan::overflowed() const {
+    return m_diveProfile.overflowed() || m_gasAvailable.overflowed() ||
+           m_stopSteps.m_stopSteps.overflowed() || m_setPoints.m_depths.overflowed();
+}
+#else
+std::shared_ptr<const std::vector<DiveStep>> DivePlan::timeProfile() const {
+    std::lock_guard<std::recursive_mutex> lock(m_lazyLock.m_mutex);
+
+    // Sample the time profile on first access after a calculation, or after a change of
+    // the parameters the samples read
+    if (m_timeProfileStale || m_timeProfileEpoch != g_parameters.epoch()) {
+        calculateTimeProfile(false);
+    }
+
+    // Materialize the cached time profile on first access, then release the file
+    if (m_timeProfileSource) {
+        auto samples = std::make_shared<std::vector<DiveStep>>();
+        size_t size = 0;
+        if (const char* data = m_timeProfileSource->section(DivePlanSection::TIME_PROFILE, size)) {
+            readProfileSection(data, size, *samples);
+        }
+        m_timeProfile = std::move(samples);
+        m_timeProfileSource.reset();
+    }
+
+    if (!m_timeProfile) {
+        m_timeProfile = std::make_shared<const std::vector<DiveStep>>();
+    }
+    return m_timeProfile;
+}
+
+std::shared_ptr<const SaturationMap> DivePlan::saturationMap() const {
+    std::lock_guard<std::recursive_mutex> lock(m_lazyLock.m_mutex);
+
+    // Built with the time profile, or from the one of a loaded plan on first access
+    std::shared_ptr<const std::vector<DiveStep>> samples = timeProfile();
+    if (!m_saturationMap) {
+        m_saturationMap = buildSaturationMap(*samples);
+    }
+    return m_saturationMap;
+}
+
+std::vector<double> DivePlan::getGasConsumptionSeries(const std::vector<DiveStep>& samples, int gasIndex) {
+    std::vector<double> series;
+    series.reserve(samples.size());
+
+    double total = 0.0;
+    for (const auto& sample : samples) {
+        if (sample.m_gasIndex == gasIndex) {
+            total += sample.m_stepConsumption;
+        }
+        series.push_back(total);
+    }
+    return series;
+}
+#endif
+
 // HELPER METHODS
 
 void DivePlan::clear(){
@@ -666,136 +975,186 @@ void DivePlan::applyGases() {
     }
 
     // Delete all GAS_SWITCH steps
-    std::vector<DiveStep> filteredSteps;
-    for (const auto& step : m_diveProfile) {
-        if (step.m_phase != Phase::GAS_SWITCH) {
-            filteredSteps.push_back(step);
-        }
+    m_diveProfile.erase(std::remove_if(m_diveProfile.begin(), m_diveProfile.end(),
+                                       [](const DiveStep& step) { return step.m_phase == Phase::GAS_SWITCH; }),
+                        m_diveProfile.end());
+    const size_t stepCount = m_diveProfile.size();
+
+    // Resolve the setpoints of the whole profile in one pass
+    CoreVector<double, MAX_DIVE_STEPS> stepMaxDepths(stepCount);
+    CoreVector<double, MAX_DIVE_STEPS> stepSetPoints(stepCount);
+    for (size_t i = 0; i < stepCount; ++i) {
+        stepMaxDepths[i] = std::max(m_diveProfile[i].m_startDepth, m_diveProfile[i].m_endDepth);
     }
-    m_diveProfile = filteredSteps;
+    m_setPoints.getSetPointsAtDepths(stepMaxDepths.data(), stepCount, m_boosted, stepSetPoints.data());
+
+    // Steps preceded by a gas switch
+    CoreVector<char, MAX_DIVE_STEPS> switchBefore(stepCount, 0);
+    size_t switchCount = 0;
 
-    // Create a new profile vector to hold steps with gas switches
-    std::vector<DiveStep> updatedProfile;
-    updatedProfile.reserve(m_diveProfile.size() * 2); // Reserve space for potential new steps
-    
     // Track previous step's gas to detect changes
     double prevO2Percent = g_constants.m_oxygenInAir;
     double prevHePercent = 0.0;
     stepMode prevMode = stepMode::CC;
     
-    // Process each step and add gas switches in a single pass
-    for (size_t i = 0; i < m_diveProfile.size(); ++i) {
+    // Apply the gases to the steps and find the gas switches
+    const size_t lastDescent = lastDescentIndex();
+    for (size_t i = 0; i < stepCount; ++i) {
         auto& step = m_diveProfile[i];
-        const Gas* selectedGas = nullptr;
-        double maxDepth = std::max(step.m_startDepth, step.m_endDepth);
-            
-        // Check for surface step
-        if(std::abs(step.m_startDepth) < 0.1 && std::abs(step.m_endDepth) < 0.1) {
-            Gas gas = Gas(); // Default to Air
-            selectedGas = &gas;
-            step.m_o2Percent = gas.m_o2Percent;
-            step.m_hePercent = gas.m_hePercent;
-        }
-        else {
-            // Determine the max ppO2 for this phase
-            double maxppO2 = 0.0;
-            switch(step.m_mode) {
-                case stepMode::OC:
-                    maxppO2 = g_parameters.m_PpO2Active;
-                    break;
-                case stepMode::BAILOUT:
-                    maxppO2 = g_parameters.m_PpO2Active;
-                    break;
-                case stepMode::DECO:
-                    maxppO2 = g_parameters.m_PpO2Deco;
-                    break;
-                case stepMode::CC:
-                    maxppO2 = g_parameters.m_maxPpO2Diluent;
-                    break;
-                default:
-                    maxppO2 = g_parameters.m_PpO2Active;
-                    break;
-            }
-            // Find the gas with the smallest MOD that can be used at this depth    
-            double smallestMOD = std::numeric_limits<double>::max();
-
-            for (const auto& gas : m_gasAvailable) {
-                double gasMOD = gas.m_gas.MOD(maxppO2);                
-
-                // Check if the gas MOD is smaller than the smallest MOD and greater than or equal to the current depth
-                if (gasMOD < smallestMOD && gasMOD >= maxDepth) {
-                    smallestMOD = gasMOD;
-                    selectedGas = &gas.m_gas;
-                }
-            }
-
-            // If no gas available, use the first gas available (which has the lowest O2 content)
-            if (selectedGas == nullptr) {
-                // Try to use the first available gas as a default
-                if (!m_gasAvailable.empty()) {
-                    selectedGas = &m_gasAvailable[0].m_gas;
-                } else {
-                    // If no gas available, use a default air
-                    static Gas defaultAir;
-                    selectedGas = &defaultAir;
-                }
-            }
-
-            step.m_pAmbMax = std::max(getPressureFromDepth(step.m_startDepth), getPressureFromDepth(step.m_endDepth));
-
-            if(step.m_mode == stepMode::CC) {
-                step.m_o2Percent = std::min(m_setPoints.getSetPointAtDepth(maxDepth, m_boosted) / step.m_pAmbMax * 100.0, 100.0);
-                step.m_hePercent = (100 - step.m_o2Percent) * selectedGas->m_hePercent / (100 - selectedGas->m_o2Percent);
-            }
-            else{
-                step.m_o2Percent = selectedGas->m_o2Percent;
-                step.m_hePercent = selectedGas->m_hePercent;
-            }
-        }
-
-        // Calculate N2 and other values for the step
-        step.m_n2Percent = 100.0 - step.m_o2Percent - step.m_hePercent;
-        step.m_pO2Max = (step.m_o2Percent / 100.0) * step.m_pAmbMax;
+        int selectedIndex = selectGasIndex(step, i >= lastDescent);
+        applyGasToStep(step, selectedIndex, stepSetPoints[i]);
 
         // Check if we need to add a gas switch step
         if (i > 0 && !(step.m_mode == stepMode::CC && prevMode == stepMode::CC) &&
             (std::abs(step.m_o2Percent - prevO2Percent) > 0.1 || 
              std::abs(step.m_hePercent - prevHePercent) > 0.1)) {
             
-            // Find the corresponding GasAvailable object
-            for (auto& gasAvailable : m_gasAvailable) {
-                if (&gasAvailable.m_gas == selectedGas) {
-                    gasAvailable.m_switchDepth = std::max(step.m_startDepth, gasAvailable.m_switchDepth);
-                    gasAvailable.m_switchPpO2 = std::max(step.m_pAmbMax * step.m_o2Percent / 100.0, gasAvailable.m_switchPpO2);
-                    break;
-                }
+            // Update the switch depth and ppO2 of the gas switched to
+            if (selectedIndex >= 0) {
+                GasAvailable& gasAvailable = m_gasAvailable[selectedIndex];
+                gasAvailable.m_switchDepth = std::max(step.m_startDepth, gasAvailable.m_switchDepth);
+                gasAvailable.m_switchPpO2 = std::max(step.m_pAmbMax * step.m_o2Percent / 100.0, gasAvailable.m_switchPpO2);
             }
 
-            // Create a gas switch step
-            DiveStep gasSwitch = step;
-            gasSwitch.m_endDepth = step.m_startDepth;
-            gasSwitch.m_time = 0.0; // Minimal time
-            gasSwitch.m_phase = Phase::GAS_SWITCH; 
-            
-            // Use the gas of the current step (the new gas being switched to)
-            
-            // Add the gas switch step to the updated profile
-            updatedProfile.push_back(gasSwitch);
+            switchBefore[i] = 1;
+            switchCount++;
         }
         
-        // Add the current step to the updated profile
-        updatedProfile.push_back(step);
-        
         // Store current step's gas info for the next iteration
         prevO2Percent = step.m_o2Percent;
         prevHePercent = step.m_hePercent;
         prevMode = step.m_mode;
     }
-    
-    // Replace the original profile with the updated one
-    m_diveProfile = std::move(updatedProfile);
 
+    if (switchCount == 0) return;
+
+    // Insert the gas switch steps in place, from the last step so that each step moves once
+    const size_t newCount = stepCount + switchCount;
+    m_diveProfile.resize(newCount);
+    if (m_diveProfile.size() < newCount) return;  // Profile full
+
+    size_t next = newCount;
+    for (size_t i = stepCount; i-- > 0;) {
+        if (--next != i) {
+            m_diveProfile[next] = m_diveProfile[i];
+        }
+        if (switchBefore[i]) {
+            // Breathes the gas of the step (the new gas being switched to)
+            DiveStep& gasSwitch = m_diveProfile[--next];
+            gasSwitch = m_diveProfile[next + 1];
+            gasSwitch.m_endDepth = gasSwitch.m_startDepth;
+            gasSwitch.m_time = 0.0; // Minimal time
+            gasSwitch.m_phase = Phase::GAS_SWITCH;
+        }
+    }
+}
+
+int DivePlan::selectGasIndex(const DiveStep& step, bool decoGases) const {
+    // The surface step breathes air
+    if(std::abs(step.m_startDepth) < 0.1 && std::abs(step.m_endDepth) < 0.1) {
+        return -1;
+    }
+
+    // Determine the max ppO2 for this phase
+    double maxppO2 = 0.0;
+    switch(step.m_mode) {
+        case stepMode::OC:
+            maxppO2 = g_parameters.m_PpO2Active;
+            break;
+        case stepMode::BAILOUT:
+            maxppO2 = g_parameters.m_PpO2Active;
+            break;
+        case stepMode::DECO:
+            maxppO2 = g_parameters.m_PpO2Deco;
+            break;
+        case stepMode::CC:
+            maxppO2 = g_parameters.m_maxPpO2Diluent;
+            break;
+        default:
+            maxppO2 = g_parameters.m_PpO2Active;
+            break;
+    }
+
+    // Find the gas with the smallest MOD that can be used at this depth    
+    double maxDepth = std::max(step.m_startDepth, step.m_endDepth);
+    double smallestMOD = std::numeric_limits<double>::max();
+    int selectedIndex = -1;
+
+    for (int g = 0; g < (int) m_gasAvailable.size(); g++) {
+        if (!decoGases && m_gasAvailable[g].m_gas.m_gasType == GasType::DECO) continue;
+        double gasMOD = m_gasAvailable[g].m_gas.MOD(maxppO2);                
+
+        // Check if the gas MOD is smaller than the smallest MOD and greater than or equal to the current depth
+        if (gasMOD < smallestMOD && gasMOD >= maxDepth) {
+            smallestMOD = gasMOD;
+            selectedIndex = g;
+        }
+    }
+
+    // If no gas available, use the first gas available (which has the lowest O2 content)
+    return (selectedIndex == -1) ? 0 : selectedIndex;
+}
+
+void DivePlan::applyGasToStep(DiveStep& step, int gasIndex, double setPoint) const {
+    if (gasIndex < 0) {
+        Gas gas = Gas(); // Default to Air
+        step.m_o2Percent = gas.m_o2Percent;
+        step.m_hePercent = gas.m_hePercent;
+    }
+    else {
+        const Gas& selectedGas = m_gasAvailable[gasIndex].m_gas;
+
+        step.m_pAmbMax = std::max(getPressureFromDepth(step.m_startDepth), getPressureFromDepth(step.m_endDepth));
+
+        if(step.m_mode == stepMode::CC) {
+            step.m_o2Percent = std::min(setPoint / step.m_pAmbMax * 100.0, 100.0);
+            step.m_hePercent = (100 - step.m_o2Percent) * selectedGas.m_hePercent / (100 - selectedGas.m_o2Percent);
+        }
+        else{
+            step.m_o2Percent = selectedGas.m_o2Percent;
+            step.m_hePercent = selectedGas.m_hePercent;
+        }
+    }
+
+    // Record the gas (diluent in CC) breathed on this step
+    step.m_gasIndex = gasIndex;
+
+    // Calculate N2 and other values for the step
+    step.m_n2Percent = 100.0 - step.m_o2Percent - step.m_hePercent;
+    step.m_pO2Max = (step.m_o2Percent / 100.0) * step.m_pAmbMax;
+}
+
+#ifndef DIVECOMPUTER_EMBEDDED
+void DivePlan::restoreGasIndices() {
+    // Files written before the gas index existed only hold the mix of each step:
+    // match it once against the available gases
+    auto findGasIndex = [this](const DiveStep& step) {
+        if (std::abs(step.m_startDepth) < 0.1 && std::abs(step.m_endDepth) < 0.1) return -1;
+        for (int g = 0; g < (int) m_gasAvailable.size(); g++) {
+            const Gas& gas = m_gasAvailable[g].m_gas;
+            if (step.m_mode == stepMode::CC) {
+                // The diluent keeps its He/N2 ratio whatever the setpoint
+                double inert = 100.0 - step.m_o2Percent;
+                double inertGas = 100.0 - gas.m_o2Percent;
+                if (inert > 0.0 && inertGas > 0.0 &&
+                    std::abs(step.m_hePercent / inert - gas.m_hePercent / inertGas) < 0.001) return g;
+            }
+            else if (std::abs(gas.m_o2Percent - step.m_o2Percent) < 0.1 && 
+                     std::abs(gas.m_hePercent - step.m_hePercent) < 0.1) {
+                return g;
+            }
+        }
+        return -1;
+    };
+
+    for (auto& step : m_diveProfile) step.m_gasIndex = findGasIndex(step);
+    if (m_timeProfile) {
+        auto samples = std::make_shared<std::vector<DiveStep>>(*m_timeProfile);
+        for (auto& step : *samples) step.m_gasIndex = findGasIndex(step);
+        m_timeProfile = std::move(samples);
+    }
 }
+#endif
 
 bool DivePlan::getIfBreachingDecoLimitsInRange(int deco, int next_deco){
     for (int k = deco; k <= next_deco; k++){
@@ -846,41 +1205,15 @@ double DivePlan::calculateFirstStopDepth(double maxDepth){
     return (firstStopDepth > maxDepth) ? firstStopDepth - g_parameters.m_depthIncrement : firstStopDepth;
 }
 
-void DivePlan::processAscentStops(const std::vector<double>& ascentStops){
-    stepMode ascentMode = (m_mode == diveMode::CC) ? (m_bailout ? stepMode::BAILOUT : stepMode::CC) : stepMode::OC;
-
-    for (size_t i = 0; i < ascentStops.size() - 1; ++i) {
-        double fromDepth = ascentStops[i];
-        double toDepth = ascentStops[i+1];
-        
-        // Add ascending step
-        double ascendTime = (fromDepth - toDepth) / g_parameters.m_maxAscentRate;
-        addStep(fromDepth, toDepth, ascendTime, Phase::ASCENDING, ascentMode);
-        
-        // Check if this is a planned stop
-        bool isPlannedStop = false;
-        double stopTime = 0;
-        
-        for (const auto& stop : m_stopSteps.m_stopSteps) {
-            if (std::abs(stop.m_depth - toDepth) < 0.1) {
-                isPlannedStop = true;
-                stopTime = stop.m_time;
-                break;
-            }
-        }
-        
-        // Add appropriate step
-        if (isPlannedStop) {
-            addStep(toDepth, toDepth, stopTime, Phase::STOP, ascentMode);
-            if (toDepth > 0) {
-                addStep(toDepth, toDepth, 0, Phase::DECO, ascentMode);
-            }
-        } else if (toDepth > 0) {
-            addStep(toDepth, toDepth, 0, Phase::DECO, ascentMode);
-        } else {
-            addStep(toDepth, toDepth, 0, Phase::STOP, ascentMode);
-        }
+void DivePlan::addAscent(double fromDepth, double toDepth, const double* decoDepths, size_t count, stepMode mode){
+    // Deco depths between the two, found by bisection as they are sorted deepest first
+    const double* decoDepth = std::upper_bound(decoDepths, decoDepths + count, fromDepth - 0.1, std::greater<double>());
+    for (; decoDepth != decoDepths + count && *decoDepth > toDepth + 0.1; ++decoDepth) {
+        addStep(fromDepth, *decoDepth, (fromDepth - *decoDepth) / g_parameters.m_maxAscentRate, Phase::ASCENDING, mode);
+        addStep(*decoDepth, *decoDepth, 0, Phase::DECO, mode);
+        fromDepth = *decoDepth;
     }
+    addStep(fromDepth, toDepth, (fromDepth - toDepth) / g_parameters.m_maxAscentRate, Phase::ASCENDING, mode);
 }
 
 int DivePlan::nbOfSteps(){
@@ -933,17 +1266,59 @@ void DivePlan::calculatePPInertGasMax() {
 
 void DivePlan::applyGF() {
     for (int i = 1; i < (int) m_diveProfile.size(); i++) {
-        m_diveProfile[i].m_gf = getGF(m_diveProfile[i].m_endDepth, m_firstDecoDepth);
+        m_diveProfile[i].m_gf = getGF(m_diveProfile[i].m_endDepth, m_firstDecoDepth, m_gf[0], m_gf[1]);
     }
 }
 
-void DivePlan::setFirstDecoDepth() {
-    for (int i = 3; i < nbOfSteps(); i++) {
-        if (m_diveProfile[i].getIfBreachingDecoLimits()) {
-            m_firstDecoDepth = m_diveProfile[i - 1].m_startDepth;
-            break;
+// The first deco stop is where the ceiling at GF low first rises above the planned profile.
+// Only the steps up to that point are walked, breathing the gases of their current mode,
+// so the gases, GF and M-values of the whole profile only need to be applied once afterwards.
+double DivePlan::predictFirstDecoDepth() {
+    if (nbOfSteps() < 2 || m_gasAvailable.empty()) return 0.0;
+
+    sortGases();
+    const double gfLow = m_gf[0];
+
+    DiveStep previous = m_diveProfile[0];
+    previous.m_gasIndex = -1;
+    DiveStep current;
+    DiveStep gasSwitch;
+    bool descentDone = false;
+    const int lastDescent = lastDescentIndex();
+
+    for (int i = 1; i < nbOfSteps(); i++) {
+        const DiveStep& step = m_diveProfile[i];
+        if (step.m_phase == Phase::GAS_SWITCH) continue;
+
+        current = step;
+        current.updatePAmb();
+        double maxDepth = std::max(current.m_startDepth, current.m_endDepth);
+        applyGasToStep(current, selectGasIndex(current, i >= lastDescent), m_setPoints.getSetPointAtDepth(maxDepth, m_boosted));
+
+        bool isGasSwitch = !(current.m_mode == stepMode::CC && previous.m_mode == stepMode::CC) &&
+            (std::abs(current.m_o2Percent - previous.m_o2Percent) > 0.1 || 
+             std::abs(current.m_hePercent - previous.m_hePercent) > 0.1);
+        double shallowestDepth = std::min(current.m_startDepth, current.m_endDepth);
+
+        // A gas switch is checked on the tissues before the step, with the new gas
+        if (descentDone && isGasSwitch) {
+            gasSwitch = current;
+            gasSwitch.m_ppActual = previous.m_ppActual;
+            if (gasSwitch.getCeiling(gfLow) > shallowestDepth) {
+                return previous.m_startDepth;
+            }
+        }
+
+        current.calculatePPInertGasForStep(previous, current.m_time);
+        if (descentDone && current.getCeiling(gfLow) > shallowestDepth) {
+            return isGasSwitch ? current.m_startDepth : previous.m_startDepth;
         }
+
+        if (current.m_phase == Phase::DESCENDING) descentDone = true;
+        previous = current;
     }
+
+    return 0.0;
 }
 
 // Update variable functions
@@ -951,7 +1326,8 @@ void DivePlan::setFirstDecoDepth() {
 void DivePlan::updateStepsPhaseFromFirstDeco(){
     stepMode decoMode = (m_mode == diveMode::CC && !m_bailout) ? stepMode::CC : stepMode::DECO;
 
-    for (int i = 0; i < (int) m_diveProfile.size(); i++) {
+    // The deco gases are only breathed once the diver does not go down again
+    for (int i = lastDescentIndex(); i < (int) m_diveProfile.size(); i++) {
         if (m_diveProfile[i].m_phase == Phase::DECO && m_diveProfile[i].m_startDepth <= m_firstDecoDepth) {
             int j = i;
             while (j < (int) m_diveProfile.size() && m_diveProfile[j].m_phase != Phase::STOP) {
@@ -1000,212 +1376,41 @@ void DivePlan::updateRunTimes(){
     }
 }
 
+#ifndef DIVECOMPUTER_EMBEDDED
+// Initial pressures read from a file, one per compartment
+static CompartmentPressures toCompartmentPressures(const std::vector<CompartmentPP>& pressures) {
+    CompartmentPressures result{};
+    std::copy_n(pressures.begin(), std::min(pressures.size(), result.size()), result.begin());
+    return result;
+}
+
 // Save and load dive plan
 bool DivePlan::saveDiveToFile(const std::string& filePath) {
     bool result = ErrorHandler::tryFileOperation([&]() {
         // Log performance
-        QElapsedTimer timer;
+        CoreTimer timer;
         timer.start();
 
-        std::ofstream file(filePath, std::ios::binary);
-        if (!file.is_open()) {
-            logWrite("Failed to open file for writing: ", filePath);
-            return;
-        }
+        // Build every section in memory, then write the file in one go
+        ByteWriter inputs;
+        writeInputsSection(inputs);
 
-        // Write a version identifier for future compatibility
-        uint32_t fileVersion = 1;
-        file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
-
-        // Save basic dive parameters
-        file.write(reinterpret_cast<const char*>(&m_mode), sizeof(m_mode));
-        file.write(reinterpret_cast<const char*>(&m_bailout), sizeof(m_bailout));
-        file.write(reinterpret_cast<const char*>(&m_diveNumber), sizeof(m_diveNumber));
-        file.write(reinterpret_cast<const char*>(&m_boosted), sizeof(m_boosted));
-        file.write(reinterpret_cast<const char*>(&m_mission), sizeof(m_mission));
-        file.write(reinterpret_cast<const char*>(&m_firstDecoDepth), sizeof(m_firstDecoDepth));
-        
-        // Save summary values
-        file.write(reinterpret_cast<const char*>(&m_tts), sizeof(m_tts));
-        file.write(reinterpret_cast<const char*>(&m_ttsDelta), sizeof(m_ttsDelta));
-        file.write(reinterpret_cast<const char*>(&m_ap), sizeof(m_ap));
-        file.write(reinterpret_cast<const char*>(&m_maxResult.first), sizeof(m_maxResult.first));
-        file.write(reinterpret_cast<const char*>(&m_maxResult.second), sizeof(m_maxResult.second));
-        file.write(reinterpret_cast<const char*>(&m_tp), sizeof(m_tp));
-        file.write(reinterpret_cast<const char*>(&m_turnTts), sizeof(m_turnTts));
-
-        // Save StopSteps
-        size_t stopStepsCount = m_stopSteps.m_stopSteps.size();
-        file.write(reinterpret_cast<const char*>(&stopStepsCount), sizeof(stopStepsCount));
-        for (const auto& stopStep : m_stopSteps.m_stopSteps) {
-            file.write(reinterpret_cast<const char*>(&stopStep.m_depth), sizeof(stopStep.m_depth));
-            file.write(reinterpret_cast<const char*>(&stopStep.m_time), sizeof(stopStep.m_time));
-        }
-
-        // Save SetPoints
-        size_t setPointsCount = m_setPoints.m_depths.size();
-        file.write(reinterpret_cast<const char*>(&setPointsCount), sizeof(setPointsCount));
-        for (size_t i = 0; i < setPointsCount; ++i) {
-            file.write(reinterpret_cast<const char*>(&m_setPoints.m_depths[i]), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&m_setPoints.m_setPoints[i]), sizeof(double));
-        }
+        ByteWriter summary;
+        writeSummarySection(summary, checksumBytes(inputs.data(), inputs.size()));
 
-        // Save available gases
-        size_t gasCount = m_gasAvailable.size();
-        file.write(reinterpret_cast<const char*>(&gasCount), sizeof(gasCount));
-        for (const auto& gas : m_gasAvailable) {
-            // Save Gas properties
-            file.write(reinterpret_cast<const char*>(&gas.m_gas.m_o2Percent), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&gas.m_gas.m_hePercent), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&gas.m_gas.m_gasType), sizeof(GasType));
-            file.write(reinterpret_cast<const char*>(&gas.m_gas.m_gasStatus), sizeof(GasStatus));
-            
-            // Save GasAvailable properties
-            file.write(reinterpret_cast<const char*>(&gas.m_switchDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&gas.m_switchPpO2), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&gas.m_nbTanks), sizeof(int));
-            file.write(reinterpret_cast<const char*>(&gas.m_tankCapacity), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&gas.m_fillingPressure), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&gas.m_reservePressure), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&gas.m_consumption), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&gas.m_endPressure), sizeof(double));
-        }
+        ByteWriter diveProfileSection;
+        writeProfileSection(diveProfileSection, m_diveProfile);
 
-        // Save initial pressure
-        size_t initialPressureCount = m_initialPressure.size();
-        file.write(reinterpret_cast<const char*>(&initialPressureCount), sizeof(initialPressureCount));
-        for (const auto& pressure : m_initialPressure) {
-            file.write(reinterpret_cast<const char*>(&pressure.m_pN2), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&pressure.m_pHe), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&pressure.m_pInert), sizeof(double));
-        }
+        ByteWriter timeProfileSection;
+        writeProfileSection(timeProfileSection, *timeProfile());
 
-        // Save GF values (that might have been modified in the summary widget)
-        file.write(reinterpret_cast<const char*>(&g_parameters.m_gf), sizeof(g_parameters.m_gf));
-
-        // Save dive profile
-        size_t profileCount = m_diveProfile.size();
-        file.write(reinterpret_cast<const char*>(&profileCount), sizeof(profileCount));
-        for (const auto& step : m_diveProfile) {
-            // Basic step properties
-            file.write(reinterpret_cast<const char*>(&step.m_phase), sizeof(Phase));
-            file.write(reinterpret_cast<const char*>(&step.m_mode), sizeof(stepMode));
-            file.write(reinterpret_cast<const char*>(&step.m_startDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_endDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_time), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_runTime), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_pAmbStartDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_pAmbEndDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_pAmbMax), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_pO2Max), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_o2Percent), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_n2Percent), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_hePercent), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_gf), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_gfSurface), sizeof(double));
-            
-            // Save compartment data for each step
-            for (const auto& pp : step.m_ppMax) {
-                file.write(reinterpret_cast<const char*>(&pp.m_pN2), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pHe), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            for (const auto& pp : step.m_ppMaxAdjustedGF) {
-                file.write(reinterpret_cast<const char*>(&pp.m_pN2), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pHe), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            for (const auto& pp : step.m_ppActual) {
-                file.write(reinterpret_cast<const char*>(&pp.m_pN2), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pHe), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            // Consumption and other metrics
-            file.write(reinterpret_cast<const char*>(&step.m_sacRate), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_ambConsumptionAtDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_stepConsumption), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_gasDensity), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_endWithoutO2), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_endWithO2), sizeof(double));
-            
-            // Oxygen toxicity metrics
-            file.write(reinterpret_cast<const char*>(&step.m_cnsMaxMinSingleDive), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsStepSingleDive), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsTotalSingleDive), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsMaxMinMultipleDives), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsStepMultipleDives), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsTotalMultipleDives), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_otuPerMin), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_otuStep), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_otuTotal), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_ceiling), sizeof(double));
-        }
-
-        // Save time profile
-        size_t timeProfileCount = m_timeProfile.size();
-        file.write(reinterpret_cast<const char*>(&timeProfileCount), sizeof(timeProfileCount));
-        for (const auto& step : m_timeProfile) {
-            // Basic step properties
-            file.write(reinterpret_cast<const char*>(&step.m_phase), sizeof(Phase));
-            file.write(reinterpret_cast<const char*>(&step.m_mode), sizeof(stepMode));
-            file.write(reinterpret_cast<const char*>(&step.m_startDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_endDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_time), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_runTime), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_pAmbStartDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_pAmbEndDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_pAmbMax), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_pO2Max), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_o2Percent), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_n2Percent), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_hePercent), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_gf), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_gfSurface), sizeof(double));
-            
-            // Save compartment data for each step
-            for (const auto& pp : step.m_ppMax) {
-                file.write(reinterpret_cast<const char*>(&pp.m_pN2), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pHe), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            for (const auto& pp : step.m_ppMaxAdjustedGF) {
-                file.write(reinterpret_cast<const char*>(&pp.m_pN2), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pHe), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            for (const auto& pp : step.m_ppActual) {
-                file.write(reinterpret_cast<const char*>(&pp.m_pN2), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pHe), sizeof(double));
-                file.write(reinterpret_cast<const char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            // Consumption and other metrics
-            file.write(reinterpret_cast<const char*>(&step.m_sacRate), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_ambConsumptionAtDepth), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_stepConsumption), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_gasDensity), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_endWithoutO2), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_endWithO2), sizeof(double));
-            
-            // Oxygen toxicity metrics
-            file.write(reinterpret_cast<const char*>(&step.m_cnsMaxMinSingleDive), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsStepSingleDive), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsTotalSingleDive), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsMaxMinMultipleDives), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsStepMultipleDives), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_cnsTotalMultipleDives), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_otuPerMin), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_otuStep), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_otuTotal), sizeof(double));
-            file.write(reinterpret_cast<const char*>(&step.m_ceiling), sizeof(double));
+        if (!writeDivePlanFile(filePath, {{DivePlanSection::INPUTS, &inputs},
+                                          {DivePlanSection::SUMMARY, &summary},
+                                          {DivePlanSection::DIVE_PROFILE, &diveProfileSection},
+                                          {DivePlanSection::TIME_PROFILE, &timeProfileSection}})) {
+            throw std::ios_base::failure("Failed to write dive plan file");
         }
 
-        file.close();
         logWrite("Dive plan saved successfully in ", timer.elapsed(), " ms to ", filePath);
     }, filePath, "Error Saving Dive Plan");
 
@@ -1216,308 +1421,541 @@ bool DivePlan::saveDiveToFile(const std::string& filePath) {
     return result;
 }
 
+std::string DivePlan::inputsKey() const {
+    ByteWriter writer;
+    writeInputsSection(writer);
+    return std::string(writer.data(), writer.size());
+}
+
+void DivePlan::adoptResults(const DivePlan& calculated) {
+    // The file and the revisions seen by the views stay those of this plan
+    std::string filePath = m_filePath;
+    uint64_t revision = std::max(m_revision, calculated.m_revision);
+    *this = calculated;
+    m_filePath = filePath;
+    m_revision = revision + 1;
+}
+
+void DivePlan::writeInputsSection(ByteWriter& writer) const {
+    // Basic dive parameters, with fixed-width types
+    writer.write(static_cast<int32_t>(m_mode));
+    writer.write(static_cast<uint8_t>(m_bailout));
+    writer.write(static_cast<uint8_t>(m_boosted));
+    writer.write(static_cast<uint16_t>(0));
+    writer.write(static_cast<int32_t>(m_diveNumber));
+    writer.write(m_mission);
+
+    // GF values (that might have been modified in the summary widget)
+    writer.write(m_gf[0]);
+    writer.write(m_gf[1]);
+
+    // Stop steps
+    writer.write(static_cast<uint32_t>(m_stopSteps.m_stopSteps.size()));
+    for (const auto& stopStep : m_stopSteps.m_stopSteps) {
+        writer.write(stopStep.m_depth);
+        writer.write(stopStep.m_time);
+    }
+
+    // Setpoints
+    writer.write(static_cast<uint32_t>(m_setPoints.m_depths.size()));
+    for (size_t i = 0; i < m_setPoints.m_depths.size(); ++i) {
+        writer.write(m_setPoints.m_depths[i]);
+        writer.write(m_setPoints.m_setPoints[i]);
+    }
+
+    // Available gases and tanks
+    writer.write(static_cast<uint32_t>(m_gasAvailable.size()));
+    for (const auto& gas : m_gasAvailable) {
+        writer.write(gas.m_gas.m_o2Percent);
+        writer.write(gas.m_gas.m_hePercent);
+        writer.write(static_cast<int32_t>(gas.m_gas.m_gasType));
+        writer.write(static_cast<int32_t>(gas.m_gas.m_gasStatus));
+        writer.write(static_cast<int32_t>(gas.m_nbTanks));
+        writer.write(gas.m_tankCapacity);
+        writer.write(gas.m_fillingPressure);
+        writer.write(gas.m_reservePressure);
+    }
+
+    // Initial pressure
+    writer.write(static_cast<uint32_t>(m_initialPressure.size()));
+    for (const auto& pressure : m_initialPressure) {
+        writer.write(pressure.m_pN2);
+        writer.write(pressure.m_pHe);
+        writer.write(pressure.m_pInert);
+    }
+
+    // Dive site, last: files without it are read as salt water at sea level
+    writer.write(static_cast<int32_t>(m_site.m_waterType));
+    writer.write(m_site.m_surfacePressure);
+
+    // Stop steps dived in their order
+    writer.write(static_cast<uint8_t>(m_waypoints));
+}
+
+void DivePlan::writeSummarySection(ByteWriter& writer, uint64_t inputsChecksum) const {
+    double maxDepth = 0.0;
+    for (const auto& step : m_diveProfile) {
+        maxDepth = std::max(maxDepth, std::max(step.m_startDepth, step.m_endDepth));
+    }
+    double runTime = m_diveProfile.empty() ? 0.0 : m_diveProfile.back().m_runTime;
+
+    writer.write(m_firstDecoDepth);
+    writer.write(m_tts);
+    writer.write(m_ttsDelta);
+    writer.write(m_ap);
+    writer.write(m_maxResult.first);
+    writer.write(m_maxResult.second);
+    writer.write(m_tp);
+    writer.write(m_turnTts);
+    writer.write(maxDepth);
+    writer.write(runTime);
+    writer.write(static_cast<int64_t>(std::time(nullptr)));
+
+    // Calculated gas values, in the same order as the gases of the inputs section
+    writer.write(static_cast<uint32_t>(m_gasAvailable.size()));
+    for (const auto& gas : m_gasAvailable) {
+        writer.write(gas.m_switchDepth);
+        writer.write(gas.m_switchPpO2);
+        writer.write(gas.m_consumption);
+        writer.write(gas.m_endPressure);
+    }
+
+    // Ties the cached results to the inputs and the parameters they were calculated from,
+    // the parameters being unknown if they changed since
+    writer.write(inputsChecksum);
+    writer.write(m_parametersEpoch == g_parameters.epoch() ? g_parameters.checksum() : uint64_t(0));
+}
+
 std::unique_ptr<DivePlan> DivePlan::loadDiveFromFile(const std::string& filePath) {
     std::unique_ptr<DivePlan> loadedPlan = nullptr;
     
     bool success = ErrorHandler::tryFileOperation([&]() {
         // Log performance
-        QElapsedTimer timer;
+        CoreTimer timer;
         timer.start();
 
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) {
-            logWrite("Failed to open file for reading: ", filePath);
-            return;
+        if (DivePlanFileView::hasMagic(filePath)) {
+            loadedPlan = loadDiveFromFileV2(filePath);
+        } else {
+            loadedPlan = loadDiveFromFileV1(filePath);
         }
 
-        // Read version identifier
-        uint32_t fileVersion;
-        file.read(reinterpret_cast<char*>(&fileVersion), sizeof(fileVersion));
-
-        if (fileVersion != 1) {
-            logWrite("Unsupported file version: ", fileVersion);
-            return;
+        if (loadedPlan) {
+            logWrite("Dive plan loaded successfully in ", timer.elapsed(), " ms from ", filePath);
         }
+    }, filePath, "Error Loading Dive Plan");
 
-        // Read basic parameters
-        diveMode mode;
-        bool bailout;
-        int diveNumber;
-        bool boosted;
-        double mission;
-        double firstDecoDepth;
-        
-        file.read(reinterpret_cast<char*>(&mode), sizeof(mode));
-        file.read(reinterpret_cast<char*>(&bailout), sizeof(bailout));
-        file.read(reinterpret_cast<char*>(&diveNumber), sizeof(diveNumber));
-        file.read(reinterpret_cast<char*>(&boosted), sizeof(boosted));
-        file.read(reinterpret_cast<char*>(&mission), sizeof(mission));
-        file.read(reinterpret_cast<char*>(&firstDecoDepth), sizeof(firstDecoDepth));
-
-        // Read summary values (we'll set these after loading everything else)
-        double tts, ttsDelta, ap, maxTimeResult, maxTTSResult, tp, turnTts;
-        file.read(reinterpret_cast<char*>(&tts), sizeof(tts));
-        file.read(reinterpret_cast<char*>(&ttsDelta), sizeof(ttsDelta));
-        file.read(reinterpret_cast<char*>(&ap), sizeof(ap));
-        file.read(reinterpret_cast<char*>(&maxTimeResult), sizeof(maxTimeResult));
-        file.read(reinterpret_cast<char*>(&maxTTSResult), sizeof(maxTTSResult));
-        file.read(reinterpret_cast<char*>(&tp), sizeof(tp));
-        file.read(reinterpret_cast<char*>(&turnTts), sizeof(turnTts));
-
-        // Read StopSteps
-        StopSteps stopSteps;
-        size_t stopStepsCount;
-        file.read(reinterpret_cast<char*>(&stopStepsCount), sizeof(stopStepsCount));
-        for (size_t i = 0; i < stopStepsCount; ++i) {
-            double depth, time;
-            file.read(reinterpret_cast<char*>(&depth), sizeof(depth));
-            file.read(reinterpret_cast<char*>(&time), sizeof(time));
-            stopSteps.addStopStep(depth, time);
-        }
+    if (success && loadedPlan) {
+        loadedPlan->setFilePath(filePath);
+    }
 
-        // Read SetPoints
-        SetPoints setPoints;
-        size_t setPointsCount;
-        file.read(reinterpret_cast<char*>(&setPointsCount), sizeof(setPointsCount));
-        setPoints.m_depths.clear();
-        setPoints.m_setPoints.clear();
-        for (size_t i = 0; i < setPointsCount; ++i) {
-            double depth, setPoint;
-            file.read(reinterpret_cast<char*>(&depth), sizeof(depth));
-            file.read(reinterpret_cast<char*>(&setPoint), sizeof(setPoint));
-            setPoints.m_depths.push_back(depth);
-            setPoints.m_setPoints.push_back(setPoint);
-        }
-        setPoints.sortSetPoints();
-
-        // Read available gases
-        std::vector<GasAvailable> gasAvailable;
-        size_t gasCount;
-        file.read(reinterpret_cast<char*>(&gasCount), sizeof(gasCount));
-        for (size_t i = 0; i < gasCount; ++i) {
-            double o2Percent, hePercent;
-            GasType gasType;
-            GasStatus gasStatus;
-            
-            // Read Gas properties
-            file.read(reinterpret_cast<char*>(&o2Percent), sizeof(double));
-            file.read(reinterpret_cast<char*>(&hePercent), sizeof(double));
-            file.read(reinterpret_cast<char*>(&gasType), sizeof(GasType));
-            file.read(reinterpret_cast<char*>(&gasStatus), sizeof(GasStatus));
-            
-            // Create Gas object and GasAvailable object
-            Gas gas(o2Percent, hePercent, gasType, gasStatus);
-            GasAvailable gasObj(gas);
-            
-            // Read GasAvailable properties
-            file.read(reinterpret_cast<char*>(&gasObj.m_switchDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&gasObj.m_switchPpO2), sizeof(double));
-            file.read(reinterpret_cast<char*>(&gasObj.m_nbTanks), sizeof(int));
-            file.read(reinterpret_cast<char*>(&gasObj.m_tankCapacity), sizeof(double));
-            file.read(reinterpret_cast<char*>(&gasObj.m_fillingPressure), sizeof(double));
-            file.read(reinterpret_cast<char*>(&gasObj.m_reservePressure), sizeof(double));
-            file.read(reinterpret_cast<char*>(&gasObj.m_consumption), sizeof(double));
-            file.read(reinterpret_cast<char*>(&gasObj.m_endPressure), sizeof(double));
-            
-            gasAvailable.push_back(gasObj);
-        }
+    return loadedPlan;
+}
 
-        // Read initial pressure
-        std::vector<CompartmentPP> initialPressure;
-        size_t initialPressureCount;
-        file.read(reinterpret_cast<char*>(&initialPressureCount), sizeof(initialPressureCount));
-        for (size_t i = 0; i < initialPressureCount; ++i) {
-            double pN2, pHe, pInert;
-            file.read(reinterpret_cast<char*>(&pN2), sizeof(double));
-            file.read(reinterpret_cast<char*>(&pHe), sizeof(double));
-            file.read(reinterpret_cast<char*>(&pInert), sizeof(double));
-            initialPressure.push_back(CompartmentPP(pN2, pHe, pInert));
+// Version 2 files: sections decoded from a memory mapping
+std::unique_ptr<DivePlan> DivePlan::loadDiveFromFileV2(const std::string& filePath) {
+    std::shared_ptr<DivePlanFileView> view = std::make_shared<DivePlanFileView>();
+    if (!view->open(filePath)) {
+        logError("Invalid or truncated dive plan file: ", filePath);
+        return nullptr;
+    }
+    if (view->version() > DIVE_PLAN_FILE_VERSION) {
+        logWrite("Unsupported file version: ", view->version());
+        return nullptr;
+    }
+
+    // Inputs
+    size_t inputsSize = 0;
+    const char* inputsData = view->section(DivePlanSection::INPUTS, inputsSize);
+    if (!inputsData) {
+        logWrite("Dive plan file has no inputs section: ", filePath);
+        return nullptr;
+    }
+    DivePlanFileInputs inputs;
+    if (!readInputsSection(inputsData, inputsSize, inputs)) {
+        logWrite("Dive plan file has a truncated inputs section: ", filePath);
+        return nullptr;
+    }
+
+    // Cached summary, only trusted if it was calculated from these inputs
+    DivePlanFileSummary summary;
+    size_t summarySize = 0;
+    const char* summaryData = view->section(DivePlanSection::SUMMARY, summarySize);
+    bool cacheValid = summaryData && readSummarySection(summaryData, summarySize, summary, inputs.m_gases) &&
+                      summary.m_inputsChecksum == checksumBytes(inputsData, inputsSize);
+
+    std::unique_ptr<DivePlan> loadedPlan = createFromInputs(inputs);
+
+    if (cacheValid) {
+        loadedPlan->m_firstDecoDepth = summary.m_firstDecoDepth;
+        loadedPlan->m_tts = summary.m_tts;
+        loadedPlan->m_ttsDelta = summary.m_ttsDelta;
+        loadedPlan->m_ap = summary.m_ap;
+        loadedPlan->m_maxResult = std::make_pair(summary.m_maxTime, summary.m_maxTTS);
+        loadedPlan->m_tp = summary.m_tp;
+        loadedPlan->m_turnTts = summary.m_turnTts;
+    }
+
+    // Cached dive profile, read now as it is small and used by everything else
+    size_t profileSize = 0;
+    const char* profileData = view->section(DivePlanSection::DIVE_PROFILE, profileSize);
+    cacheValid = cacheValid && profileData && readProfileSection(profileData, profileSize, loadedPlan->m_diveProfile);
+
+    if (!cacheValid) {
+        logWrite("Cached results do not match the inputs, recalculating: ", filePath);
+        loadedPlan->buildDivePlan();
+        loadedPlan->calculateDivePlan(false);
+        loadedPlan->calculateGasConsumption(false);
+        loadedPlan->calculateDiveSummary(false);
+        return loadedPlan;
+    }
+
+    // The cached results were calculated with the parameters of the time the file was saved.
+    // When those are the current ones, the results and the cached time profile, materialized
+    // from the mapping on first access, are those of the current epoch. Otherwise they are not
+    // matched to any epoch, and the time profile is sampled again when first read.
+    if (summary.m_parametersChecksum != 0 && summary.m_parametersChecksum == g_parameters.checksum()) {
+        loadedPlan->m_parametersEpoch = g_parameters.epoch();
+        loadedPlan->m_timeProfileEpoch = g_parameters.epoch();
+        if (view->section(DivePlanSection::TIME_PROFILE, profileSize)) {
+            loadedPlan->m_timeProfileSource = view;
+        } else {
+            loadedPlan->m_timeProfileStale = true;
         }
+    } else {
+        loadedPlan->m_parametersEpoch = 0;
+        loadedPlan->m_timeProfileEpoch = 0;
+    }
 
-        // Read saved GF values
-        double savedGF[2];
-        file.read(reinterpret_cast<char*>(&savedGF), sizeof(savedGF));
-        g_parameters.m_gf[0] = savedGF[0];
-        g_parameters.m_gf[1] = savedGF[1];
-
-        // Now we have enough information to create a new DivePlan object
-        // Get the first stop step's depth and time for the constructor
-        double depth = 0.0, time = 0.0;
-        if (!stopSteps.m_stopSteps.empty()) {
-            depth = stopSteps.m_stopSteps[0].m_depth;
-            time = stopSteps.m_stopSteps[0].m_time;
-        }
+    return loadedPlan;
+}
+
+std::unique_ptr<DivePlan> DivePlan::createFromInputs(const DivePlanFileInputs& inputs) {
+    std::unique_ptr<DivePlan> plan(new DivePlan());
+    plan->m_mode = static_cast<diveMode>(inputs.m_mode);
+    plan->m_diveNumber = inputs.m_diveNumber;
+    plan->m_bailout = inputs.m_bailout;
+    plan->m_boosted = inputs.m_boosted;
+    plan->m_waypoints = inputs.m_waypoints;
+    plan->m_mission = inputs.m_mission;
+    plan->m_gf[0] = inputs.m_gf[0];
+    plan->m_gf[1] = inputs.m_gf[1];
+    plan->m_initialPressure = toCompartmentPressures(inputs.m_initialPressure);
+    plan->m_site = DiveSite(static_cast<WaterType>(inputs.m_waterType), inputs.m_surfacePressure);
+
+    plan->m_stopSteps.clear();
+    for (const auto& stopStep : inputs.m_stopSteps) {
+        plan->m_stopSteps.addStopStep(stopStep.first, stopStep.second);
+    }
+
+    plan->m_setPoints.m_depths.clear();
+    plan->m_setPoints.m_setPoints.clear();
+    for (const auto& setPoint : inputs.m_setPoints) {
+        plan->m_setPoints.m_depths.push_back(setPoint.first);
+        plan->m_setPoints.m_setPoints.push_back(setPoint.second);
+    }
+    plan->m_setPoints.sortSetPoints();
+
+    for (const auto& gas : inputs.m_gases) {
+        GasAvailable gasObj(Gas(gas.m_o2Percent, gas.m_hePercent, static_cast<GasType>(gas.m_gasType), static_cast<GasStatus>(gas.m_gasStatus)));
+        gasObj.m_nbTanks = gas.m_nbTanks;
+        gasObj.m_tankCapacity = gas.m_tankCapacity;
+        gasObj.m_fillingPressure = gas.m_fillingPressure;
+        gasObj.m_reservePressure = gas.m_reservePressure;
+        gasObj.m_switchDepth = gas.m_switchDepth;
+        gasObj.m_switchPpO2 = gas.m_switchPpO2;
+        gasObj.m_consumption = gas.m_consumption;
+        gasObj.m_endPressure = gas.m_endPressure;
+        plan->m_gasAvailable.push_back(gasObj);
+    }
+
+    return plan;
+}
+
+// Legacy version 1 files: sequential stream of raw values
+std::unique_ptr<DivePlan> DivePlan::loadDiveFromFileV1(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        logError("Failed to open file for reading: ", filePath);
+        return nullptr;
+    }
+
+    // Read version identifier
+    uint32_t fileVersion;
+    file.read(reinterpret_cast<char*>(&fileVersion), sizeof(fileVersion));
+
+    if (fileVersion != 1) {
+        logWrite("Unsupported file version: ", fileVersion);
+        return nullptr;
+    }
+
+    // Read basic parameters
+    diveMode mode;
+    bool bailout;
+    int diveNumber;
+    bool boosted;
+    double mission;
+    double firstDecoDepth;
+    
+    file.read(reinterpret_cast<char*>(&mode), sizeof(mode));
+    file.read(reinterpret_cast<char*>(&bailout), sizeof(bailout));
+    file.read(reinterpret_cast<char*>(&diveNumber), sizeof(diveNumber));
+    file.read(reinterpret_cast<char*>(&boosted), sizeof(boosted));
+    file.read(reinterpret_cast<char*>(&mission), sizeof(mission));
+    file.read(reinterpret_cast<char*>(&firstDecoDepth), sizeof(firstDecoDepth));
+
+    // Read summary values (we'll set these after loading everything else)
+    double tts, ttsDelta, ap, maxTimeResult, maxTTSResult, tp, turnTts;
+    file.read(reinterpret_cast<char*>(&tts), sizeof(tts));
+    file.read(reinterpret_cast<char*>(&ttsDelta), sizeof(ttsDelta));
+    file.read(reinterpret_cast<char*>(&ap), sizeof(ap));
+    file.read(reinterpret_cast<char*>(&maxTimeResult), sizeof(maxTimeResult));
+    file.read(reinterpret_cast<char*>(&maxTTSResult), sizeof(maxTTSResult));
+    file.read(reinterpret_cast<char*>(&tp), sizeof(tp));
+    file.read(reinterpret_cast<char*>(&turnTts), sizeof(turnTts));
+
+    // Read StopSteps
+    StopSteps stopSteps;
+    size_t stopStepsCount;
+    file.read(reinterpret_cast<char*>(&stopStepsCount), sizeof(stopStepsCount));
+    for (size_t i = 0; i < stopStepsCount; ++i) {
+        double depth, time;
+        file.read(reinterpret_cast<char*>(&depth), sizeof(depth));
+        file.read(reinterpret_cast<char*>(&time), sizeof(time));
+        stopSteps.addStopStep(depth, time);
+    }
+
+    // Read SetPoints
+    SetPoints setPoints;
+    size_t setPointsCount;
+    file.read(reinterpret_cast<char*>(&setPointsCount), sizeof(setPointsCount));
+    setPoints.m_depths.clear();
+    setPoints.m_setPoints.clear();
+    for (size_t i = 0; i < setPointsCount; ++i) {
+        double depth, setPoint;
+        file.read(reinterpret_cast<char*>(&depth), sizeof(depth));
+        file.read(reinterpret_cast<char*>(&setPoint), sizeof(setPoint));
+        setPoints.m_depths.push_back(depth);
+        setPoints.m_setPoints.push_back(setPoint);
+    }
+    setPoints.sortSetPoints();
+
+    // Read available gases
+    std::vector<GasAvailable> gasAvailable;
+    size_t gasCount;
+    file.read(reinterpret_cast<char*>(&gasCount), sizeof(gasCount));
+    for (size_t i = 0; i < gasCount; ++i) {
+        double o2Percent, hePercent;
+        GasType gasType;
+        GasStatus gasStatus;
         
-        loadedPlan = std::make_unique<DivePlan>(depth, time, mode, diveNumber, initialPressure);
-        loadedPlan->m_bailout = bailout;
-        loadedPlan->m_boosted = boosted;
-        loadedPlan->m_mission = mission;
-        loadedPlan->m_firstDecoDepth = firstDecoDepth;
+        // Read Gas properties
+        file.read(reinterpret_cast<char*>(&o2Percent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&hePercent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gasType), sizeof(GasType));
+        file.read(reinterpret_cast<char*>(&gasStatus), sizeof(GasStatus));
         
-        // Set summary values
-        loadedPlan->m_tts = tts;
-        loadedPlan->m_ttsDelta = ttsDelta;
-        loadedPlan->m_ap = ap;
-        loadedPlan->m_maxResult = std::make_pair(maxTimeResult, maxTTSResult);
-        loadedPlan->m_tp = tp;
-        loadedPlan->m_turnTts = turnTts;
+        // Create Gas object and GasAvailable object
+        Gas gas(o2Percent, hePercent, gasType, gasStatus);
+        GasAvailable gasObj(gas);
         
-        // Replace the automatically created stop steps with our loaded ones
-        loadedPlan->m_stopSteps = stopSteps;
+        // Read GasAvailable properties
+        file.read(reinterpret_cast<char*>(&gasObj.m_switchDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gasObj.m_switchPpO2), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gasObj.m_nbTanks), sizeof(int));
+        file.read(reinterpret_cast<char*>(&gasObj.m_tankCapacity), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gasObj.m_fillingPressure), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gasObj.m_reservePressure), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gasObj.m_consumption), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gasObj.m_endPressure), sizeof(double));
         
-        // Replace the setpoints with our loaded ones
-        loadedPlan->m_setPoints = setPoints;
+        gasAvailable.push_back(gasObj);
+    }
+
+    // Read initial pressure
+    std::vector<CompartmentPP> initialPressure;
+    size_t initialPressureCount;
+    file.read(reinterpret_cast<char*>(&initialPressureCount), sizeof(initialPressureCount));
+    for (size_t i = 0; i < initialPressureCount; ++i) {
+        double pN2, pHe, pInert;
+        file.read(reinterpret_cast<char*>(&pN2), sizeof(double));
+        file.read(reinterpret_cast<char*>(&pHe), sizeof(double));
+        file.read(reinterpret_cast<char*>(&pInert), sizeof(double));
+        initialPressure.push_back(CompartmentPP(pN2, pHe, pInert));
+    }
+
+    // Read saved GF values
+    double savedGF[2];
+    file.read(reinterpret_cast<char*>(&savedGF), sizeof(savedGF));
+
+    // Now we have enough information to fill in a new DivePlan object
+    std::unique_ptr<DivePlan> loadedPlan(new DivePlan());
+    loadedPlan->m_gf[0] = savedGF[0];
+    loadedPlan->m_gf[1] = savedGF[1];
+    loadedPlan->m_mode = mode;
+    loadedPlan->m_diveNumber = diveNumber;
+    loadedPlan->m_bailout = bailout;
+    loadedPlan->m_boosted = boosted;
+    loadedPlan->m_mission = mission;
+    loadedPlan->m_firstDecoDepth = firstDecoDepth;
+    
+    // Set summary values
+    loadedPlan->m_tts = tts;
+    loadedPlan->m_ttsDelta = ttsDelta;
+    loadedPlan->m_ap = ap;
+    loadedPlan->m_maxResult = std::make_pair(maxTimeResult, maxTTSResult);
+    loadedPlan->m_tp = tp;
+    loadedPlan->m_turnTts = turnTts;
+    
+    // Inputs
+    loadedPlan->m_stopSteps = stopSteps;
+    loadedPlan->m_setPoints = setPoints;
+    loadedPlan->m_gasAvailable = gasAvailable;
+    loadedPlan->m_initialPressure = toCompartmentPressures(initialPressure);
+    
+    // Read dive profile
+    size_t profileCount;
+    file.read(reinterpret_cast<char*>(&profileCount), sizeof(profileCount));
+    for (size_t i = 0; i < profileCount; ++i) {
+        DiveStep step;
         
-        // Replace the gas list with our loaded one
-        loadedPlan->m_gasAvailable = gasAvailable;
+        // Read basic step properties
+        file.read(reinterpret_cast<char*>(&step.m_phase), sizeof(Phase));
+        file.read(reinterpret_cast<char*>(&step.m_mode), sizeof(stepMode));
+        file.read(reinterpret_cast<char*>(&step.m_startDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_endDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_time), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_runTime), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_pAmbStartDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_pAmbEndDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_pAmbMax), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_pO2Max), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_o2Percent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_n2Percent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_hePercent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_gf), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_gfSurface), sizeof(double));
         
-        // Replace the initial pressure with our loaded one
-        loadedPlan->m_initialPressure = initialPressure;
+        // Read compartment data
+        for (auto& pp : step.m_ppMax) {
+            file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
+        }
         
-        // Clear the automatically created dive profile
-        loadedPlan->m_diveProfile.clear();
+        for (auto& pp : step.m_ppMaxAdjustedGF) {
+            file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
+        }
         
-        // Read dive profile
-        size_t profileCount;
-        file.read(reinterpret_cast<char*>(&profileCount), sizeof(profileCount));
-        for (size_t i = 0; i < profileCount; ++i) {
-            DiveStep step;
-            
-            // Read basic step properties
-            file.read(reinterpret_cast<char*>(&step.m_phase), sizeof(Phase));
-            file.read(reinterpret_cast<char*>(&step.m_mode), sizeof(stepMode));
-            file.read(reinterpret_cast<char*>(&step.m_startDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_endDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_time), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_runTime), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_pAmbStartDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_pAmbEndDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_pAmbMax), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_pO2Max), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_o2Percent), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_n2Percent), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_hePercent), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_gf), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_gfSurface), sizeof(double));
-            
-            // Read compartment data
-            for (auto& pp : step.m_ppMax) {
-                file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            for (auto& pp : step.m_ppMaxAdjustedGF) {
-                file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            for (auto& pp : step.m_ppActual) {
-                file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            // Read consumption and other metrics
-            file.read(reinterpret_cast<char*>(&step.m_sacRate), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_ambConsumptionAtDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_stepConsumption), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_gasDensity), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_endWithoutO2), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_endWithO2), sizeof(double));
-            
-            // Read oxygen toxicity metrics
-            file.read(reinterpret_cast<char*>(&step.m_cnsMaxMinSingleDive), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsStepSingleDive), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsTotalSingleDive), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsMaxMinMultipleDives), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsStepMultipleDives), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsTotalMultipleDives), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_otuPerMin), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_otuStep), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_otuTotal), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_ceiling), sizeof(double));
-            
-            loadedPlan->m_diveProfile.push_back(step);
+        for (auto& pp : step.m_ppActual) {
+            file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
         }
+        
+        // Read consumption and other metrics
+        file.read(reinterpret_cast<char*>(&step.m_sacRate), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_ambConsumptionAtDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_stepConsumption), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_gasDensity), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_endWithoutO2), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_endWithO2), sizeof(double));
+        
+        // Read oxygen toxicity metrics
+        file.read(reinterpret_cast<char*>(&step.m_cnsMaxMinSingleDive), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsStepSingleDive), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsTotalSingleDive), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsMaxMinMultipleDives), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsStepMultipleDives), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsTotalMultipleDives), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_otuPerMin), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_otuStep), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_otuTotal), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_ceiling), sizeof(double));
+        
+        loadedPlan->m_diveProfile.push_back(step);
+    }
 
-        // Read time profile
-        loadedPlan->m_timeProfile.clear();
-        size_t timeProfileCount;
-        file.read(reinterpret_cast<char*>(&timeProfileCount), sizeof(timeProfileCount));
-        for (size_t i = 0; i < timeProfileCount; ++i) {
-            DiveStep step;
-            
-            // Read basic step properties
-            file.read(reinterpret_cast<char*>(&step.m_phase), sizeof(Phase));
-            file.read(reinterpret_cast<char*>(&step.m_mode), sizeof(stepMode));
-            file.read(reinterpret_cast<char*>(&step.m_startDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_endDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_time), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_runTime), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_pAmbStartDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_pAmbEndDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_pAmbMax), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_pO2Max), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_o2Percent), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_n2Percent), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_hePercent), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_gf), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_gfSurface), sizeof(double));
-            
-            // Read compartment data
-            for (auto& pp : step.m_ppMax) {
-                file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            for (auto& pp : step.m_ppMaxAdjustedGF) {
-                file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            for (auto& pp : step.m_ppActual) {
-                file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
-                file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
-            }
-            
-            // Read consumption and other metrics
-            file.read(reinterpret_cast<char*>(&step.m_sacRate), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_ambConsumptionAtDepth), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_stepConsumption), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_gasDensity), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_endWithoutO2), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_endWithO2), sizeof(double));
-            
-            // Read oxygen toxicity metrics
-            file.read(reinterpret_cast<char*>(&step.m_cnsMaxMinSingleDive), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsStepSingleDive), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsTotalSingleDive), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsMaxMinMultipleDives), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsStepMultipleDives), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_cnsTotalMultipleDives), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_otuPerMin), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_otuStep), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_otuTotal), sizeof(double));
-            file.read(reinterpret_cast<char*>(&step.m_ceiling), sizeof(double));
-            
-            loadedPlan->m_timeProfile.push_back(step);
+    // Read time profile
+    auto timeProfile = std::make_shared<std::vector<DiveStep>>();
+    size_t timeProfileCount;
+    file.read(reinterpret_cast<char*>(&timeProfileCount), sizeof(timeProfileCount));
+    for (size_t i = 0; i < timeProfileCount; ++i) {
+        DiveStep step;
+        
+        // Read basic step properties
+        file.read(reinterpret_cast<char*>(&step.m_phase), sizeof(Phase));
+        file.read(reinterpret_cast<char*>(&step.m_mode), sizeof(stepMode));
+        file.read(reinterpret_cast<char*>(&step.m_startDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_endDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_time), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_runTime), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_pAmbStartDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_pAmbEndDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_pAmbMax), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_pO2Max), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_o2Percent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_n2Percent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_hePercent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_gf), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_gfSurface), sizeof(double));
+        
+        // Read compartment data
+        for (auto& pp : step.m_ppMax) {
+            file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
         }
-
-        file.close();
-        logWrite("Dive plan loaded successfully in ", timer.elapsed(), " ms from ", filePath);
         
-    }, filePath, "Error Loading Dive Plan");
-
-    if (success) {
-        loadedPlan->setFilePath(filePath);
+        for (auto& pp : step.m_ppMaxAdjustedGF) {
+            file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
+        }
+        
+        for (auto& pp : step.m_ppActual) {
+            file.read(reinterpret_cast<char*>(&pp.m_pN2), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pHe), sizeof(double));
+            file.read(reinterpret_cast<char*>(&pp.m_pInert), sizeof(double));
+        }
+        
+        // Read consumption and other metrics
+        file.read(reinterpret_cast<char*>(&step.m_sacRate), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_ambConsumptionAtDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_stepConsumption), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_gasDensity), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_endWithoutO2), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_endWithO2), sizeof(double));
+        
+        // Read oxygen toxicity metrics
+        file.read(reinterpret_cast<char*>(&step.m_cnsMaxMinSingleDive), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsStepSingleDive), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsTotalSingleDive), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsMaxMinMultipleDives), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsStepMultipleDives), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_cnsTotalMultipleDives), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_otuPerMin), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_otuStep), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_otuTotal), sizeof(double));
+        file.read(reinterpret_cast<char*>(&step.m_ceiling), sizeof(double));
+        
+        timeProfile->push_back(step);
     }
+    loadedPlan->m_timeProfile = std::move(timeProfile);
 
+    // Link each step to the gas breathed
+    loadedPlan->restoreGasIndices();
+
+    // The saved results were calculated with the parameters of the time the file was saved
+    loadedPlan->m_parametersEpoch = 0;
+    loadedPlan->m_timeProfileEpoch = 0;
+
+    file.close();
     return loadedPlan;
 }
 
+#endif
+
 } // namespace DiveComputer
@@ -1,15 +1,21 @@
 #ifndef DIVE_PLAN_HPP
 #define DIVE_PLAN_HPP
 
+#include <cstdint>
+#ifndef DIVECOMPUTER_EMBEDDED
 #include <vector>
 #include <memory>
-#include <set>
+#include <future>
+#include <mutex>
+#endif
 
+#include "core_config.hpp"
 #include "log_info.hpp"
 #include "enum.hpp"
 #include "dive_step.hpp"
 #include "stop_steps.hpp"
 #include "compartments.hpp"
+#include "dive_site.hpp"
 #include "parameters.hpp"
 #include "gas.hpp"
 #include "gaslist.hpp"
@@ -18,6 +24,12 @@
 
 namespace DiveComputer {
 
+#ifndef DIVECOMPUTER_EMBEDDED
+class ByteWriter;
+class DivePlanFileView;
+struct DivePlanFileInputs;
+#endif
+
 // Create a new struct for gas tracking
 struct GasAvailable {
     Gas    m_gas;
@@ -35,10 +47,51 @@ struct GasAvailable {
                                 m_consumption(0.0), m_endPressure(200.0) {}
 };
 
+// Steps of a plan
+using DiveProfile = CoreVector<DiveStep, MAX_DIVE_STEPS>;
+
+#ifndef DIVECOMPUTER_EMBEDDED
+// What-ifs of the summary, replanned concurrently on a snapshot of the plan.
+// A future that is not valid was not started, or is already stored in the plan.
+struct SummaryWhatIfs {
+    uint64_t m_revision{0};    // of the plan they were started on
+    std::future<double> m_ttsDelta;
+    std::future<std::pair<double, double>> m_maxResult;
+    std::future<double> m_turnTts;
+
+    bool pending() const { return m_ttsDelta.valid() || m_maxResult.valid() || m_turnTts.valid(); }
+};
+#endif
+
+#ifndef DIVECOMPUTER_EMBEDDED
+// Percent of the M-value of every compartment over the run time, on evenly spaced columns for the heat map:
+// the gradient factor at the ambient pressure, 0 at ambient, 100 at the M-value and negative while loading
+struct SaturationMap {
+    int    m_columns = 0;
+    double m_startTime = 0.0;          // run time of the first column
+    double m_endTime = 0.0;            // run time of the last column
+    std::vector<float>   m_percent;    // NUM_COMPARTMENTS per column, column after column
+    std::vector<uint8_t> m_leading;    // compartment with the highest percent in each column
+    std::vector<TissueLimit> m_controlling;  // compartment and gas of the ceiling at the nearest sample
+
+    bool  empty() const { return m_columns == 0; }
+    float percent(int column, int compartment) const { return m_percent[column * NUM_COMPARTMENTS + compartment]; }
+};
+
+// Lock of the members a plan fills on first access; a copy of the plan gets a lock of its own
+struct LazyLock {
+    LazyLock() = default;
+    LazyLock(const LazyLock&) {}
+    LazyLock& operator=(const LazyLock&) { return *this; }
+
+    std::recursive_mutex m_mutex;
+};
+#endif
+
 // Dive profile management class
 class DivePlan {
 public:
-    DivePlan(double depth, double time, diveMode mode, int diveNumber, std::vector<CompartmentPP> initialPressure);
+    DivePlan(double depth, double time, diveMode mode, int diveNumber, const CompartmentPressures& initialPressure);
     ~DivePlan() = default;
 
     StopSteps m_stopSteps;
@@ -48,8 +101,11 @@ public:
     bool m_bailout = false;
     int  m_diveNumber = 0;
     bool m_boosted = true;
+    bool m_waypoints = false;   // the stop steps are dived in their order, down and up, rather than deepest first
     SetPoints m_setPoints;
     double m_mission = 0.0;
+    double m_gf[2];           // GF low and high, from the parameters when the plan is created
+    DiveSite m_site;          // salt water at the atm. pressure of the parameters when the plan is created
 
     // Summary variables
     double m_tts = 0;
@@ -60,20 +116,22 @@ public:
     double m_turnTts = 0;
 
     // Dive variables
-    std::vector<DiveStep> m_diveProfile;
-    std::vector<DiveStep> m_timeProfile;
-    std::vector<GasAvailable> m_gasAvailable;
-    std::vector<CompartmentPP> m_initialPressure;
+    DiveProfile m_diveProfile;
+    CoreVector<GasAvailable, MAX_GASES> m_gasAvailable;
+    CompartmentPressures m_initialPressure;
 
     // Core methods
     int  nbOfSteps();
     void loadAvailableGases();
+    void reloadAvailableGases();    // after a gas list change, keeping the tanks of the gases still there
     void buildDivePlan();
     void calculateDivePlan(bool printLog = true);
     void calculateDiveSummary(bool printLog = true);
     void calculateGasConsumption(bool printLog = true);
     void calculateOtherVariables(double GF, bool printLog = true);
-    void calculateTimeProfile(bool printLog = true);
+#ifndef DIVECOMPUTER_EMBEDDED
+    void calculateTimeProfile(bool printLog = true) const;
+#endif
 
     // Action methods
     std::pair<double, double> getMaxTimeAndTTS();
@@ -85,6 +143,46 @@ public:
     double getTurnTTS();
     double getNoFlyTime();
 
+    // Stop the final ascent starts from, the end of the bottom time: the last one reached
+    // going down, which is the deepest unless the plan is a waypoint profile. 0 if none.
+    int bottomStopIndex() const;
+
+    // Last descent of the profile: the legs before it are followed by a descent and stay
+    // on the gases of the bottom. 0 if none.
+    int lastDescentIndex() const;
+
+    // State of the dive at a run time, computed from the step it falls in
+    DiveStep getStateAtTime(double runTime) const;
+
+    // Incremented by every calculation, for the views caching what they draw from the plan
+    uint64_t revision() const { return m_revision; }
+
+    // Epoch of the parameters the plan was last calculated with
+    uint64_t parametersEpoch() const { return m_parametersEpoch; }
+#ifdef DIVECOMPUTER_EMBEDDED
+    // Plan the what-ifs of the summary are calculated on, set once at start up:
+    // without it, the TTS delta, max time and turn TTS are 0
+    void setScratchPlan(DivePlan* plan) { m_scratchPlan = plan; }
+
+    // True when a step, stop or gas did not fit and the plan is incomplete
+    bool overflowed() const;
+#else
+    // Summary in two halves: the metrics read from the plan are set at once and the what-ifs
+    // started on the compute pool as tasks of owner, then the what-ifs are stored as they
+    // complete, or all of them with wait. True when none is left; those of an older revision
+    // are dropped.
+    SummaryWhatIfs startDiveSummary(const void* owner = nullptr);
+    bool collectDiveSummary(SummaryWhatIfs& whatIfs, bool wait);
+
+    // Cumulative consumption of a cylinder at each sample of a time profile
+    static std::vector<double> getGasConsumptionSeries(const std::vector<DiveStep>& samples, int gasIndex);
+
+    // Snapshots: a calculation replaces them and leaves the ones already returned untouched
+    std::shared_ptr<const std::vector<DiveStep>> timeProfile() const;
+    std::shared_ptr<const SaturationMap> saturationMap() const;
+#endif
+
+#ifndef DIVECOMPUTER_EMBEDDED
     // Print-to-terminal functions
     void printPlan(std::vector<DiveStep> profile);
     void printCompartmentDetails(int compartment);
@@ -95,27 +193,68 @@ public:
     // Save and load dive plan
     bool saveDiveToFile(const std::string& filePath);
     static std::unique_ptr<DivePlan> loadDiveFromFile(const std::string& filePath);
+
+    // Plan set up from decoded inputs, built but not calculated
+    static std::unique_ptr<DivePlan> createFromInputs(const DivePlanFileInputs& inputs);
+
+    // Bytes of the inputs section: plans with the same key calculate to the same results
+    std::string inputsKey() const;
+    // Takes the results of a plan calculated from the same inputs, as a new revision
+    void adoptResults(const DivePlan& calculated);
     std::string getFilePath() const { return m_filePath; }
     void setFilePath(const std::string& path) { m_filePath = path; }
+#endif
 
 private:
+    DivePlan();
+
     double m_firstDecoDepth;
+    uint64_t m_revision{0};
+    uint64_t m_parametersEpoch{0};
+#ifdef DIVECOMPUTER_EMBEDDED
+    DivePlan* m_scratchPlan{nullptr};
+#else
     std::string m_filePath;  // Store the file path for reloading
 
+    // Time profile, sampled on first access after a calculation or read lazily
+    // from m_timeProfileSource when loaded from a file. The const accessors may be called
+    // from several threads at once (the GUI and the pool): they fill it under m_lazyLock,
+    // and hand out the immutable snapshot a later calculation replaces instead of clearing.
+    mutable LazyLock m_lazyLock;
+    mutable std::shared_ptr<const std::vector<DiveStep>> m_timeProfile;
+    mutable bool m_timeProfileStale{false};
+    mutable uint64_t m_timeProfileEpoch{0};    // parameters epoch it was sampled at
+    mutable std::shared_ptr<DivePlanFileView> m_timeProfileSource;
+    mutable std::shared_ptr<const SaturationMap> m_saturationMap;    // built from the time profile
+#endif
+
     // Helper methods
     void   clear();
     void   clearDecoSteps();
     void   sortGases();
     void   applyGases();
+    int    selectGasIndex(const DiveStep& step, bool decoGases = true) const;
+    DiveStep sampleStep(int index, double elapsed, const DiveStep& previousSample) const;
+    void   applyGasToStep(DiveStep& step, int gasIndex, double setPoint) const;
+#ifndef DIVECOMPUTER_EMBEDDED
+    void   addTimeSamples(std::vector<DiveStep>& samples, int index, double from, const DiveStep& fromState, double to, const DiveStep& toState) const;
+    std::shared_ptr<DivePlan> summarySnapshot() const;
+    static std::shared_ptr<const SaturationMap> buildSaturationMap(const std::vector<DiveStep>& samples);
+    void   restoreGasIndices();
+    void   writeInputsSection(ByteWriter& writer) const;
+    void   writeSummarySection(ByteWriter& writer, uint64_t inputsChecksum) const;
+    static std::unique_ptr<DivePlan> loadDiveFromFileV1(const std::string& filePath);
+    static std::unique_ptr<DivePlan> loadDiveFromFileV2(const std::string& filePath);
+#endif
     void   calculatePPInertGas();
     void   calculatePPInertGasMax();
     void   applyGF();
-    void   setFirstDecoDepth();
+    double predictFirstDecoDepth();
     void   calculateDecoSteps();
     bool   getIfBreachingDecoLimitsInRange(int deco, int next_deco);
     void   calculatePPInertGasInRange(int deco, int next_deco);
     double calculateFirstStopDepth(double maxDepth);
-    void   processAscentStops(const std::vector<double>& ascentStops);
+    void   addAscent(double fromDepth, double toDepth, const double* decoDepths, size_t count, stepMode mode);
     bool   enoughGasAvailable();
 
     DiveStep& addStep(double start_depth, double end_depth, double time, Phase phase, stepMode mode);
@@ -0,0 +1,634 @@
+#include "dive_plan_file.hpp"
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+
+namespace DiveComputer {
+
+// Column ids of the profile sections
+enum ProfileColumnId : uint32_t {
+    COLUMN_PHASE = 1,
+    COLUMN_MODE,
+    COLUMN_GAS_INDEX,
+    COLUMN_START_DEPTH,
+    COLUMN_END_DEPTH,
+    COLUMN_TIME,
+    COLUMN_RUN_TIME,
+    COLUMN_P_AMB_START_DEPTH,
+    COLUMN_P_AMB_END_DEPTH,
+    COLUMN_P_AMB_MAX,
+    COLUMN_P_O2_MAX,
+    COLUMN_O2_PERCENT,
+    COLUMN_N2_PERCENT,
+    COLUMN_HE_PERCENT,
+    COLUMN_GF,
+    COLUMN_GF_SURFACE,
+    COLUMN_SAC_RATE,
+    COLUMN_AMB_CONSUMPTION_AT_DEPTH,
+    COLUMN_STEP_CONSUMPTION,
+    COLUMN_GAS_DENSITY,
+    COLUMN_END_WITHOUT_O2,
+    COLUMN_END_WITH_O2,
+    COLUMN_CNS_MAX_MIN_SINGLE_DIVE,
+    COLUMN_CNS_STEP_SINGLE_DIVE,
+    COLUMN_CNS_TOTAL_SINGLE_DIVE,
+    COLUMN_CNS_MAX_MIN_MULTIPLE_DIVES,
+    COLUMN_CNS_STEP_MULTIPLE_DIVES,
+    COLUMN_CNS_TOTAL_MULTIPLE_DIVES,
+    COLUMN_OTU_PER_MIN,
+    COLUMN_OTU_STEP,
+    COLUMN_OTU_TOTAL,
+    COLUMN_CEILING,
+    COLUMN_CEILING_COMPARTMENT,
+    COLUMN_CEILING_GAS,
+    COLUMN_GF_SURFACE_COMPARTMENT,
+    COLUMN_GF_SURFACE_GAS,
+
+    // Compartment columns: base + (set * NUM_COMPARTMENTS + compartment) * 3 + gas (N2, He, inert)
+    // set 0: ppMax, 1: ppMaxAdjustedGF, 2: ppActual
+    COLUMN_COMPARTMENT_BASE = 256,
+};
+
+struct DoubleColumn {
+    uint32_t m_id;
+    double DiveStep::* m_member;
+};
+
+static const DoubleColumn DOUBLE_COLUMNS[] = {
+    {COLUMN_START_DEPTH, &DiveStep::m_startDepth},
+    {COLUMN_END_DEPTH, &DiveStep::m_endDepth},
+    {COLUMN_TIME, &DiveStep::m_time},
+    {COLUMN_RUN_TIME, &DiveStep::m_runTime},
+    {COLUMN_P_AMB_START_DEPTH, &DiveStep::m_pAmbStartDepth},
+    {COLUMN_P_AMB_END_DEPTH, &DiveStep::m_pAmbEndDepth},
+    {COLUMN_P_AMB_MAX, &DiveStep::m_pAmbMax},
+    {COLUMN_P_O2_MAX, &DiveStep::m_pO2Max},
+    {COLUMN_O2_PERCENT, &DiveStep::m_o2Percent},
+    {COLUMN_N2_PERCENT, &DiveStep::m_n2Percent},
+    {COLUMN_HE_PERCENT, &DiveStep::m_hePercent},
+    {COLUMN_GF, &DiveStep::m_gf},
+    {COLUMN_GF_SURFACE, &DiveStep::m_gfSurface},
+    {COLUMN_SAC_RATE, &DiveStep::m_sacRate},
+    {COLUMN_AMB_CONSUMPTION_AT_DEPTH, &DiveStep::m_ambConsumptionAtDepth},
+    {COLUMN_STEP_CONSUMPTION, &DiveStep::m_stepConsumption},
+    {COLUMN_GAS_DENSITY, &DiveStep::m_gasDensity},
+    {COLUMN_END_WITHOUT_O2, &DiveStep::m_endWithoutO2},
+    {COLUMN_END_WITH_O2, &DiveStep::m_endWithO2},
+    {COLUMN_CNS_MAX_MIN_SINGLE_DIVE, &DiveStep::m_cnsMaxMinSingleDive},
+    {COLUMN_CNS_STEP_SINGLE_DIVE, &DiveStep::m_cnsStepSingleDive},
+    {COLUMN_CNS_TOTAL_SINGLE_DIVE, &DiveStep::m_cnsTotalSingleDive},
+    {COLUMN_CNS_MAX_MIN_MULTIPLE_DIVES, &DiveStep::m_cnsMaxMinMultipleDives},
+    {COLUMN_CNS_STEP_MULTIPLE_DIVES, &DiveStep::m_cnsStepMultipleDives},
+    {COLUMN_CNS_TOTAL_MULTIPLE_DIVES, &DiveStep::m_cnsTotalMultipleDives},
+    {COLUMN_OTU_PER_MIN, &DiveStep::m_otuPerMin},
+    {COLUMN_OTU_STEP, &DiveStep::m_otuStep},
+    {COLUMN_OTU_TOTAL, &DiveStep::m_otuTotal},
+    {COLUMN_CEILING, &DiveStep::m_ceiling},
+};
+
+static constexpr int NUM_DOUBLE_COLUMNS = sizeof(DOUBLE_COLUMNS) / sizeof(DOUBLE_COLUMNS[0]);
+static constexpr int NUM_INT_COLUMNS = 7;
+static constexpr int NUM_COMPARTMENT_SETS = 3;
+static constexpr int NUM_COMPARTMENT_COLUMNS = NUM_COMPARTMENT_SETS * NUM_COMPARTMENTS * 3;
+
+static CompartmentPressures& compartmentSet(DiveStep& step, int set) {
+    return (set == 0) ? step.m_ppMax : (set == 1) ? step.m_ppMaxAdjustedGF : step.m_ppActual;
+}
+
+static const CompartmentPressures& compartmentSet(const DiveStep& step, int set) {
+    return (set == 0) ? step.m_ppMax : (set == 1) ? step.m_ppMaxAdjustedGF : step.m_ppActual;
+}
+
+static double compartmentValue(const CompartmentPP& pp, int gas) {
+    return (gas == 0) ? pp.m_pN2 : (gas == 1) ? pp.m_pHe : pp.m_pInert;
+}
+
+static void setCompartmentValue(CompartmentPP& pp, int gas, double value) {
+    if (gas == 0) pp.m_pN2 = value;
+    else if (gas == 1) pp.m_pHe = value;
+    else pp.m_pInert = value;
+}
+
+static int32_t intColumnValue(const DiveStep& step, uint32_t columnId) {
+    switch (columnId) {
+        case COLUMN_PHASE: return static_cast<int32_t>(step.m_phase);
+        case COLUMN_MODE: return static_cast<int32_t>(step.m_mode);
+        case COLUMN_CEILING_COMPARTMENT: return step.m_ceilingLimit.m_compartment;
+        case COLUMN_CEILING_GAS: return static_cast<int32_t>(step.m_ceilingLimit.m_gas);
+        case COLUMN_GF_SURFACE_COMPARTMENT: return step.m_gfSurfaceLimit.m_compartment;
+        case COLUMN_GF_SURFACE_GAS: return static_cast<int32_t>(step.m_gfSurfaceLimit.m_gas);
+        default: return step.m_gasIndex;
+    }
+}
+
+// PROFILE SECTIONS
+
+void writeProfileSection(ByteWriter& writer, const std::vector<DiveStep>& profile) {
+    const size_t rowCount = profile.size();
+    const uint32_t columnCount = NUM_INT_COLUMNS + NUM_DOUBLE_COLUMNS + NUM_COMPARTMENT_COLUMNS;
+
+    DivePlanFileColumnSet columnSet{rowCount, columnCount, 0};
+    writer.write(columnSet);
+
+    // Column directory: the data starts after it, every column aligned on 8 bytes
+    const uint64_t intColumnSize = ((rowCount * sizeof(int32_t) + 7) / 8) * 8;
+    const uint64_t doubleColumnSize = rowCount * sizeof(double);
+    uint64_t offset = sizeof(DivePlanFileColumnSet) + columnCount * sizeof(DivePlanFileColumn);
+
+    const uint32_t intColumns[NUM_INT_COLUMNS] = {COLUMN_PHASE, COLUMN_MODE, COLUMN_GAS_INDEX,
+                                                  COLUMN_CEILING_COMPARTMENT, COLUMN_CEILING_GAS,
+                                                  COLUMN_GF_SURFACE_COMPARTMENT, COLUMN_GF_SURFACE_GAS};
+    for (uint32_t id : intColumns) {
+        writer.write(DivePlanFileColumn{id, static_cast<uint32_t>(DivePlanColumnType::INT32), offset});
+        offset += intColumnSize;
+    }
+    for (const auto& column : DOUBLE_COLUMNS) {
+        writer.write(DivePlanFileColumn{column.m_id, static_cast<uint32_t>(DivePlanColumnType::DOUBLE), offset});
+        offset += doubleColumnSize;
+    }
+    for (uint32_t k = 0; k < NUM_COMPARTMENT_COLUMNS; k++) {
+        writer.write(DivePlanFileColumn{COLUMN_COMPARTMENT_BASE + k, static_cast<uint32_t>(DivePlanColumnType::DOUBLE), offset});
+        offset += doubleColumnSize;
+    }
+
+    // Column data, gathered in one buffer per column and appended in bulk
+    std::vector<int32_t> intValues(rowCount);
+    for (uint32_t id : intColumns) {
+        for (size_t i = 0; i < rowCount; i++) intValues[i] = intColumnValue(profile[i], id);
+        writer.writeBytes(intValues.data(), rowCount * sizeof(int32_t));
+        writer.align();
+    }
+
+    std::vector<double> values(rowCount);
+    for (const auto& column : DOUBLE_COLUMNS) {
+        for (size_t i = 0; i < rowCount; i++) values[i] = profile[i].*(column.m_member);
+        writer.writeBytes(values.data(), doubleColumnSize);
+    }
+    for (int set = 0; set < NUM_COMPARTMENT_SETS; set++) {
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            for (int gas = 0; gas < 3; gas++) {
+                for (size_t i = 0; i < rowCount; i++) values[i] = compartmentValue(compartmentSet(profile[i], set)[j], gas);
+                writer.writeBytes(values.data(), doubleColumnSize);
+            }
+        }
+    }
+}
+
+// Column of a profile section, or nullptr if absent, of another type or out of the section
+static const char* findColumn(const char* section, size_t sectionSize, const DivePlanFileColumnSet& columnSet,
+                              uint32_t columnId, DivePlanColumnType type) {
+    if (sizeof(DivePlanFileColumnSet) + (uint64_t) columnSet.m_columnCount * sizeof(DivePlanFileColumn) > sectionSize) return nullptr;
+
+    const size_t valueSize = (type == DivePlanColumnType::DOUBLE) ? sizeof(double) : sizeof(int32_t);
+    for (uint32_t k = 0; k < columnSet.m_columnCount; k++) {
+        DivePlanFileColumn column;
+        std::memcpy(&column, section + sizeof(DivePlanFileColumnSet) + k * sizeof(DivePlanFileColumn), sizeof(column));
+        if (column.m_id != columnId) continue;
+
+        // Compared without products or sums, which the offsets and counts of a damaged file can overflow
+        if (column.m_type != static_cast<uint32_t>(type) || column.m_offset > sectionSize ||
+            columnSet.m_rowCount > (sectionSize - column.m_offset) / valueSize) {
+            return nullptr;
+        }
+        return section + column.m_offset;
+    }
+    return nullptr;
+}
+
+template <typename T>
+static T columnValue(const char* column, size_t row) {
+    T value;
+    std::memcpy(&value, column + row * sizeof(T), sizeof(T));
+    return value;
+}
+
+bool readProfileSection(const char* section, size_t sectionSize, std::vector<DiveStep>& profile) {
+    DivePlanFileColumnSet columnSet;
+    ByteReader reader(section, sectionSize);
+    if (!reader.read(columnSet)) return false;
+
+    // Each column holds at least 4 bytes a row: a row count the section cannot hold is a
+    // damaged file, and is not allocated
+    const uint64_t rowSize = (uint64_t) columnSet.m_columnCount * sizeof(int32_t);
+    const uint64_t columnsSize = sectionSize - sizeof(DivePlanFileColumnSet);
+    if (rowSize == 0 ? columnSet.m_rowCount != 0 : columnSet.m_rowCount > columnsSize / rowSize) return false;
+
+    const size_t rowCount = columnSet.m_rowCount;
+    profile.assign(rowCount, DiveStep());
+
+    auto intColumn = [&](uint32_t id) { return findColumn(section, sectionSize, columnSet, id, DivePlanColumnType::INT32); };
+    auto doubleColumn = [&](uint32_t id) { return findColumn(section, sectionSize, columnSet, id, DivePlanColumnType::DOUBLE); };
+
+    if (const char* phases = intColumn(COLUMN_PHASE)) {
+        for (size_t i = 0; i < rowCount; i++) profile[i].m_phase = static_cast<Phase>(columnValue<int32_t>(phases, i));
+    }
+    if (const char* modes = intColumn(COLUMN_MODE)) {
+        for (size_t i = 0; i < rowCount; i++) profile[i].m_mode = static_cast<stepMode>(columnValue<int32_t>(modes, i));
+    }
+    if (const char* gasIndices = intColumn(COLUMN_GAS_INDEX)) {
+        for (size_t i = 0; i < rowCount; i++) profile[i].m_gasIndex = columnValue<int32_t>(gasIndices, i);
+    }
+
+    // Controlling compartments, not in the files written before they were tracked
+    if (const char* compartments = intColumn(COLUMN_CEILING_COMPARTMENT)) {
+        for (size_t i = 0; i < rowCount; i++) profile[i].m_ceilingLimit.m_compartment = columnValue<int32_t>(compartments, i);
+    }
+    if (const char* gases = intColumn(COLUMN_CEILING_GAS)) {
+        for (size_t i = 0; i < rowCount; i++) profile[i].m_ceilingLimit.m_gas = static_cast<LimitingGas>(columnValue<int32_t>(gases, i));
+    }
+    if (const char* compartments = intColumn(COLUMN_GF_SURFACE_COMPARTMENT)) {
+        for (size_t i = 0; i < rowCount; i++) profile[i].m_gfSurfaceLimit.m_compartment = columnValue<int32_t>(compartments, i);
+    }
+    if (const char* gases = intColumn(COLUMN_GF_SURFACE_GAS)) {
+        for (size_t i = 0; i < rowCount; i++) profile[i].m_gfSurfaceLimit.m_gas = static_cast<LimitingGas>(columnValue<int32_t>(gases, i));
+    }
+
+    for (const auto& column : DOUBLE_COLUMNS) {
+        if (const char* values = doubleColumn(column.m_id)) {
+            for (size_t i = 0; i < rowCount; i++) profile[i].*(column.m_member) = columnValue<double>(values, i);
+        }
+    }
+
+    for (int set = 0; set < NUM_COMPARTMENT_SETS; set++) {
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            for (int gas = 0; gas < 3; gas++) {
+                uint32_t id = COLUMN_COMPARTMENT_BASE + (set * NUM_COMPARTMENTS + j) * 3 + gas;
+                if (const char* values = doubleColumn(id)) {
+                    for (size_t i = 0; i < rowCount; i++) {
+                        setCompartmentValue(compartmentSet(profile[i], set)[j], gas, columnValue<double>(values, i));
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// INPUTS AND SUMMARY SECTIONS
+
+bool readInputsSection(const char* data, size_t size, DivePlanFileInputs& inputs) {
+    ByteReader reader(data, size);
+
+    uint8_t bailout = 0, boosted = 0;
+    uint16_t padding = 0;
+    reader.read(inputs.m_mode);
+    reader.read(bailout);
+    reader.read(boosted);
+    reader.read(padding);
+    reader.read(inputs.m_diveNumber);
+    reader.read(inputs.m_mission);
+    reader.read(inputs.m_gf[0]);
+    reader.read(inputs.m_gf[1]);
+    inputs.m_bailout = bailout != 0;
+    inputs.m_boosted = boosted != 0;
+
+    uint32_t count = 0;
+    reader.read(count);
+    inputs.m_stopSteps.clear();
+    for (uint32_t i = 0; i < count && !reader.failed(); ++i) {
+        std::pair<double, double> stopStep{0.0, 0.0};
+        reader.read(stopStep.first);
+        reader.read(stopStep.second);
+        inputs.m_stopSteps.push_back(stopStep);
+    }
+
+    count = 0;
+    reader.read(count);
+    inputs.m_setPoints.clear();
+    for (uint32_t i = 0; i < count && !reader.failed(); ++i) {
+        std::pair<double, double> setPoint{0.0, 0.0};
+        reader.read(setPoint.first);
+        reader.read(setPoint.second);
+        inputs.m_setPoints.push_back(setPoint);
+    }
+
+    count = 0;
+    reader.read(count);
+    inputs.m_gases.clear();
+    for (uint32_t i = 0; i < count && !reader.failed(); ++i) {
+        DivePlanFileGas gas;
+        reader.read(gas.m_o2Percent);
+        reader.read(gas.m_hePercent);
+        reader.read(gas.m_gasType);
+        reader.read(gas.m_gasStatus);
+        reader.read(gas.m_nbTanks);
+        reader.read(gas.m_tankCapacity);
+        reader.read(gas.m_fillingPressure);
+        reader.read(gas.m_reservePressure);
+        inputs.m_gases.push_back(gas);
+    }
+
+    count = 0;
+    reader.read(count);
+    inputs.m_initialPressure.clear();
+    for (uint32_t i = 0; i < count && !reader.failed(); ++i) {
+        double pN2 = 0.0, pHe = 0.0, pInert = 0.0;
+        reader.read(pN2);
+        reader.read(pHe);
+        reader.read(pInert);
+        inputs.m_initialPressure.push_back(CompartmentPP(pN2, pHe, pInert));
+    }
+
+    // Dive site and waypoints, added after the first version 2 files
+    if (!reader.failed() && !reader.atEnd()) {
+        reader.read(inputs.m_waterType);
+        reader.read(inputs.m_surfacePressure);
+    }
+    if (!reader.failed() && !reader.atEnd()) {
+        uint8_t waypoints = 0;
+        reader.read(waypoints);
+        inputs.m_waypoints = waypoints != 0;
+    }
+
+    return !reader.failed();
+}
+
+bool readSummarySection(const char* data, size_t size, DivePlanFileSummary& summary, std::vector<DivePlanFileGas>& gases) {
+    ByteReader reader(data, size);
+
+    reader.read(summary.m_firstDecoDepth);
+    reader.read(summary.m_tts);
+    reader.read(summary.m_ttsDelta);
+    reader.read(summary.m_ap);
+    reader.read(summary.m_maxTime);
+    reader.read(summary.m_maxTTS);
+    reader.read(summary.m_tp);
+    reader.read(summary.m_turnTts);
+    reader.read(summary.m_maxDepth);
+    reader.read(summary.m_runTime);
+    reader.read(summary.m_savedAt);
+
+    uint32_t gasCount = 0;
+    reader.read(gasCount);
+    for (uint32_t i = 0; i < gasCount && !reader.failed(); ++i) {
+        double values[4] = {0.0, 0.0, 0.0, 0.0};
+        for (double& value : values) reader.read(value);
+        if (i < gases.size()) {
+            gases[i].m_switchDepth = values[0];
+            gases[i].m_switchPpO2 = values[1];
+            gases[i].m_consumption = values[2];
+            gases[i].m_endPressure = values[3];
+        }
+    }
+
+    reader.read(summary.m_inputsChecksum);
+
+    // Added later: files saved before have results of unknown parameters
+    if (!reader.atEnd()) {
+        reader.read(summary.m_parametersChecksum);
+    }
+    return !reader.failed() && gasCount == gases.size();
+}
+
+// Version 1 files have no section table: read the leading values in sequence, then
+// seek to the run time of the last dive profile step
+static bool readDivePlanFileSummaryV1(const std::string& filePath, DivePlanFileInputs& inputs, DivePlanFileSummary& summary) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    uint32_t fileVersion = 0;
+    file.read(reinterpret_cast<char*>(&fileVersion), sizeof(fileVersion));
+    if (fileVersion != 1) return false;
+
+    diveMode mode;
+    int diveNumber = 0;
+    file.read(reinterpret_cast<char*>(&mode), sizeof(mode));
+    file.read(reinterpret_cast<char*>(&inputs.m_bailout), sizeof(inputs.m_bailout));
+    file.read(reinterpret_cast<char*>(&diveNumber), sizeof(diveNumber));
+    file.read(reinterpret_cast<char*>(&inputs.m_boosted), sizeof(inputs.m_boosted));
+    file.read(reinterpret_cast<char*>(&inputs.m_mission), sizeof(inputs.m_mission));
+    file.read(reinterpret_cast<char*>(&summary.m_firstDecoDepth), sizeof(double));
+    inputs.m_mode = static_cast<int32_t>(mode);
+    inputs.m_diveNumber = diveNumber;
+
+    file.read(reinterpret_cast<char*>(&summary.m_tts), sizeof(double));
+    file.read(reinterpret_cast<char*>(&summary.m_ttsDelta), sizeof(double));
+    file.read(reinterpret_cast<char*>(&summary.m_ap), sizeof(double));
+    file.read(reinterpret_cast<char*>(&summary.m_maxTime), sizeof(double));
+    file.read(reinterpret_cast<char*>(&summary.m_maxTTS), sizeof(double));
+    file.read(reinterpret_cast<char*>(&summary.m_tp), sizeof(double));
+    file.read(reinterpret_cast<char*>(&summary.m_turnTts), sizeof(double));
+
+    size_t count = 0;
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    inputs.m_stopSteps.clear();
+    for (size_t i = 0; i < count && file.good(); ++i) {
+        std::pair<double, double> stopStep{0.0, 0.0};
+        file.read(reinterpret_cast<char*>(&stopStep.first), sizeof(double));
+        file.read(reinterpret_cast<char*>(&stopStep.second), sizeof(double));
+        inputs.m_stopSteps.push_back(stopStep);
+        summary.m_maxDepth = std::max(summary.m_maxDepth, stopStep.first);
+    }
+
+    count = 0;
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    inputs.m_setPoints.clear();
+    for (size_t i = 0; i < count && file.good(); ++i) {
+        std::pair<double, double> setPoint{0.0, 0.0};
+        file.read(reinterpret_cast<char*>(&setPoint.first), sizeof(double));
+        file.read(reinterpret_cast<char*>(&setPoint.second), sizeof(double));
+        inputs.m_setPoints.push_back(setPoint);
+    }
+
+    count = 0;
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    inputs.m_gases.clear();
+    for (size_t i = 0; i < count && file.good(); ++i) {
+        DivePlanFileGas gas;
+        GasType gasType;
+        GasStatus gasStatus;
+        int nbTanks = 1;
+        file.read(reinterpret_cast<char*>(&gas.m_o2Percent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gas.m_hePercent), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gasType), sizeof(GasType));
+        file.read(reinterpret_cast<char*>(&gasStatus), sizeof(GasStatus));
+        file.read(reinterpret_cast<char*>(&gas.m_switchDepth), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gas.m_switchPpO2), sizeof(double));
+        file.read(reinterpret_cast<char*>(&nbTanks), sizeof(int));
+        file.read(reinterpret_cast<char*>(&gas.m_tankCapacity), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gas.m_fillingPressure), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gas.m_reservePressure), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gas.m_consumption), sizeof(double));
+        file.read(reinterpret_cast<char*>(&gas.m_endPressure), sizeof(double));
+        gas.m_gasType = static_cast<int32_t>(gasType);
+        gas.m_gasStatus = static_cast<int32_t>(gasStatus);
+        gas.m_nbTanks = nbTanks;
+        inputs.m_gases.push_back(gas);
+    }
+
+    count = 0;
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    inputs.m_initialPressure.clear();
+    for (size_t i = 0; i < count && file.good(); ++i) {
+        double pp[3] = {0.0, 0.0, 0.0};
+        file.read(reinterpret_cast<char*>(pp), sizeof(pp));
+        inputs.m_initialPressure.push_back(CompartmentPP(pp[0], pp[1], pp[2]));
+    }
+
+    file.read(reinterpret_cast<char*>(inputs.m_gf), sizeof(inputs.m_gf));
+
+    // Every version 1 step has the same size; the run time is its fourth value
+    const std::streamoff stepSize = sizeof(Phase) + sizeof(stepMode) + (13 + NUM_COMPARTMENT_COLUMNS + 16) * sizeof(double);
+    const std::streamoff runTimeOffset = sizeof(Phase) + sizeof(stepMode) + 3 * sizeof(double);
+    size_t profileCount = 0;
+    file.read(reinterpret_cast<char*>(&profileCount), sizeof(profileCount));
+    if (file.good() && profileCount > 0) {
+        file.seekg(static_cast<std::streamoff>(profileCount - 1) * stepSize + runTimeOffset, std::ios::cur);
+        file.read(reinterpret_cast<char*>(&summary.m_runTime), sizeof(double));
+    }
+
+    return file.good();
+}
+
+bool readDivePlanFileSummary(const std::string& filePath, DivePlanFileInputs& inputs, DivePlanFileSummary& summary) {
+    if (!DivePlanFileView::hasMagic(filePath)) {
+        return readDivePlanFileSummaryV1(filePath, inputs, summary);
+    }
+
+    // Only the pages of the header, the inputs and the summary are touched
+    DivePlanFileView view;
+    if (!view.open(filePath) || view.version() > DIVE_PLAN_FILE_VERSION) return false;
+
+    size_t size = 0;
+    const char* data = view.section(DivePlanSection::INPUTS, size);
+    if (!data || !readInputsSection(data, size, inputs)) return false;
+
+    data = view.section(DivePlanSection::SUMMARY, size);
+    return data && readSummarySection(data, size, summary, inputs.m_gases);
+}
+
+// FILE ASSEMBLY
+
+uint64_t checksumBytes(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool writeDivePlanFile(const std::string& filePath, const std::vector<std::pair<DivePlanSection, const ByteWriter*>>& sections) {
+    const std::string tempPath = filePath + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        logError("Failed to open file for writing: ", tempPath);
+        return false;
+    }
+
+    DivePlanFileHeader header;
+    std::memcpy(header.m_magic, DIVE_PLAN_FILE_MAGIC, sizeof(header.m_magic));
+    header.m_version = DIVE_PLAN_FILE_VERSION;
+    header.m_sectionCount = static_cast<uint32_t>(sections.size());
+
+    // Section table: sections follow it, each aligned on 8 bytes
+    std::vector<DivePlanFileSection> table;
+    uint64_t offset = sizeof(DivePlanFileHeader) + sections.size() * sizeof(DivePlanFileSection);
+    for (const auto& section : sections) {
+        offset = ((offset + 7) / 8) * 8;
+        table.push_back(DivePlanFileSection{static_cast<uint32_t>(section.first), 0, offset, section.second->size()});
+        offset += section.second->size();
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(DivePlanFileSection));
+
+    uint64_t position = sizeof(DivePlanFileHeader) + table.size() * sizeof(DivePlanFileSection);
+    const char padding[8] = {0};
+    for (size_t i = 0; i < sections.size(); i++) {
+        file.write(padding, table[i].m_offset - position);
+        file.write(sections[i].second->buffer().data(), sections[i].second->size());
+        position = table[i].m_offset + table[i].m_size;
+    }
+
+    file.close();
+    if (file.fail()) {
+        std::filesystem::remove(tempPath);
+        return false;
+    }
+
+    std::filesystem::rename(tempPath, filePath);
+    return true;
+}
+
+// FILE VIEW
+
+DivePlanFileView::~DivePlanFileView() {
+    close();
+}
+
+bool DivePlanFileView::hasMagic(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    char magic[8] = {0};
+    file.read(magic, sizeof(magic));
+    return file.gcount() == sizeof(magic) && std::memcmp(magic, DIVE_PLAN_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+bool DivePlanFileView::open(const std::string& filePath) {
+    close();
+
+    m_file = new QFile(QString::fromStdString(filePath));
+    if (!m_file->open(QIODevice::ReadOnly)) {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<size_t>(m_file->size());
+    if (m_size < sizeof(DivePlanFileHeader)) {
+        close();
+        return false;
+    }
+
+    m_data = reinterpret_cast<const char*>(m_file->map(0, m_size));
+    if (!m_data) {
+        close();
+        return false;
+    }
+
+    // Validate the header and the section table
+    DivePlanFileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    if (std::memcmp(header.m_magic, DIVE_PLAN_FILE_MAGIC, sizeof(header.m_magic)) != 0 ||
+        sizeof(DivePlanFileHeader) + (uint64_t) header.m_sectionCount * sizeof(DivePlanFileSection) > m_size) {
+        close();
+        return false;
+    }
+    m_version = header.m_version;
+
+    m_sections.resize(header.m_sectionCount);
+    std::memcpy(m_sections.data(), m_data + sizeof(DivePlanFileHeader), header.m_sectionCount * sizeof(DivePlanFileSection));
+    for (const auto& section : m_sections) {
+        if (section.m_offset > m_size || section.m_size > m_size - section.m_offset) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void DivePlanFileView::close() {
+    if (m_file) {
+        if (m_data) m_file->unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+        m_file->close();
+        delete m_file;
+    }
+    m_file = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+    m_version = 0;
+    m_sections.clear();
+}
+
+const char* DivePlanFileView::section(DivePlanSection id, size_t& size) const {
+    for (const auto& section : m_sections) {
+        if (section.m_id == static_cast<uint32_t>(id)) {
+            size = section.m_size;
+            return m_data + section.m_offset;
+        }
+    }
+    size = 0;
+    return nullptr;
+}
+
+} // namespace DiveComputer
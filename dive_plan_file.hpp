@@ -0,0 +1,215 @@
+#ifndef DIVE_PLAN_FILE_HPP
+#define DIVE_PLAN_FILE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <QFile>
+
+#include "dive_step.hpp"
+
+namespace DiveComputer {
+
+// .dive file format, version 2
+//
+// [DivePlanFileHeader][DivePlanFileSection x sectionCount][sections...]
+//
+// Every section starts on an 8-byte boundary. Profile sections are columnar:
+// [DivePlanFileColumnSet][DivePlanFileColumn x columnCount][columns...], each column
+// holding rowCount values (double or int32) contiguously. The profiles are copied from
+// the mapped file into DiveStep vectors, a section only when first needed. Unknown
+// sections and columns are ignored by readers; missing ones keep their default values.
+//
+// Version 1 files start with a uint32 version of 1 and are read by the legacy loader.
+
+constexpr char     DIVE_PLAN_FILE_MAGIC[8] = {'D', 'I', 'V', 'E', 'P', 'L', 'A', 'N'};
+constexpr uint32_t DIVE_PLAN_FILE_VERSION = 2;
+
+enum class DivePlanSection : uint32_t {
+    INPUTS = 1,        // what is needed to recalculate the plan
+    SUMMARY = 2,       // cached summary values and gas results
+    DIVE_PROFILE = 3,  // cached dive profile (columnar)
+    TIME_PROFILE = 4,  // cached time profile (columnar)
+};
+
+enum class DivePlanColumnType : uint32_t {
+    DOUBLE = 0,
+    INT32 = 1,
+};
+
+struct DivePlanFileHeader {
+    char     m_magic[8];
+    uint32_t m_version;
+    uint32_t m_sectionCount;
+};
+
+struct DivePlanFileSection {
+    uint32_t m_id;
+    uint32_t m_flags;
+    uint64_t m_offset;  // from the start of the file
+    uint64_t m_size;
+};
+
+struct DivePlanFileColumnSet {
+    uint64_t m_rowCount;
+    uint32_t m_columnCount;
+    uint32_t m_reserved;
+};
+
+struct DivePlanFileColumn {
+    uint32_t m_id;
+    uint32_t m_type;
+    uint64_t m_offset;  // from the start of the section
+};
+
+static_assert(sizeof(DivePlanFileHeader) == 16, "Unexpected header layout");
+static_assert(sizeof(DivePlanFileSection) == 24, "Unexpected section layout");
+static_assert(sizeof(DivePlanFileColumnSet) == 16, "Unexpected column set layout");
+static_assert(sizeof(DivePlanFileColumn) == 16, "Unexpected column layout");
+
+// Append-only byte buffer used to build a section before writing it in one go
+class ByteWriter {
+public:
+    template <typename T>
+    void write(const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+    }
+    void writeBytes(const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        m_data.insert(m_data.end(), bytes, bytes + size);
+    }
+    void align(size_t alignment = 8) {
+        while (m_data.size() % alignment != 0) m_data.push_back(0);
+    }
+    size_t size() const { return m_data.size(); }
+    char* data() { return m_data.data(); }
+    const std::vector<char>& buffer() const { return m_data; }
+
+private:
+    std::vector<char> m_data;
+};
+
+// Bounds-checked sequential reader over a section
+class ByteReader {
+public:
+    ByteReader(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (m_position + sizeof(T) > m_size) { m_failed = true; return false; }
+        std::memcpy(&value, m_data + m_position, sizeof(T));
+        m_position += sizeof(T);
+        return true;
+    }
+    bool failed() const { return m_failed; }
+    bool atEnd() const { return m_position >= m_size; }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_position{0};
+    bool m_failed{false};
+};
+
+// Decoded inputs and summary sections, available without building a DivePlan
+struct DivePlanFileGas {
+    double  m_o2Percent{0.0};
+    double  m_hePercent{0.0};
+    int32_t m_gasType{0};
+    int32_t m_gasStatus{0};
+    int32_t m_nbTanks{1};
+    double  m_tankCapacity{0.0};
+    double  m_fillingPressure{0.0};
+    double  m_reservePressure{0.0};
+
+    // Calculated values, from the summary section
+    double  m_switchDepth{0.0};
+    double  m_switchPpO2{0.0};
+    double  m_consumption{0.0};
+    double  m_endPressure{0.0};
+};
+
+struct DivePlanFileInputs {
+    int32_t m_mode{0};
+    bool    m_bailout{false};
+    bool    m_boosted{true};
+    int32_t m_diveNumber{0};
+    double  m_mission{0.0};
+    double  m_gf[2]{0.0, 0.0};
+    std::vector<std::pair<double, double>> m_stopSteps;  // depth, time
+    std::vector<std::pair<double, double>> m_setPoints;  // depth, setpoint
+    std::vector<DivePlanFileGas> m_gases;
+    std::vector<CompartmentPP> m_initialPressure;
+    int32_t m_waterType{0};              // WaterType
+    double  m_surfacePressure{1.01325};  // in bar, sea level (STP) when the file has no site
+    bool    m_waypoints{false};
+};
+
+struct DivePlanFileSummary {
+    double   m_firstDecoDepth{0.0};
+    double   m_tts{0.0};
+    double   m_ttsDelta{0.0};
+    double   m_ap{0.0};
+    double   m_maxTime{0.0};
+    double   m_maxTTS{0.0};
+    double   m_tp{0.0};
+    double   m_turnTts{0.0};
+    double   m_maxDepth{0.0};
+    double   m_runTime{0.0};
+    int64_t  m_savedAt{0};
+    uint64_t m_inputsChecksum{0};
+    uint64_t m_parametersChecksum{0};    // Parameters::checksum() of the results, 0 if unknown
+};
+
+// Section decoding; false if the section is truncated. The summary also fills in the
+// calculated values of the gases, which must have been read from the inputs first.
+bool readInputsSection(const char* data, size_t size, DivePlanFileInputs& inputs);
+bool readSummarySection(const char* data, size_t size, DivePlanFileSummary& summary, std::vector<DivePlanFileGas>& gases);
+
+// Inputs and summary of a version 1 or 2 file, without reading its profiles
+bool readDivePlanFileSummary(const std::string& filePath, DivePlanFileInputs& inputs, DivePlanFileSummary& summary);
+
+// Read-only memory mapping of a .dive file with access to its sections
+class DivePlanFileView {
+public:
+    DivePlanFileView() = default;
+    ~DivePlanFileView();
+    DivePlanFileView(const DivePlanFileView&) = delete;
+    DivePlanFileView& operator=(const DivePlanFileView&) = delete;
+
+    bool open(const std::string& filePath);
+    void close();
+
+    bool isValid() const { return m_data != nullptr; }
+    uint32_t version() const { return m_version; }
+
+    // Section bytes, or nullptr if the section is absent
+    const char* section(DivePlanSection id, size_t& size) const;
+
+    // True if the file starts with the version 2 magic
+    static bool hasMagic(const std::string& filePath);
+
+private:
+    QFile* m_file{nullptr};
+    const char* m_data{nullptr};
+    size_t m_size{0};
+    uint32_t m_version{0};
+    std::vector<DivePlanFileSection> m_sections;
+};
+
+// Columnar (de)serialisation of a profile
+void writeProfileSection(ByteWriter& writer, const std::vector<DiveStep>& profile);
+bool readProfileSection(const char* section, size_t sectionSize, std::vector<DiveStep>& profile);
+
+// FNV-1a hash, used to tie the cached results to the inputs they were calculated from
+uint64_t checksumBytes(const char* data, size_t size);
+
+// Assemble the header, section table and sections, and write the file through a temporary
+// file, so that views still mapping the previous version stay valid
+bool writeDivePlanFile(const std::string& filePath, const std::vector<std::pair<DivePlanSection, const ByteWriter*>>& sections);
+
+} // namespace DiveComputer
+
+#endif // DIVE_PLAN_FILE_HPP
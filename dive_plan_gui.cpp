@@ -4,6 +4,9 @@
 #include "dive_plan_dialog.hpp"
 #include "ui_utils.hpp"
 #include "dive_plan_gui_compartment_graph.hpp"
+#include "dive_plan_gui_saturation_map.hpp"
+#include "dive_plan_gui_gas_consumption.hpp"
+#include <chrono>
 
 namespace DiveComputer {
 
@@ -22,8 +25,8 @@ DivePlanWindow::DivePlanWindow(double depth, double bottomTime, diveMode mode, Q
     // Set window title
     setWindowTitle("Dive Plan");
     
-    // Create initial dive plan
-    m_divePlan = std::make_unique<DivePlan>(depth, bottomTime, mode, 1, compartmentPPinitialAir);
+    // Create initial dive plan, saturated at the atm. pressure of the parameters like its site
+    m_divePlan = std::make_unique<DivePlan>(depth, bottomTime, mode, 1, compartmentPPinitialAt(g_parameters.m_atmPressure));
     
     // Load setpoints from file
     if (!m_divePlan->m_setPoints.loadSetPointsFromFile()) {
@@ -33,9 +36,6 @@ DivePlanWindow::DivePlanWindow(double depth, double bottomTime, diveMode mode, Q
             m_divePlan->m_setPoints.saveSetPointsToFile();
         }
     }
-    
-    // Make sure the setpoints are sorted
-    m_divePlan->m_setPoints.sortSetPoints();
 
     // Calculate the dive plan
     m_divePlan->calculateDivePlan();
@@ -44,6 +44,7 @@ DivePlanWindow::DivePlanWindow(double depth, double bottomTime, diveMode mode, Q
     
     // Set up UI
     setupUI();
+    setupSpeculation();
 
     // Initial refresh of widgets
     refreshWindow();
@@ -86,6 +87,7 @@ DivePlanWindow::DivePlanWindow(std::unique_ptr<DivePlan> loadedPlan, QWidget *pa
     
     // Set up UI
     setupUI();
+    setupSpeculation();
 
     // Initial refresh of widgets
     refreshWindow();
@@ -110,7 +112,10 @@ DivePlanWindow::DivePlanWindow(std::unique_ptr<DivePlan> loadedPlan, QWidget *pa
     QTimer::singleShot(200, this, &DivePlanWindow::resizeGasesTable);
 }
 
-DivePlanWindow::~DivePlanWindow() {}
+DivePlanWindow::~DivePlanWindow() {
+    // No task of the window is left on the compute pool
+    ComputePool::instance().release(this);
+}
 
 void DivePlanWindow::refreshWindow(){
     refreshDivePlanTable();
@@ -118,6 +123,152 @@ void DivePlanWindow::refreshWindow(){
     refreshGasesTable();
     refreshSetpointsTable();
     refreshStopStepsTable();
+
+    // The graphs extract their data again only when the plan was calculated since
+    if (m_compartmentGraphWindow && m_compartmentGraphWindow->isVisible()) {
+        m_compartmentGraphWindow->refreshGraph();
+    }
+    if (m_saturationMapWindow && m_saturationMapWindow->isVisible()) {
+        m_saturationMapWindow->refreshMap();
+    }
+    if (m_gasConsumptionWindow && m_gasConsumptionWindow->isVisible()) {
+        m_gasConsumptionWindow->refreshGraph();
+    }
+
+    // Calculate the likely next edits once the window is idle
+    scheduleSpeculation();
+}
+
+void DivePlanWindow::calculateSummary() {
+    // The what-ifs left from the previous calculation are dropped with their futures
+    m_summaryWhatIfs = m_divePlan->startDiveSummary(this);
+    if (m_summaryWhatIfs.pending()) {
+        m_summaryTimer->start();
+    }
+}
+
+void DivePlanWindow::pollSummary() {
+    const bool wasPending[3] = {m_summaryWhatIfs.m_ttsDelta.valid(), m_summaryWhatIfs.m_maxResult.valid(),
+                                m_summaryWhatIfs.m_turnTts.valid()};
+    bool done = m_divePlan->collectDiveSummary(m_summaryWhatIfs, false);
+    if (done) {
+        m_summaryTimer->stop();
+    }
+
+    // Refresh when a metric completed
+    if (wasPending[0] != m_summaryWhatIfs.m_ttsDelta.valid() ||
+        wasPending[1] != m_summaryWhatIfs.m_maxResult.valid() ||
+        wasPending[2] != m_summaryWhatIfs.m_turnTts.valid()) {
+        refreshDiveSummaryTable();
+    }
+}
+
+void DivePlanWindow::finishSummary() {
+    // For what reads the whole summary, such as saving
+    if (m_summaryWhatIfs.pending()) {
+        m_divePlan->collectDiveSummary(m_summaryWhatIfs, true);
+        m_summaryTimer->stop();
+        refreshDiveSummaryTable();
+    }
+}
+
+void DivePlanWindow::setComputePriority(ComputePriority priority) {
+    ComputePool::instance().setPriority(this, priority);
+}
+
+void DivePlanWindow::stopBackgroundWork() {
+    // Returns once no task of the window reads the globals
+    m_speculationTimer->stop();
+    m_speculator->cancel();
+    m_summaryWhatIfs = SummaryWhatIfs();
+    m_summaryTimer->stop();
+    m_recalculation = std::future<std::shared_ptr<DivePlan>>();
+    m_recalculationTimer->stop();
+    ComputePool::instance().cancel(this);
+}
+
+void DivePlanWindow::recalculateInBackground(bool reloadGases) {
+    stopBackgroundWork();
+
+    // Calculated on a copy, the way an edit of the plan is, and the whole summary with it
+    auto plan = std::make_shared<DivePlan>(*m_divePlan);
+    if (reloadGases) {
+        plan->reloadAvailableGases();
+    }
+    m_recalculationKey = m_divePlan->inputsKey();
+    m_recalculation = ComputePool::instance().submit([plan]() {
+        plan->buildDivePlan();
+        plan->calculateDivePlan(false);
+        plan->calculateGasConsumption(false);
+        plan->calculateDiveSummary(false);
+        return plan;
+    }, this);
+    m_recalculationTimer->start();
+}
+
+void DivePlanWindow::pollRecalculation() {
+    if (!m_recalculation.valid() ||
+        m_recalculation.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    m_recalculationTimer->stop();
+    std::shared_ptr<DivePlan> plan = m_recalculation.get();
+
+    // Edited since, and calculated with the new parameters already
+    if (m_divePlan->inputsKey() != m_recalculationKey) {
+        return;
+    }
+    m_divePlan->adoptResults(*plan);
+    refreshWindow();
+}
+
+void DivePlanWindow::setupSpeculation() {
+    m_speculator = std::make_unique<PlanSpeculator>(m_resultCache);
+
+    // Polls the what-ifs of the summary until they all completed
+    m_summaryTimer = new QTimer(this);
+    m_summaryTimer->setInterval(SummaryPollMs);
+    connect(m_summaryTimer, &QTimer::timeout, this, &DivePlanWindow::pollSummary);
+
+    // Polls the plan calculated again in the background
+    m_recalculationTimer = new QTimer(this);
+    m_recalculationTimer->setInterval(SummaryPollMs);
+    connect(m_recalculationTimer, &QTimer::timeout, this, &DivePlanWindow::pollRecalculation);
+
+    // Restarted by every refresh, so a series of edits is not speculated on
+    m_speculationTimer = new QTimer(this);
+    m_speculationTimer->setSingleShot(true);
+    m_speculationTimer->setInterval(SpeculationDelayMs);
+    connect(m_speculationTimer, &QTimer::timeout, this, [this]() {
+        // Only complete plans go to the cache
+        if (m_summaryWhatIfs.pending()) {
+            m_speculationTimer->start();
+            return;
+        }
+        m_speculator->speculate(*m_divePlan);
+    });
+}
+
+void DivePlanWindow::scheduleSpeculation() {
+    if (m_speculationTimer) {
+        m_speculationTimer->start();
+    }
+}
+
+bool DivePlanWindow::adoptCachedPlan() {
+    // Stop the speculation first: the edit is known now
+    m_speculationTimer->stop();
+    m_speculator->cancel();
+
+    std::shared_ptr<const DivePlan> cached = m_resultCache.find(m_divePlan->inputsKey());
+    if (!cached) {
+        return false;
+    }
+    m_summaryWhatIfs = SummaryWhatIfs();
+    m_summaryTimer->stop();
+    m_divePlan->adoptResults(*cached);
+    logWrite("DivePlanWindow: plan taken from the result cache");
+    return true;
 }
 
 void DivePlanWindow::setupUI() {
@@ -294,11 +445,13 @@ void DivePlanWindow::setupUI() {
 }
 
 void DivePlanWindow::rebuildDivePlan() {
-    // PERFORM THE REBUILD
-    m_divePlan->buildDivePlan(); 
-    m_divePlan->calculateDivePlan();
-    m_divePlan->calculateGasConsumption();
-    m_divePlan->calculateDiveSummary();
+    // PERFORM THE REBUILD, unless the edit was calculated ahead
+    if (!adoptCachedPlan()) {
+        m_divePlan->buildDivePlan(); 
+        m_divePlan->calculateDivePlan();
+        m_divePlan->calculateGasConsumption();
+        calculateSummary();
+    }
     
     // Refresh the total window
     refreshWindow();
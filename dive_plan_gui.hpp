@@ -5,6 +5,8 @@
 #include "log_info.hpp"
 #include "qtheaders.hpp"
 #include "dive_plan.hpp"
+#include "plan_speculator.hpp"
+#include "compute_pool.hpp"
 #include "parameters.hpp"
 #include "enum.hpp"
 #include "global.hpp"
@@ -14,6 +16,8 @@
 namespace DiveComputer {
     class MainWindow; 
     class CompartmentGraphWindow;
+    class SaturationMapWindow;
+    class GasConsumptionWindow;
     }
 
 namespace DiveComputer {
@@ -32,16 +36,17 @@ enum DivePlanColumns {
     COL_HE_PERCENT = 9,
     COL_GF = 10,
     COL_GF_SURFACE = 11,
-    COL_SAC_RATE = 12,
-    COL_AMB_CONSUMPTION = 13,
-    COL_STEP_CONSUMPTION = 14,
-    COL_GAS_DENSITY = 15,
-    COL_END_WO_O2 = 16,
-    COL_END_W_O2 = 17,
-    COL_CNS_SINGLE = 18,
-    COL_CNS_MULTIPLE = 19,
-    COL_OTU = 20,
-    DIVE_PLAN_COLUMNS_COUNT = 21
+    COL_CONTROLLING = 12,
+    COL_SAC_RATE = 13,
+    COL_AMB_CONSUMPTION = 14,
+    COL_STEP_CONSUMPTION = 15,
+    COL_GAS_DENSITY = 16,
+    COL_END_WO_O2 = 17,
+    COL_END_W_O2 = 18,
+    COL_CNS_SINGLE = 19,
+    COL_CNS_MULTIPLE = 20,
+    COL_OTU = 21,
+    DIVE_PLAN_COLUMNS_COUNT = 22
 };
 
 enum StopStepColumns {
@@ -85,6 +90,11 @@ public:
     void setDivePlanningMenu(QMenu* menu);
     void activate();
 
+    // Work of the window on the compute pool
+    void setComputePriority(ComputePriority priority);
+    void stopBackgroundWork();
+    void recalculateInBackground(bool reloadGases);
+
 protected:
     void showEvent(QShowEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
@@ -93,6 +103,8 @@ protected:
 private:
     MainWindow* m_mainWindow;
     std::unique_ptr<CompartmentGraphWindow> m_compartmentGraphWindow;
+    std::unique_ptr<SaturationMapWindow> m_saturationMapWindow;
+    std::unique_ptr<GasConsumptionWindow> m_gasConsumptionWindow;
 
     // Window size
     const int preferredWidth = 1250;
@@ -101,6 +113,23 @@ private:
     // Data members
     std::unique_ptr<DivePlan> m_divePlan;
 
+    // Plans of the likely next edits, calculated while the window is idle
+    static constexpr size_t ResultCacheSize = 64;
+    static constexpr int SpeculationDelayMs = 300;
+    PlanResultCache m_resultCache{ResultCacheSize};
+    std::unique_ptr<PlanSpeculator> m_speculator;
+    QTimer* m_speculationTimer = nullptr;
+
+    // What-ifs of the summary running on the compute pool, shown as they complete
+    static constexpr int SummaryPollMs = 15;
+    SummaryWhatIfs m_summaryWhatIfs;
+    QTimer* m_summaryTimer = nullptr;
+
+    // Plan calculated again on the compute pool after a change of the parameters or gas list
+    std::future<std::shared_ptr<DivePlan>> m_recalculation;
+    std::string m_recalculationKey;    // inputs of the plan it was started on
+    QTimer* m_recalculationTimer = nullptr;
+
     // Splitter management
     enum class SplitterDirection {
         HORIZONTAL,
@@ -137,7 +166,11 @@ private:
     QAction* m_gfBoostedAction;
     QAction* m_maxTimeAction;
     QAction* m_optimiseDecoGasAction;
+    QAction* m_diveSiteAction;
+    QAction* m_waypointsAction;
     QAction* m_graphCompartmentsAction;
+    QAction* m_saturationMapAction;
+    QAction* m_gasConsumptionAction;
     QAction* m_planConsecutiveDiveAction;
     QAction* m_saveDiveAction;
 
@@ -208,6 +241,17 @@ private:
     void setupDivePlanTable();
     void rebuildDivePlan();
 
+    // Summary calculated concurrently
+    void calculateSummary();
+    void pollSummary();
+    void finishSummary();
+    void pollRecalculation();
+
+    // Speculative calculation of the next edits
+    void setupSpeculation();
+    void scheduleSpeculation();
+    bool adoptCachedPlan();
+
     void setupSetpointsTable();
     void updateSetpointVisibility();
     void setupStopStepsTable();
@@ -242,7 +286,11 @@ private slots:
     void gfBoostedActionTriggered();
     void setMaxTime();
     void optimiseDecoGas();
+    void editDiveSite();
+    void waypointsActionTriggered();
     void graphCompartments();
+    void showSaturationMap();
+    void showGasConsumption();
     void planConsecutiveDive();
     void saveDivePlan();
 
@@ -50,6 +50,7 @@ void CompartmentGraphWindow::setupUI(){
     for (int i = 1; i <= NUM_COMPARTMENTS; ++i) {
         m_compartmentSelector->addItem(QString::number(i), i - 1); // Store 0-indexed value
     }
+    m_compartmentSelector->addItem("All", ALL_COMPARTMENTS);
     connect(m_compartmentSelector, QOverload<int>::of(&QComboBox::currentIndexChanged), 
             this, &CompartmentGraphWindow::onCompartmentChanged);
     toolbarLayout->addWidget(m_compartmentSelector);
@@ -73,6 +74,9 @@ void CompartmentGraphWindow::setupUI(){
     m_graphWidget = new QCustomPlot(centralWidget);
     m_graphWidget->setInteraction(QCP::iRangeDrag, true);
     m_graphWidget->setInteraction(QCP::iRangeZoom, true);
+    connect(m_graphWidget->xAxis, QOverload<const QCPRange&>::of(&QCPAxis::rangeChanged),
+            this, &CompartmentGraphWindow::onRangeChanged);
+    connect(m_graphWidget, &QCustomPlot::mouseMove, this, &CompartmentGraphWindow::onMouseMove);
     
     // Setup graph
     setupGraph();
@@ -81,6 +85,20 @@ void CompartmentGraphWindow::setupUI(){
     mainLayout->addWidget(m_graphWidget, 1); // 1 = stretch factor
 }
 
+// Graphs 0 to 2 show the selected compartment, the ones after overlay all the compartments
+static constexpr int OVERLAY_GRAPH = 3;
+static constexpr int NUM_GRAPH_GAS_TYPES = 3;
+
+static int seriesIndex(GraphMode mode, GraphGasType gasType, int compartmentIndex) {
+    return (static_cast<int>(mode) * NUM_GRAPH_GAS_TYPES + static_cast<int>(gasType)) * NUM_COMPARTMENTS + compartmentIndex;
+}
+
+static QSharedPointer<QCPGraphDataContainer> makeContainer(const QVector<QCPGraphData>& data, bool sorted) {
+    auto container = QSharedPointer<QCPGraphDataContainer>::create();
+    container->set(data, sorted);
+    return container;
+}
+
 void CompartmentGraphWindow::setupGraph(){
     // Clear any existing graphs
     m_graphWidget->clearGraphs();
@@ -94,22 +112,13 @@ void CompartmentGraphWindow::setupGraph(){
     m_graphWidget->graph(0)->setPen(QPen(QColor(0, 114, 189), 2)); // Blue for actual pressure
     m_graphWidget->graph(1)->setPen(QPen(QColor(217, 83, 25), 2)); // Red for max adjusted pressure
     m_graphWidget->graph(2)->setPen(QPen(QColor(120, 120, 120), 1, Qt::DashLine)); // Gray dashed for reference
-    
-    // Get gas type name for labels
-    QString gasName = returnQStringGasType(m_graphGasType);
-    
-    // Set initial names
-    m_graphWidget->graph(0)->setName(QString("Actual %1 Pressure").arg(gasName));
-    m_graphWidget->graph(1)->setName(QString("Max GF Adjusted %1 Pressure").arg(gasName));
-    m_graphWidget->graph(2)->setName(QString("Ambient %1 Pressure").arg(gasName));
 
-    // Set axis labels for pressure mode
-    if (m_graphMode == GraphMode::PRESSURE) {
-        m_graphWidget->xAxis->setLabel("Ambient Pressure (bar)");
-        m_graphWidget->yAxis->setLabel(QString("%1 Pressure (bar)").arg(gasName));
-    } else {
-        m_graphWidget->xAxis->setLabel("Time (min)");
-        m_graphWidget->yAxis->setLabel("Pressure (bar)");
+    // One graph per compartment for the overlay, from red for the fastest to blue for the slowest
+    for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+        QCPGraph* graph = m_graphWidget->addGraph();
+        graph->setPen(QPen(QColor::fromHsv(240 * j / (NUM_COMPARTMENTS - 1), 220, 200), 1));
+        graph->setName(QString("Compartment %1").arg(j + 1));
+        graph->setVisible(false);
     }
     
     // Enable legend
@@ -120,59 +129,158 @@ void CompartmentGraphWindow::setupGraph(){
     m_graphWidget->axisRect()->setupFullAxesBox();
 }
 
-void CompartmentGraphWindow::updateGraph(int compartmentIndex) {
+void CompartmentGraphWindow::buildSeries() {
     // Log performance
     QElapsedTimer timer;
     timer.start();
 
-    // Get the appropriate profile
-    std::vector<DiveStep> profile = m_divePlan->m_diveProfile;
+    // Every graph mode, gas type and compartment in one pass over each profile
+    m_series.assign(2 * NUM_GRAPH_GAS_TYPES * NUM_COMPARTMENTS, CompartmentSeries());
+    std::shared_ptr<const std::vector<DiveStep>> timeProfile = m_divePlan->timeProfile();
+
+    for (GraphMode mode : {GraphMode::PRESSURE, GraphMode::TIME}) {
+        // Against pressure, skip the steps before the bottom stop, and against time the samples up to its start.
+        // A time sample is the state at its end.
+        const bool timeMode = (mode == GraphMode::TIME);
+        const std::vector<DiveStep>& profile = timeMode ? *timeProfile : m_divePlan->m_diveProfile;
+        int bottomStop = m_divePlan->bottomStopIndex();
+        double bottomTime = (bottomStop > 0) ? m_divePlan->m_diveProfile[bottomStop - 1].m_runTime : 0.0;
+
+        // Against time, the state of the plan is also taken between the adaptive samples, for
+        // level of detail pyramids of a few levels (see lod_levels.hpp)
+        double duration = profile.empty() ? 0.0 : profile.back().m_runTime - bottomTime;
+        double interval = lodDenseInterval(duration);
+        int capacity = static_cast<int>(profile.size()) + (timeMode ? static_cast<int>(duration / interval) : 0);
+
+        // Every gas type filled in one pass over the points
+        std::vector<QVector<QCPGraphData>> ambient(NUM_GRAPH_GAS_TYPES);
+        std::vector<QVector<QCPGraphData>> actual(NUM_GRAPH_GAS_TYPES * NUM_COMPARTMENTS);
+        std::vector<QVector<QCPGraphData>> maxAdjustedGF(NUM_GRAPH_GAS_TYPES * NUM_COMPARTMENTS);
+        for (auto& data : ambient) data.reserve(capacity);
+        for (auto& data : actual) data.reserve(capacity);
+        for (auto& data : maxAdjustedGF) data.reserve(capacity);
+
+        auto append = [&](const DiveStep& step) {
+            double pAmb = timeMode ? step.m_pAmbEndDepth : step.m_pAmbStartDepth;
+            double key = timeMode ? step.m_runTime : pAmb;
+            for (GraphGasType gasType : {GraphGasType::INERT, GraphGasType::N2, GraphGasType::HE}) {
+                int g = static_cast<int>(gasType);
+                ambient[g].append(QCPGraphData(key, getAmbientGasPressure(pAmb, step, gasType)));
+                for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+                    actual[g * NUM_COMPARTMENTS + j].append(QCPGraphData(key, getGasPressure(step.m_ppActual[j], gasType)));
+                    maxAdjustedGF[g * NUM_COMPARTMENTS + j].append(QCPGraphData(key, getGasPressure(step.m_ppMaxAdjustedGF[j], gasType)));
+                }
+            }
+        };
+
+        const DiveStep* previous = nullptr;
+        for (int i = timeMode ? 0 : bottomStop; i < (int) profile.size(); i++) {
+            const DiveStep& step = profile[i];
+            if (timeMode && step.m_runTime <= bottomTime) {
+                continue;
+            }
+            if (timeMode && previous) {
+                for (int k = 1; previous->m_runTime + k * interval < step.m_runTime - interval / 2; k++) {
+                    append(m_divePlan->getStateAtTime(previous->m_runTime + k * interval));
+                }
+            }
+            append(step);
+            previous = &step;
+        }
+
+        for (GraphGasType gasType : {GraphGasType::INERT, GraphGasType::N2, GraphGasType::HE}) {
+            int g = static_cast<int>(gasType);
+
+            // The samples against time are already in key order
+            PlotLod ambientLod(makeContainer(ambient[g], timeMode));
+            bool found = false;
+            QCPRange ambientRange = ambientLod.data()->valueRange(found);
+
+            for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+                CompartmentSeries& compartment = m_series[seriesIndex(mode, gasType, j)];
+                compartment.m_actual = PlotLod(makeContainer(actual[g * NUM_COMPARTMENTS + j], timeMode));
+                compartment.m_maxAdjustedGF = PlotLod(makeContainer(maxAdjustedGF[g * NUM_COMPARTMENTS + j], timeMode));
+                compartment.m_ambient = ambientLod;
+
+                compartment.m_keyRange = compartment.m_actual.data()->keyRange(found);
+                compartment.m_overlayValueRange = compartment.m_actual.data()->valueRange(found);
+                compartment.m_overlayValueRange.expand(ambientRange);
+                compartment.m_valueRange = compartment.m_overlayValueRange;
+                compartment.m_valueRange.expand(compartment.m_maxAdjustedGF.data()->valueRange(found));
+            }
+        }
+    }
+
+    m_seriesRevision = m_divePlan->revision();
+    m_seriesEpoch = g_parameters.epoch();
+    m_seriesValid = true;
+
+    // Monitor performance
+    logWrite("CompartmentGraphWindow::buildSeries() took ", timer.elapsed(), " ms");
+}
+
+const CompartmentSeries& CompartmentGraphWindow::series(GraphMode mode, GraphGasType gasType, int compartmentIndex) const {
+    return m_series[seriesIndex(mode, gasType, compartmentIndex)];
+}
+
+int CompartmentGraphWindow::selectedCompartment() const {
+    return m_compartmentSelector->itemData(m_compartmentSelector->currentIndex()).toInt();
+}
+
+void CompartmentGraphWindow::refreshGraph() {
+    updateGraph(selectedCompartment());
+}
+
+void CompartmentGraphWindow::updateGraph(int compartmentIndex) {
+    // Log performance
+    QElapsedTimer timer;
+    timer.start();
 
     // Ensure we have valid data to display
-    if (profile.empty()) {
+    if (m_divePlan->m_diveProfile.empty()) {
         return;
     }
-    
-    // IMPORTANT: Clear existing data COMPLETELY
-    for (int i = 0; i < m_graphWidget->graphCount(); ++i) {
-        m_graphWidget->graph(i)->data()->clear();
+
+    // Extract the series again only when the plan was calculated or the parameters changed since
+    if (!m_seriesValid || m_seriesRevision != m_divePlan->revision() || m_seriesEpoch != g_parameters.epoch()) {
+        buildSeries();
     }
 
     // Get gas type name for labels
     QString gasName = returnQStringGasType(m_graphGasType);
-    
-    // Initialize with extreme values for finding min/max
-    double x_min = std::numeric_limits<double>::max();
-    double x_max = std::numeric_limits<double>::lowest();
-    double y_min = std::numeric_limits<double>::max();
-    double y_max = std::numeric_limits<double>::lowest();
-
-    // Process and add data points. 
-    // skip the first 3 stepsto get to max depth
-    for (int i = 3; i < (int) profile.size(); i++){
-        DiveStep step = profile[i];
- 
-        // Decide the x axis based on mode and populate the y values
-        double x_value = (m_graphMode == GraphMode::PRESSURE) ? step.m_pAmbStartDepth : step.m_runTime;
-        double y1_value = getGasPressure(step.m_ppActual[compartmentIndex]);
-        double y2_value = getGasPressure(step.m_ppMaxAdjustedGF[compartmentIndex]);
-        double y3_value = getAmbientGasPressure(step.m_pAmbStartDepth, step);
-            
-        // Update the 3 graphs
-        m_graphWidget->graph(0)->addData(x_value, y1_value);
-        m_graphWidget->graph(1)->addData(x_value, y2_value);
-        m_graphWidget->graph(2)->addData(x_value, y3_value);
-
-        // update maximums and minimums for scaling
-        x_min = std::min(x_min, x_value);
-        x_max = std::max(x_max, x_value);
-        y_min = std::min(y_min, std::min(y1_value, std::min(y2_value, y3_value)));
-        y_max = std::max(y_max, std::max(y1_value, std::max(y2_value, y3_value)));
+    const bool overlay = (compartmentIndex == ALL_COMPARTMENTS);
+
+    // The graphs share the cached series of the selection
+    const CompartmentSeries& selected = series(m_graphMode, m_graphGasType, overlay ? 0 : compartmentIndex);
+    QCPRange keyRange = selected.m_keyRange;
+    QCPRange valueRange = overlay ? selected.m_overlayValueRange : selected.m_valueRange;
+
+    m_graphWidget->graph(0)->setVisible(!overlay);
+    m_graphWidget->graph(1)->setVisible(!overlay);
+    for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+        m_graphWidget->graph(OVERLAY_GRAPH + j)->setVisible(overlay);
+        if (overlay) {
+            valueRange.expand(series(m_graphMode, m_graphGasType, j).m_overlayValueRange);
+        }
     }
 
-    // Set the range
-    m_graphWidget->xAxis->setRange(x_min, x_max);
-    m_graphWidget->yAxis->setRange(y_min, y_max);
+    // Legend of the visible graphs, in graph order
+    m_graphWidget->legend->clearItems();
+    for (int i = 0; i < m_graphWidget->graphCount(); i++) {
+        if (m_graphWidget->graph(i)->visible()) {
+            m_graphWidget->graph(i)->addToLegend();
+        }
+    }
+
+    // Names follow the gas type
+    m_graphWidget->graph(0)->setName(QString("Actual %1 Pressure").arg(gasName));
+    m_graphWidget->graph(1)->setName(QString("Max GF Adjusted %1 Pressure").arg(gasName));
+    m_graphWidget->graph(2)->setName(QString("Ambient %1 Pressure").arg(gasName));
+
+    // Set the range and hand the graphs their level of detail for it
+    m_graphWidget->yAxis->setRange(valueRange);
+    m_graphWidget->xAxis->setRange(keyRange);
+    applyLevels();
     
     // Update axis labels
     QString x_label = (m_graphMode == GraphMode::PRESSURE) ? "Ambient Pressure (bar)" : "Runtime (min)";
@@ -186,11 +294,79 @@ void CompartmentGraphWindow::updateGraph(int compartmentIndex) {
     logWrite("CompartmentGraphWindow::updateGraph() took ", timer.elapsed(), " ms");
 }
 
+void CompartmentGraphWindow::applyLevels() {
+    // Each visible graph gets the level of its series matching the pixel width of the visible range
+    if (!m_seriesValid) {
+        return;
+    }
+
+    int compartmentIndex = selectedCompartment();
+    const bool overlay = (compartmentIndex == ALL_COMPARTMENTS);
+    const CompartmentSeries& selected = series(m_graphMode, m_graphGasType, overlay ? 0 : compartmentIndex);
+    QCPRange range = m_graphWidget->xAxis->range();
+    int pixelWidth = std::max(1, m_graphWidget->axisRect()->width());
+
+    if (!overlay) {
+        m_graphWidget->graph(0)->setData(selected.m_actual.levelFor(range, pixelWidth));
+        m_graphWidget->graph(1)->setData(selected.m_maxAdjustedGF.levelFor(range, pixelWidth));
+    } else {
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            m_graphWidget->graph(OVERLAY_GRAPH + j)->setData(series(m_graphMode, m_graphGasType, j).m_actual.levelFor(range, pixelWidth));
+        }
+    }
+    m_graphWidget->graph(2)->setData(selected.m_ambient.levelFor(range, pixelWidth));
+}
+
+void CompartmentGraphWindow::onRangeChanged(const QCPRange& range){
+    // Dragged or zoomed: the plot is redrawn after this, with the level of the new range
+    Q_UNUSED(range);
+    applyLevels();
+}
+
+void CompartmentGraphWindow::onMouseMove(QMouseEvent* event){
+    // Against time, the state of the plan at the run time under the cursor
+    double runTime = m_graphWidget->xAxis->pixelToCoord(event->pos().x());
+    int compartmentIndex = selectedCompartment();
+    const bool overlay = (compartmentIndex == ALL_COMPARTMENTS);
+    if (m_graphMode != GraphMode::TIME || !m_seriesValid ||
+        !series(m_graphMode, m_graphGasType, overlay ? 0 : compartmentIndex).m_keyRange.contains(runTime)) {
+        statusBar()->clearMessage();
+        return;
+    }
+
+    DiveStep state = m_divePlan->getStateAtTime(runTime);
+    QString gasName = returnQStringGasType(m_graphGasType);
+    QString message = QString("Runtime %1 min, depth %2 m, ambient %3 %4 bar")
+        .arg(runTime, 0, 'f', 1)
+        .arg(state.m_endDepth, 0, 'f', 1)
+        .arg(gasName)
+        .arg(getAmbientGasPressure(state.m_pAmbEndDepth, state, m_graphGasType), 0, 'f', 3);
+
+    if (overlay) {
+        // The most loaded compartment
+        int highest = 0;
+        for (int j = 1; j < NUM_COMPARTMENTS; j++) {
+            if (getGasPressure(state.m_ppActual[j], m_graphGasType) > getGasPressure(state.m_ppActual[highest], m_graphGasType)) {
+                highest = j;
+            }
+        }
+        message += QString(", highest compartment %1 at %2 bar")
+            .arg(highest + 1)
+            .arg(getGasPressure(state.m_ppActual[highest], m_graphGasType), 0, 'f', 3);
+    } else {
+        message += QString(", actual %1 bar, max GF adjusted %2 bar")
+            .arg(getGasPressure(state.m_ppActual[compartmentIndex], m_graphGasType), 0, 'f', 3)
+            .arg(getGasPressure(state.m_ppMaxAdjustedGF[compartmentIndex], m_graphGasType), 0, 'f', 3);
+    }
+    statusBar()->showMessage(message);
+}
+
 void CompartmentGraphWindow::resizeEvent(QResizeEvent* event){
     QMainWindow::resizeEvent(event);
     
     // Force a replot when the window is resized
     if (m_graphWidget) {
+        applyLevels();
         m_graphWidget->replot();
     }
 }
@@ -200,13 +376,7 @@ void CompartmentGraphWindow::onGasTypeChanged(int index){
     m_graphGasType = static_cast<GraphGasType>(m_graphGasTypeSelector->itemData(index).toInt());
     
     // Update the graph with the current compartment but new gas type
-    int compartmentIndex = m_compartmentSelector->itemData(m_compartmentSelector->currentIndex()).toInt();
-    
-    // Reset the graph setup with new labels
-    setupGraph();
-    
-    // Update the graph with new data
-    updateGraph(compartmentIndex);
+    updateGraph(selectedCompartment());
 }
 
 void CompartmentGraphWindow::onCompartmentChanged(int index){
@@ -221,16 +391,12 @@ void CompartmentGraphWindow::onGraphModeChanged(int index){
     // Get the graph mode from the item data
     m_graphMode = static_cast<GraphMode>(m_graphModeSelector->itemData(index).toInt());
     
-    // Reset the graph setup with new labels
-    setupGraph();
-    
     // Update the graph with the current compartment but new mode
-    int compartmentIndex = m_compartmentSelector->itemData(m_compartmentSelector->currentIndex()).toInt();
-    updateGraph(compartmentIndex);
+    updateGraph(selectedCompartment());
 }
 
-double CompartmentGraphWindow::getGasPressure(const CompartmentPP& pp) const {
-    switch (m_graphGasType) {
+double CompartmentGraphWindow::getGasPressure(const CompartmentPP& pp, GraphGasType gasType) {
+    switch (gasType) {
         case GraphGasType::N2:
             return pp.m_pN2;
         case GraphGasType::HE:
@@ -241,8 +407,8 @@ double CompartmentGraphWindow::getGasPressure(const CompartmentPP& pp) const {
     }
 }
 
-double CompartmentGraphWindow::getAmbientGasPressure(double pressure, const DiveStep& step) const {
-    switch (m_graphGasType) {
+double CompartmentGraphWindow::getAmbientGasPressure(double pressure, const DiveStep& step, GraphGasType gasType) {
+    switch (gasType) {
         case GraphGasType::N2:
             return pressure * step.m_n2Percent / 100.0;
         case GraphGasType::HE:
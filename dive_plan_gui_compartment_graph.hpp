@@ -8,6 +8,7 @@
 #include "constants.hpp"
 #include "ui_utils.hpp"
 #include "qcustomplot.hpp"
+#include "plot_lod.hpp"
 
 namespace DiveComputer {
 
@@ -24,6 +25,19 @@ enum class GraphGasType {
     HE
 };
 
+// Compartment selector entry overlaying the actual pressures of all the compartments
+constexpr int ALL_COMPARTMENTS = -1;
+
+// Series of one compartment for one graph mode and gas type, shared with the graphs showing them
+struct CompartmentSeries {
+    PlotLod m_actual;
+    PlotLod m_maxAdjustedGF;
+    PlotLod m_ambient;    // the same for all the compartments
+    QCPRange m_keyRange;
+    QCPRange m_valueRange;           // of the three series
+    QCPRange m_overlayValueRange;    // without the max adjusted pressure
+};
+
 class CompartmentGraphWindow : public QMainWindow {
     Q_OBJECT
     
@@ -31,6 +45,9 @@ public:
     CompartmentGraphWindow(const DivePlan* divePlan, QWidget *parent = nullptr);
     ~CompartmentGraphWindow() override = default;
 
+    // Redraw when the plan was calculated again since the series were extracted
+    void refreshGraph();
+
 protected:
     void resizeEvent(QResizeEvent* event) override;
     
@@ -47,6 +64,13 @@ private:
     // Current graph mode and gas type
     GraphMode m_graphMode = GraphMode::PRESSURE;
     GraphGasType m_graphGasType = GraphGasType::INERT;
+
+    // Series of every mode, gas type and compartment, extracted once per plan revision
+    // and parameters epoch
+    std::vector<CompartmentSeries> m_series;
+    uint64_t m_seriesRevision = 0;
+    uint64_t m_seriesEpoch = 0;
+    bool m_seriesValid = false;
     
     // Styling constants
     static constexpr int WindowWidth = 800;
@@ -56,16 +80,22 @@ private:
     void setupUI();
     void setupGraph();
     void updateGraph(int compartmentIndex);
+    void buildSeries();
+    void applyLevels();
+    const CompartmentSeries& series(GraphMode mode, GraphGasType gasType, int compartmentIndex) const;
+    int  selectedCompartment() const;
     
     // Helper function to get current gas pressure
-    double getGasPressure(const CompartmentPP& pp) const;
-    double getAmbientGasPressure(double pressure, const DiveStep& step) const;
+    static double getGasPressure(const CompartmentPP& pp, GraphGasType gasType);
+    static double getAmbientGasPressure(double pressure, const DiveStep& step, GraphGasType gasType);
     QString returnQStringGasType(GraphGasType type);
 
 private slots:
     void onCompartmentChanged(int index);
     void onGraphModeChanged(int index);
     void onGasTypeChanged(int index);
+    void onRangeChanged(const QCPRange& range);
+    void onMouseMove(QMouseEvent* event);
 };
 
 } // namespace DiveComputer
@@ -0,0 +1,99 @@
+#include "dive_plan_gui_gas_consumption.hpp"
+
+namespace DiveComputer {
+
+GasConsumptionWindow::GasConsumptionWindow(const DivePlan* divePlan, QWidget *parent)
+    : QMainWindow(parent),
+      m_divePlan(divePlan){
+    // Set window title with dive number
+    setWindowTitle(QString("Gas consumption for dive %1").arg(m_divePlan->m_diveNumber));
+
+    // Configure window size and position
+    setWindowSizeAndPosition(this, WindowWidth, WindowHeight, WindowPosition::CENTER);
+
+    // Setup UI components
+    setupUI();
+
+    // Draw the consumption of the plan
+    updateGraph();
+}
+
+void GasConsumptionWindow::refreshGraph() {
+    updateGraph();
+}
+
+void GasConsumptionWindow::setupUI(){
+    // Create central widget
+    QWidget* centralWidget = new QWidget(this);
+    setCentralWidget(centralWidget);
+
+    // Create main layout
+    QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
+
+    // Create graph widget
+    m_graphWidget = new QCustomPlot(centralWidget);
+    m_graphWidget->setInteraction(QCP::iRangeDrag, true);
+    m_graphWidget->setInteraction(QCP::iRangeZoom, true);
+
+    m_graphWidget->xAxis->setLabel("Runtime (min)");
+    m_graphWidget->yAxis->setLabel("Gas used (L)");
+    m_graphWidget->legend->setVisible(true);
+    m_graphWidget->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignTop|Qt::AlignLeft);
+
+    // Add graph to main layout
+    mainLayout->addWidget(m_graphWidget, 1); // 1 = stretch factor
+}
+
+void GasConsumptionWindow::updateGraph(){
+    // Log performance
+    QElapsedTimer timer;
+    timer.start();
+
+    // Nothing to draw again when the plan was not calculated and the parameters not changed since
+    if (m_graphValid && m_graphRevision == m_divePlan->revision() && m_graphEpoch == g_parameters.epoch()) {
+        return;
+    }
+
+    std::shared_ptr<const std::vector<DiveStep>> timeProfile = m_divePlan->timeProfile();
+    const std::vector<DiveStep>& samples = *timeProfile;
+    m_graphRevision = m_divePlan->revision();
+    m_graphEpoch = g_parameters.epoch();
+    m_graphValid = true;
+
+    // One curve per gas, the gases may have changed since the last draw
+    m_graphWidget->clearGraphs();
+    if (samples.empty()) {
+        m_graphWidget->replot();
+        return;
+    }
+
+    const QColor colors[] = {QColor(0, 0, 255), QColor(255, 0, 0), QColor(0, 128, 0),
+                             QColor(255, 128, 0), QColor(128, 0, 128), QColor(0, 128, 128)};
+    const int nbColors = sizeof(colors) / sizeof(colors[0]);
+
+    double maxConsumption = 0.0;
+    for (int i = 0; i < static_cast<int>(m_divePlan->m_gasAvailable.size()); i++) {
+        std::vector<double> series = DivePlan::getGasConsumptionSeries(samples, i);
+
+        QVector<QCPGraphData> data(static_cast<int>(samples.size()));
+        for (size_t s = 0; s < samples.size(); s++) {
+            data[static_cast<int>(s)] = QCPGraphData(samples[s].m_runTime, series[s]);
+        }
+        maxConsumption = std::max(maxConsumption, series.back());
+
+        const Gas& gas = m_divePlan->m_gasAvailable[i].m_gas;
+        QCPGraph* graph = m_graphWidget->addGraph();
+        graph->setPen(QPen(colors[i % nbColors], 2));
+        graph->setName(QString("%1/%2").arg(gas.m_o2Percent, 0, 'f', 0).arg(gas.m_hePercent, 0, 'f', 0));
+        graph->data()->set(data, true);
+    }
+
+    m_graphWidget->xAxis->setRange(samples.front().m_runTime, samples.back().m_runTime);
+    m_graphWidget->yAxis->setRange(0.0, std::max(1.0, maxConsumption * 1.05));
+    m_graphWidget->replot();
+
+    // Monitor performance
+    logWrite("GasConsumptionWindow::updateGraph() took ", timer.elapsed(), " ms");
+}
+
+} // namespace DiveComputer
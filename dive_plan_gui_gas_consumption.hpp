@@ -0,0 +1,46 @@
+#ifndef DIVE_PLAN_GUI_GAS_CONSUMPTION_HPP
+#define DIVE_PLAN_GUI_GAS_CONSUMPTION_HPP
+
+#include "log_info.hpp"
+#include "qtheaders.hpp"
+#include "dive_plan.hpp"
+#include "ui_utils.hpp"
+#include "qcustomplot.hpp"
+
+namespace DiveComputer {
+
+// Cumulative consumption of each gas of the plan over the run time
+class GasConsumptionWindow : public QMainWindow {
+    Q_OBJECT
+
+public:
+    GasConsumptionWindow(const DivePlan* divePlan, QWidget *parent = nullptr);
+    ~GasConsumptionWindow() override = default;
+
+    // Redraw when the plan was calculated again since the graph was drawn
+    void refreshGraph();
+
+private:
+    // Reference to the dive plan
+    const DivePlan* m_divePlan;
+
+    // UI Elements
+    QCustomPlot* m_graphWidget;
+
+    // Plan revision and parameters epoch drawn
+    uint64_t m_graphRevision = 0;
+    uint64_t m_graphEpoch = 0;
+    bool m_graphValid = false;
+
+    // Styling constants
+    static constexpr int WindowWidth = 800;
+    static constexpr int WindowHeight = 500;
+
+    // Setup methods
+    void setupUI();
+    void updateGraph();
+};
+
+} // namespace DiveComputer
+
+#endif // DIVE_PLAN_GUI_GAS_CONSUMPTION_HPP
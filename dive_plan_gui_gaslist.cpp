@@ -374,11 +374,14 @@ void DivePlanWindow::gasTableCellChanged(int row, int column) {
                     column == GAS_COL_FILLING_PRESSURE ||
                     column == GAS_COL_RESERVE_PRESSURE) {
 
-                    // Recalculate and refresh
-                    m_divePlan->calculateGasConsumption();
-                    m_divePlan->calculateDiveSummary();
+                    // Recalculate and refresh, unless the edit was calculated ahead
+                    if (!adoptCachedPlan()) {
+                        m_divePlan->calculateGasConsumption();
+                        calculateSummary();
+                    }
                     refreshGasesTable();
                     refreshDiveSummaryTable();
+                    scheduleSpeculation();
                 }
             }
         } else {
@@ -1,9 +1,27 @@
 #include "dive_plan_gui.hpp"
 #include "main_gui.hpp"
 #include "dive_plan_gui_compartment_graph.hpp"
+#include "dive_plan_gui_saturation_map.hpp"
+#include "dive_plan_gui_gas_consumption.hpp"
 
 namespace DiveComputer {
 
+namespace {
+
+// Standard atmosphere, for the surface pressure at an altitude
+constexpr double ALTITUDE_LAPSE = 2.25577e-5;    // per m
+constexpr double ALTITUDE_EXPONENT = 5.25588;
+
+double pressureAtAltitude(double altitude) {
+    return g_constants.m_atmPressureStp * std::pow(1.0 - ALTITUDE_LAPSE * altitude, ALTITUDE_EXPONENT);
+}
+
+double altitudeOfPressure(double pressure) {
+    return (1.0 - std::pow(pressure / g_constants.m_atmPressureStp, 1.0 / ALTITUDE_EXPONENT)) / ALTITUDE_LAPSE;
+}
+
+} // namespace
+
 void DivePlanWindow::setupMenu() {
     // Clear any existing actions
     m_divePlanningMenu->clear();
@@ -53,6 +71,19 @@ void DivePlanWindow::setupMenu() {
     connect(m_optimiseDecoGasAction, &QAction::triggered, this, &DivePlanWindow::optimiseDecoGas);
     m_divePlanningMenu->addAction(m_optimiseDecoGasAction);
 
+    // Water and surface pressure of the site
+    m_diveSiteAction = new QAction("Dive site...", this);
+    m_diveSiteAction->setVisible(true);
+    connect(m_diveSiteAction, &QAction::triggered, this, &DivePlanWindow::editDiveSite);
+    m_divePlanningMenu->addAction(m_diveSiteAction);
+
+    // Stop steps dived in their order, for saw-tooth profiles
+    m_waypointsAction = new QAction("Waypoint profile", this);
+    m_waypointsAction->setCheckable(true);
+    m_waypointsAction->setChecked(m_divePlan->m_waypoints);
+    connect(m_waypointsAction, &QAction::triggered, this, &DivePlanWindow::waypointsActionTriggered);
+    m_divePlanningMenu->addAction(m_waypointsAction);
+
     // Add additional actions
     m_divePlanningMenu->addSeparator();
     
@@ -74,6 +105,18 @@ void DivePlanWindow::setupMenu() {
     m_graphCompartmentsAction->setVisible(true);
     connect(m_graphCompartmentsAction, &QAction::triggered, this, &DivePlanWindow::graphCompartments);
     m_divePlanningMenu->addAction(m_graphCompartmentsAction);
+
+    // Saturation heat map
+    m_saturationMapAction = new QAction("Saturation heat map", this);
+    m_saturationMapAction->setVisible(true);
+    connect(m_saturationMapAction, &QAction::triggered, this, &DivePlanWindow::showSaturationMap);
+    m_divePlanningMenu->addAction(m_saturationMapAction);
+
+    // Gas consumption graph
+    m_gasConsumptionAction = new QAction("Gas consumption graph", this);
+    m_gasConsumptionAction->setVisible(true);
+    connect(m_gasConsumptionAction, &QAction::triggered, this, &DivePlanWindow::showGasConsumption);
+    m_divePlanningMenu->addAction(m_gasConsumptionAction);
 }
 
 void DivePlanWindow::setDivePlanningMenu(QMenu* menu) {
@@ -102,6 +145,8 @@ void DivePlanWindow::updateMenuState() {
     m_ccModeAction->setChecked(m_divePlan->m_mode == diveMode::CC);
     m_ocModeAction->setChecked(m_divePlan->m_mode == diveMode::OC);
     
+    m_waypointsAction->setChecked(m_divePlan->m_waypoints);
+
     // Update visibility and checked state of CC-specific actions
     bool inCCMode = (m_divePlan->m_mode == diveMode::CC);
     
@@ -133,7 +178,7 @@ void DivePlanWindow::ccModeActivated() {
     // Refresh the dive plan
     m_divePlan->calculateDivePlan();
     m_divePlan->calculateGasConsumption();
-    m_divePlan->calculateDiveSummary();
+    calculateSummary();
     refreshWindow();
 }
 
@@ -150,7 +195,7 @@ void DivePlanWindow::ocModeActivated() {
     // Refresh the dive plan
     m_divePlan->calculateDivePlan();
     m_divePlan->calculateGasConsumption();
-    m_divePlan->calculateDiveSummary();
+    calculateSummary();
     refreshWindow();
 }
 
@@ -161,7 +206,7 @@ void DivePlanWindow::bailoutActionTriggered() {
     // Refresh the dive plan
     m_divePlan->calculateDivePlan();
     m_divePlan->calculateGasConsumption();
-    m_divePlan->calculateDiveSummary();
+    calculateSummary();
     refreshWindow();
 }
 
@@ -172,21 +217,22 @@ void DivePlanWindow::gfBoostedActionTriggered() {
     // Refresh the dive plan
     m_divePlan->calculateDivePlan();
     m_divePlan->calculateGasConsumption();
-    m_divePlan->calculateDiveSummary();
+    calculateSummary();
     refreshWindow();
 }
 
+void DivePlanWindow::waypointsActionTriggered() {
+    // The stop steps keep the order they are shown in, or are sorted deepest first
+    m_divePlan->m_waypoints = m_waypointsAction->isChecked();
+    rebuildDivePlan();
+}
+
 void DivePlanWindow::setMaxTime() {
     std::pair<double, double> result = m_divePlan->getMaxTimeAndTTS();
 
-    // find the first stop step
-    int firstStopIndex = 0;
-    for (int i = 1; i < m_divePlan->nbOfSteps(); i++) {
-        if (m_divePlan->m_diveProfile[i].m_phase == Phase::STOP) {
-            firstStopIndex = i;
-            break;
-        }
-    }
+    // find the stop ending the bottom time, a plan without one has no time to set
+    int firstStopIndex = m_divePlan->bottomStopIndex();
+    if (firstStopIndex == 0) return;
     m_divePlan->m_diveProfile[firstStopIndex].m_time = result.first;
     
     // Update the Stop Steps table
@@ -199,7 +245,7 @@ void DivePlanWindow::setMaxTime() {
     // Refresh the dive plan
     m_divePlan->calculateDivePlan();
     m_divePlan->calculateGasConsumption();
-    m_divePlan->calculateDiveSummary();
+    calculateSummary();
     refreshWindow();
 }
 
@@ -207,9 +253,70 @@ void DivePlanWindow::optimiseDecoGas() { // PLACEHOLDER
     m_divePlan->optimiseDecoGas();
 }
 
+void DivePlanWindow::editDiveSite() {
+    const DiveSite& current = m_divePlan->m_site;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Dive Site");
+    QVBoxLayout* mainLayout = new QVBoxLayout(&dialog);
+    QFormLayout* formLayout = new QFormLayout();
+
+    QComboBox* waterCombo = new QComboBox(&dialog);
+    waterCombo->addItem("Salt water", static_cast<int>(WaterType::SALT));
+    waterCombo->addItem("Fresh water", static_cast<int>(WaterType::FRESH));
+    waterCombo->setCurrentIndex(waterCombo->findData(static_cast<int>(current.m_waterType)));
+    formLayout->addRow("Water:", waterCombo);
+
+    // The altitude fills in the surface pressure, which can then be set from a barometer
+    QSpinBox* altitudeSpinBox = new QSpinBox(&dialog);
+    altitudeSpinBox->setRange(0, 5000);
+    altitudeSpinBox->setSingleStep(100);
+    altitudeSpinBox->setSuffix(" m");
+    altitudeSpinBox->setValue(static_cast<int>(std::round(std::max(0.0, altitudeOfPressure(current.m_surfacePressure)))));
+    formLayout->addRow("Altitude:", altitudeSpinBox);
+
+    QDoubleSpinBox* pressureSpinBox = new QDoubleSpinBox(&dialog);
+    pressureSpinBox->setRange(0.5, 1.1);
+    pressureSpinBox->setDecimals(3);
+    pressureSpinBox->setSingleStep(0.01);
+    pressureSpinBox->setSuffix(" bar");
+    pressureSpinBox->setValue(current.m_surfacePressure);
+    formLayout->addRow("Surface pressure:", pressureSpinBox);
+
+    connect(altitudeSpinBox, qOverload<int>(&QSpinBox::valueChanged), pressureSpinBox, [pressureSpinBox](int altitude) {
+        pressureSpinBox->setValue(pressureAtAltitude(altitude));
+    });
+    mainLayout->addLayout(formLayout);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    QPushButton* okButton = new QPushButton("OK", &dialog);
+    QPushButton* cancelButton = new QPushButton("Cancel", &dialog);
+    connect(okButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+    connect(cancelButton, &QPushButton::clicked, &dialog, &QDialog::reject);
+    buttonLayout->addWidget(okButton);
+    buttonLayout->addWidget(cancelButton);
+    mainLayout->addLayout(buttonLayout);
+
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    DiveSite site(static_cast<WaterType>(waterCombo->currentData().toInt()), pressureSpinBox->value());
+    if (site == current) {
+        return;
+    }
+    m_divePlan->m_site = site;
+
+    // A first dive starts with the tissues saturated at the surface of the site
+    if (m_divePlan->m_diveNumber == 1) {
+        m_divePlan->m_initialPressure = compartmentPPinitialAt(site.m_surfacePressure);
+    }
+    rebuildDivePlan();
+}
+
 void DivePlanWindow::graphCompartments() {
     // Ensure the dive plan is calculated with time profile
-    if (m_divePlan->m_timeProfile.empty()) {
+    if (m_divePlan->timeProfile()->empty()) {
         m_divePlan->calculateDivePlan(false);
         m_divePlan->calculateTimeProfile(false);
     }
@@ -217,6 +324,8 @@ void DivePlanWindow::graphCompartments() {
     // Create the compartment graph window if it doesn't exist
     if (!m_compartmentGraphWindow) {
         m_compartmentGraphWindow = std::make_unique<CompartmentGraphWindow>(m_divePlan.get(), this);
+    } else {
+        m_compartmentGraphWindow->refreshGraph();
     }
     
     // Show the window
@@ -225,6 +334,44 @@ void DivePlanWindow::graphCompartments() {
     m_compartmentGraphWindow->raise();
 }    
 
+void DivePlanWindow::showSaturationMap() {
+    // Ensure the dive plan is calculated with time profile
+    if (m_divePlan->timeProfile()->empty()) {
+        m_divePlan->calculateDivePlan(false);
+    }
+
+    // Create the saturation map window if it doesn't exist
+    if (!m_saturationMapWindow) {
+        m_saturationMapWindow = std::make_unique<SaturationMapWindow>(m_divePlan.get(), this);
+    } else {
+        m_saturationMapWindow->refreshMap();
+    }
+
+    // Show the window
+    m_saturationMapWindow->show();
+    m_saturationMapWindow->activateWindow();
+    m_saturationMapWindow->raise();
+}
+
+void DivePlanWindow::showGasConsumption() {
+    // Ensure the dive plan is calculated with time profile
+    if (m_divePlan->timeProfile()->empty()) {
+        m_divePlan->calculateDivePlan(false);
+    }
+
+    // Create the gas consumption window if it doesn't exist
+    if (!m_gasConsumptionWindow) {
+        m_gasConsumptionWindow = std::make_unique<GasConsumptionWindow>(m_divePlan.get(), this);
+    } else {
+        m_gasConsumptionWindow->refreshGraph();
+    }
+
+    // Show the window
+    m_gasConsumptionWindow->show();
+    m_gasConsumptionWindow->activateWindow();
+    m_gasConsumptionWindow->raise();
+}
+
 void DivePlanWindow::planConsecutiveDive() {
     printf("PLAN NEXT DIVE\n");
 }
@@ -252,7 +399,8 @@ void DivePlanWindow::saveDivePlan() {
     // Show progress dialog
     showProgressDialog("Saving dive plan...");
     
-    // Perform save operation
+    // Perform save operation, with the complete summary
+    finishSummary();
     bool success = m_divePlan->saveDiveToFile(filePath.toStdString());
     
     // Close progress dialog if it's visible
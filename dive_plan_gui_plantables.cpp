@@ -14,7 +14,7 @@ void DivePlanWindow::setupDivePlanTable() {
     QStringList headers;
     headers << "Phase\n" << "Mode\n" << "Depth Range\n(m)" << "Time\n(min)" << "Run Time\n(min)"
         << "pAmb Max\n(bar)" << "pO2 Max\n(bar)" << "O2\n(%)" << "N2\n(%)" << "He\n(%)"
-        << "GF\n(%)" << "GF Surf\n(%)" << "SAC\n(L/min)" << "Amb \n(L/min)" << "Step\n(L)"
+        << "GF\n(%)" << "GF Surf\n(%)" << "Ctrl\n" << "SAC\n(L/min)" << "Amb \n(L/min)" << "Step\n(L)"
         << "Density\n(g/L)" << "END -O2\n(m)" << "END +O2\n(m)" << "CNS\n(%)"
         << "CNS Multi\n(%)" << "OTU\n";
     
@@ -40,6 +40,7 @@ void DivePlanWindow::setupDivePlanTable() {
         44,   // COL_HE_PERCENT
         44,   // COL_GF
         44,   // COL_GF_SURFACE
+        52,   // COL_CONTROLLING - compartment and gas
         44,   // COL_SAC_RATE
         44,   // COL_AMB_CONSUMPTION
         44,   // COL_STEP_CONSUMPTION
@@ -167,6 +168,15 @@ void DivePlanWindow::refreshDivePlanTable() {
             divePlanTable->setItem(i, COL_GF_SURFACE, 
                 TableHelper::createNumericCell(step.m_gfSurface, 0, false));
             
+            // Compartment and gas controlling the ceiling
+            QString controlling;
+            if (step.m_ceilingLimit.m_compartment >= 0) {
+                controlling = QString("%1 %2").arg(step.m_ceilingLimit.m_compartment + 1)
+                    .arg(QString::fromStdString(getLimitingGasString(step.m_ceilingLimit.m_gas)));
+            }
+            divePlanTable->setItem(i, COL_CONTROLLING,
+                TableHelper::createReadOnlyCell(controlling));
+            
             // SAC Rate
             divePlanTable->setItem(i, COL_SAC_RATE, 
                 TableHelper::createNumericCell(step.m_sacRate, 0, false));
@@ -0,0 +1,149 @@
+#include "dive_plan_gui_saturation_map.hpp"
+
+namespace DiveComputer {
+
+SaturationMapWindow::SaturationMapWindow(const DivePlan* divePlan, QWidget *parent)
+    : QMainWindow(parent),
+      m_divePlan(divePlan){
+    // Set window title with dive number
+    setWindowTitle(QString("Tissue saturation for dive %1").arg(m_divePlan->m_diveNumber));
+
+    // Configure window size and position
+    setWindowSizeAndPosition(this, WindowWidth, WindowHeight, WindowPosition::CENTER);
+
+    // Setup UI components
+    setupUI();
+
+    // Draw the map of the plan
+    updateMap();
+}
+
+void SaturationMapWindow::refreshMap() {
+    updateMap();
+}
+
+void SaturationMapWindow::setupUI(){
+    // Create central widget
+    QWidget* centralWidget = new QWidget(this);
+    setCentralWidget(centralWidget);
+
+    // Create main layout
+    QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
+
+    // Create graph widget
+    m_graphWidget = new QCustomPlot(centralWidget);
+    m_graphWidget->setInteraction(QCP::iRangeDrag, true);
+    m_graphWidget->setInteraction(QCP::iRangeZoom, true);
+    m_graphWidget->axisRect()->setRangeDrag(Qt::Horizontal);
+    m_graphWidget->axisRect()->setRangeZoom(Qt::Horizontal);
+
+    // Setup map
+    setupMap();
+
+    // Add graph to main layout
+    mainLayout->addWidget(m_graphWidget, 1); // 1 = stretch factor
+}
+
+void SaturationMapWindow::setupMap(){
+    // Compartments from the fastest at the bottom to the slowest at the top
+    m_graphWidget->xAxis->setLabel("Runtime (min)");
+    m_graphWidget->yAxis->setLabel("Compartment");
+    m_graphWidget->yAxis->setRange(0.5, NUM_COMPARTMENTS + 0.5);
+
+    // Map of the percent of M-value
+    m_colorMap = new QCPColorMap(m_graphWidget->xAxis, m_graphWidget->yAxis);
+    m_colorMap->setInterpolate(false);
+    m_colorMap->setTightBoundary(false);
+
+    // Blue while loading, white at ambient, through yellow to red at the M-value
+    QCPColorGradient gradient;
+    gradient.setColorStopAt(0.0, QColor(33, 102, 172));
+    gradient.setColorStopAt(0.5, QColor(247, 247, 247));
+    gradient.setColorStopAt(0.75, QColor(253, 219, 99));
+    gradient.setColorStopAt(1.0, QColor(178, 24, 43));
+
+    m_colorScale = new QCPColorScale(m_graphWidget);
+    m_graphWidget->plotLayout()->addElement(0, 1, m_colorScale);
+    m_colorScale->setType(QCPAxis::atRight);
+    m_colorScale->axis()->setLabel("% of M-value");
+    m_colorMap->setColorScale(m_colorScale);
+    m_colorMap->setGradient(gradient);
+    m_colorMap->setDataRange(QCPRange(MinPercent, MaxPercent));
+
+    // Keep the map and its scale aligned
+    QCPMarginGroup* marginGroup = new QCPMarginGroup(m_graphWidget);
+    m_graphWidget->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+    m_colorScale->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+
+    // Leading compartment over the map
+    m_leadingGraph = m_graphWidget->addGraph();
+    m_leadingGraph->setPen(QPen(QColor(0, 0, 0), 2));
+    m_leadingGraph->setLineStyle(QCPGraph::lsStepCenter);
+    m_leadingGraph->setName("Leading compartment");
+
+    // Compartment controlling the ceiling, one marker colour per limiting gas
+    const QColor controllingColors[3] = {QColor(0, 0, 255), QColor(255, 0, 0), QColor(0, 128, 0)};
+    for (int gas = 0; gas < 3; gas++) {
+        m_controllingGraphs[gas] = m_graphWidget->addGraph();
+        m_controllingGraphs[gas]->setLineStyle(QCPGraph::lsNone);
+        m_controllingGraphs[gas]->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, controllingColors[gas], 5));
+        m_controllingGraphs[gas]->setName(QString("Ceiling, %1")
+            .arg(QString::fromStdString(getLimitingGasString(static_cast<LimitingGas>(gas)))));
+    }
+
+    m_graphWidget->legend->setVisible(true);
+    m_graphWidget->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignTop|Qt::AlignLeft);
+}
+
+void SaturationMapWindow::updateMap(){
+    // Log performance
+    QElapsedTimer timer;
+    timer.start();
+
+    // Nothing to draw again when the plan was not calculated and the parameters not changed since
+    if (m_mapValid && m_mapRevision == m_divePlan->revision() && m_mapEpoch == g_parameters.epoch()) {
+        return;
+    }
+
+    std::shared_ptr<const SaturationMap> snapshot = m_divePlan->saturationMap();
+    const SaturationMap& map = *snapshot;
+    m_mapRevision = m_divePlan->revision();
+    m_mapEpoch = g_parameters.epoch();
+    m_mapValid = true;
+    if (map.empty()) {
+        return;
+    }
+
+    // The cells are copied from the matrix of the plan, nothing is calculated here
+    QCPColorMapData* data = m_colorMap->data();
+    data->setSize(map.m_columns, NUM_COMPARTMENTS);
+    data->setRange(QCPRange(map.m_startTime, map.m_endTime), QCPRange(1, NUM_COMPARTMENTS));
+
+    QVector<QCPGraphData> leading(map.m_columns);
+    QVector<QCPGraphData> controlling[3];
+    double columnTime = (map.m_endTime - map.m_startTime) / std::max(1, map.m_columns - 1);
+    for (int c = 0; c < map.m_columns; c++) {
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            data->setCell(c, j, map.percent(c, j));
+        }
+        leading[c] = QCPGraphData(map.m_startTime + c * columnTime, map.m_leading[c] + 1);
+
+        const TissueLimit& limit = map.m_controlling[c];
+        if (limit.m_compartment >= 0) {
+            controlling[static_cast<int>(limit.m_gas)].append(
+                QCPGraphData(map.m_startTime + c * columnTime, limit.m_compartment + 1));
+        }
+    }
+    m_leadingGraph->data()->set(leading, true);
+    for (int gas = 0; gas < 3; gas++) {
+        m_controllingGraphs[gas]->data()->set(controlling[gas], true);
+    }
+
+    m_graphWidget->xAxis->setRange(map.m_startTime, map.m_endTime);
+    m_graphWidget->replot();
+
+    // Monitor performance
+    logWrite("SaturationMapWindow::updateMap() took ", timer.elapsed(), " ms");
+}
+
+} // namespace DiveComputer
@@ -0,0 +1,55 @@
+#ifndef DIVE_PLAN_GUI_SATURATION_MAP_HPP
+#define DIVE_PLAN_GUI_SATURATION_MAP_HPP
+
+#include "log_info.hpp"
+#include "qtheaders.hpp"
+#include "dive_plan.hpp"
+#include "compartments.hpp"
+#include "ui_utils.hpp"
+#include "qcustomplot.hpp"
+
+namespace DiveComputer {
+
+// Heat map of the percent of M-value of all the compartments over the run time,
+// with the leading compartment and the compartment controlling the ceiling drawn over it
+class SaturationMapWindow : public QMainWindow {
+    Q_OBJECT
+
+public:
+    SaturationMapWindow(const DivePlan* divePlan, QWidget *parent = nullptr);
+    ~SaturationMapWindow() override = default;
+
+    // Redraw when the plan was calculated again since the map was drawn
+    void refreshMap();
+
+private:
+    // Reference to the dive plan
+    const DivePlan* m_divePlan;
+
+    // UI Elements
+    QCustomPlot* m_graphWidget;
+    QCPColorMap* m_colorMap;
+    QCPColorScale* m_colorScale;
+    QCPGraph* m_leadingGraph;
+    QCPGraph* m_controllingGraphs[3];   // per limiting gas, N2, He and inert
+
+    // Plan revision and parameters epoch drawn
+    uint64_t m_mapRevision = 0;
+    uint64_t m_mapEpoch = 0;
+    bool m_mapValid = false;
+
+    // Styling constants
+    static constexpr int WindowWidth = 900;
+    static constexpr int WindowHeight = 500;
+    static constexpr double MinPercent = -100.0;   // loading, and below
+    static constexpr double MaxPercent = 100.0;    // at the M-value, and above
+
+    // Setup methods
+    void setupUI();
+    void setupMap();
+    void updateMap();
+};
+
+} // namespace DiveComputer
+
+#endif // DIVE_PLAN_GUI_SATURATION_MAP_HPP
@@ -106,7 +106,7 @@ void DivePlanWindow::setpointCellChanged(int row, int column) {
             // We just need to recalculate the dive plan
             m_divePlan->calculateDivePlan();
             m_divePlan->calculateGasConsumption();
-            m_divePlan->calculateDiveSummary();
+            calculateSummary();
             refreshWindow();
 
             // Allow UI to process events after the edit
@@ -134,7 +134,7 @@ void DivePlanWindow::addSetpoint() {
     // Refresh the dive plan
     m_divePlan->calculateDivePlan();
     m_divePlan->calculateGasConsumption();
-    m_divePlan->calculateDiveSummary();
+    calculateSummary();
     refreshWindow();
 
     // Allow UI to process events after the edit
@@ -159,7 +159,7 @@ void DivePlanWindow::deleteSetpoint(int row) {
         // Refresh the dive plan
         m_divePlan->calculateDivePlan();
         m_divePlan->calculateGasConsumption();
-        m_divePlan->calculateDiveSummary();
+        calculateSummary();
         refreshWindow();
 
         // Allow UI to process events after the edit
@@ -50,8 +50,8 @@ void DivePlanWindow::setupSummaryWidget() {
     gfLayout->setContentsMargins(0, 0, 0, 0);
     gfLayout->setSpacing(5);
     
-    gfLowEdit = new QLineEdit(QString::number(g_parameters.m_gf[0]), gfWidget);
-    gfHighEdit = new QLineEdit(QString::number(g_parameters.m_gf[1]), gfWidget);
+    gfLowEdit = new QLineEdit(QString::number(m_divePlan->m_gf[0]), gfWidget);
+    gfHighEdit = new QLineEdit(QString::number(m_divePlan->m_gf[1]), gfWidget);
     
     // Set validators for GF values (0-100)
     QIntValidator* gfValidator = new QIntValidator(0, 100, gfWidget);
@@ -262,9 +262,14 @@ void DivePlanWindow::refreshDiveSummaryTable() {
     // Update nofly time
     noflyTimeLabel->setText(QString::number(m_divePlan->getNoFlyTime(), 'f', 0) + " hours");
 
+    // Minutes of a what-if, or an ellipsis while it is still calculated on the compute pool
+    auto minutesText = [](double minutes, bool pending) {
+        return pending ? QString("\u2026") : QString::number(minutes, 'f', 0) + " min";
+    };
+
     // Update TTS Target - always visible
     ttsTargetLabel->setText(QString::number(m_divePlan->m_tts, 'f', 0) + " min");
-    ttsDeltaLabel->setText(QString::number(m_divePlan->m_ttsDelta, 'f', 0) + " min");
+    ttsDeltaLabel->setText(minutesText(m_divePlan->m_ttsDelta, m_summaryWhatIfs.m_ttsDelta.valid()));
     
     // Show/hide and update all AP-dependent elements
     bool showAP = (m_divePlan->m_mode == diveMode::OC) || 
@@ -288,9 +293,9 @@ void DivePlanWindow::refreshDiveSummaryTable() {
             // Update values if visible
             if (showAP) {
                 if (pair.first->text() == "Max BT:") {
-                    pair.second->setText(QString::number(m_divePlan->m_maxResult.first, 'f', 0) + " min");
+                    pair.second->setText(minutesText(m_divePlan->m_maxResult.first, m_summaryWhatIfs.m_maxResult.valid()));
                 } else if (pair.first->text() == "TTS Max:") {
-                    pair.second->setText(QString::number(m_divePlan->m_maxResult.second, 'f', 0) + " min");
+                    pair.second->setText(minutesText(m_divePlan->m_maxResult.second, m_summaryWhatIfs.m_maxResult.valid()));
                 } else if (pair.first->text() == "AP:") {
                     pair.second->setText(QString::number(m_divePlan->m_ap, 'f', 0) + " bar" + 
                         (g_parameters.m_calculateAPandTPonOneTank ? " (on one tank)" : " (on all tanks)"));
@@ -314,7 +319,7 @@ void DivePlanWindow::refreshDiveSummaryTable() {
             pair.second->setVisible(hasMission);
             
             if (hasMission) {
-                turnTtsLabel->setText(QString::number(m_divePlan->m_turnTts, 'f', 0) + " min");
+                turnTtsLabel->setText(minutesText(m_divePlan->m_turnTts, m_summaryWhatIfs.m_turnTts.valid()));
             }
             break;
         }
@@ -352,19 +357,23 @@ void DivePlanWindow::onGFChanged() {
     
     if (!lowOk || !highOk) {
         // Restore previous values
-        gfLowEdit->setText(QString::number(g_parameters.m_gf[0]));
-        gfHighEdit->setText(QString::number(g_parameters.m_gf[1]));
+        gfLowEdit->setText(QString::number(m_divePlan->m_gf[0]));
+        gfHighEdit->setText(QString::number(m_divePlan->m_gf[1]));
         return;
     }
     
-    // Apply changes
+    // Apply changes to this plan, and keep them as the default for new plans
+    m_divePlan->m_gf[0] = gfLow;
+    m_divePlan->m_gf[1] = gfHigh;
     g_parameters.m_gf[0] = gfLow;
     g_parameters.m_gf[1] = gfHigh;
     
-    // Refresh the dive plan
-    m_divePlan->calculateDivePlan();
-    m_divePlan->calculateGasConsumption();
-    m_divePlan->calculateDiveSummary();
+    // Refresh the dive plan, unless the edit was calculated ahead
+    if (!adoptCachedPlan()) {
+        m_divePlan->calculateDivePlan();
+        m_divePlan->calculateGasConsumption();
+        calculateSummary();
+    }
     refreshWindow();
 }
 
@@ -382,10 +391,12 @@ void DivePlanWindow::onMissionChanged() {
     // Apply change
     m_divePlan->m_mission = mission;
     
-    // Refresh the dive plan
-    m_divePlan->calculateDivePlan();
-    m_divePlan->calculateGasConsumption();
-    m_divePlan->calculateDiveSummary();
+    // Refresh the dive plan, unless it was calculated before with this mission
+    if (!adoptCachedPlan()) {
+        m_divePlan->calculateDivePlan();
+        m_divePlan->calculateGasConsumption();
+        calculateSummary();
+    }
     refreshWindow();
 }
 
@@ -0,0 +1,44 @@
+#include "dive_site.hpp"
+#include "constants.hpp"
+
+namespace DiveComputer {
+
+namespace {
+
+// The embedded build calculates one plan at a time
+#ifdef DIVECOMPUTER_EMBEDDED
+const DiveSite* t_currentSite = nullptr;
+#else
+thread_local const DiveSite* t_currentSite = nullptr;
+#endif
+
+double waterDensity(WaterType waterType) {
+    return (waterType == WaterType::FRESH) ? g_constants.m_freshWaterDensity : g_constants.m_waterDensity;
+}
+
+} // namespace
+
+DiveSite::DiveSite()
+    : DiveSite(WaterType::SALT, g_constants.m_atmPressureStp) {}
+
+DiveSite::DiveSite(WaterType waterType, double surfacePressure)
+    : m_waterType(waterType),
+      m_surfacePressure(surfacePressure),
+      m_barPerMeter(waterDensity(waterType) * g_constants.m_gravitation / 100000.0),
+      m_meterPerBar(1.0 / m_barPerMeter) {}
+
+const DiveSite& currentDiveSite() {
+    static const DiveSite seaLevel;
+    return t_currentSite ? *t_currentSite : seaLevel;
+}
+
+DiveSiteScope::DiveSiteScope(const DiveSite& site)
+    : m_previous(t_currentSite) {
+    t_currentSite = &site;
+}
+
+DiveSiteScope::~DiveSiteScope() {
+    t_currentSite = m_previous;
+}
+
+} // namespace DiveComputer
@@ -0,0 +1,48 @@
+#ifndef DIVE_SITE_HPP
+#define DIVE_SITE_HPP
+
+#include "enum.hpp"
+
+namespace DiveComputer {
+
+// Water and surface pressure of the place a plan is dived, an input of the plan.
+// The depth to pressure mapping of the site is worked out once, when it is set:
+// pressure = surface pressure + bar per meter * depth.
+struct DiveSite {
+    WaterType m_waterType;
+    double m_surfacePressure;    // in bar, lower at altitude
+    double m_barPerMeter;        // from the density of the water and gravitation
+    double m_meterPerBar;
+
+    // Salt water at sea level (STP), the site of the plans saved before sites were added
+    DiveSite();
+    DiveSite(WaterType waterType, double surfacePressure);
+
+    bool operator==(const DiveSite& other) const {
+        return m_waterType == other.m_waterType && m_surfacePressure == other.m_surfacePressure;
+    }
+    bool operator!=(const DiveSite& other) const { return !(*this == other); }
+};
+
+// Site of the calculation running on this thread: the site of the plan being calculated,
+// sea level salt water outside of a plan. The pressure and depth functions of global.hpp
+// use it, so plans of different sites calculate concurrently on different threads.
+const DiveSite& currentDiveSite();
+
+// Makes a site current on this thread for its lifetime, the previous one current again after.
+// Set by the calculating methods of DivePlan.
+class DiveSiteScope {
+public:
+    explicit DiveSiteScope(const DiveSite& site);
+    ~DiveSiteScope();
+
+    DiveSiteScope(const DiveSiteScope&) = delete;
+    DiveSiteScope& operator=(const DiveSiteScope&) = delete;
+
+private:
+    const DiveSite* m_previous;
+};
+
+} // namespace DiveComputer
+
+#endif // DIVE_SITE_HPP
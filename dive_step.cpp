@@ -1,8 +1,10 @@
 #include "dive_step.hpp"
+#include "tissue_kernel.hpp"
 
 
 namespace DiveComputer {
 
+#ifndef DIVECOMPUTER_EMBEDDED
 std::ostream& operator<<(std::ostream& os, const DiveStep& step)
 {
     os << std::fixed << std::setprecision(2)
@@ -13,85 +15,18 @@ std::ostream& operator<<(std::ostream& os, const DiveStep& step)
        << std::setw(8) << step.m_mode;
     return os;
 }
+#endif
 
-double DiveStep::getGFSurface(DiveStep *stepSurface){
-    double GF_surface = 0;
-    
-    for (int j = 0; j < NUM_COMPARTMENTS; j++){
-        double GF_surface_n2 = 0, GF_surface_he = 0, GF_surface_inert = 0;
-
-        GF_surface_n2    = (m_ppActual[j].m_pN2    - g_parameters.m_atmPressure) / (stepSurface->m_ppMax[j].m_pN2    - g_parameters.m_atmPressure) * 100;
-        GF_surface_he    = (m_ppActual[j].m_pHe    - g_parameters.m_atmPressure) / (stepSurface->m_ppMax[j].m_pHe    - g_parameters.m_atmPressure) * 100;
-        GF_surface_inert = (m_ppActual[j].m_pInert - g_parameters.m_atmPressure) / (stepSurface->m_ppMax[j].m_pInert - g_parameters.m_atmPressure) * 100;
-
-        GF_surface = std::max(GF_surface, GF_surface_n2);
-        GF_surface = std::max(GF_surface, GF_surface_he);
-        GF_surface = std::max(GF_surface, GF_surface_inert);
-    }
-
-    return GF_surface;
+double DiveStep::getGFSurface(const DiveStep *stepSurface){
+    return tissueKernel().gfSurface(m_ppActual, stepSurface->m_ppMax, currentDiveSite().m_surfacePressure, m_gfSurfaceLimit);
 }
 
 double DiveStep::getCeiling(double GF){
-    double ceiling_n2 = 0, ceiling_he = 0, ceiling_inert = 0;
-
-    for (int j = 0; j < NUM_COMPARTMENTS; j++){
-        double p_amb_min_n2, p_amb_min_he, p_amb_min_inert;
-        
-        // N2
-        double a_n2 = g_buhlmannModel.m_compartments[j].m_aN2;
-        double b_n2 = g_buhlmannModel.m_compartments[j].m_bN2;
-        p_amb_min_n2 = (m_ppActual[j].m_pN2 - a_n2 * GF / 100) /  (1 + (1 / b_n2 - 1) * GF / 100);
-        ceiling_n2 = std::max(ceiling_n2, getDepthFromPressure(p_amb_min_n2));
-        
-        // He
-        double a_he = g_buhlmannModel.m_compartments[j].m_aHe;
-        double b_he = g_buhlmannModel.m_compartments[j].m_bHe;
-        p_amb_min_he = (m_ppActual[j].m_pHe - a_he * GF / 100) /  (1 + (1 / b_he - 1) * GF / 100);
-        ceiling_he = std::max(ceiling_he, getDepthFromPressure(p_amb_min_he));
-         
-        // For total inert gas: adjusted by the proportion of N2 over (N2 + He)
-        // If only O2 is breathed, then no condition on total inert gas. Max out P_Inert_Max
-            
-        double ratio_n2_he = 1;
-        double total_inert_percent = m_n2Percent + m_hePercent;
-            
-        if (total_inert_percent != 0){
-            ratio_n2_he = m_n2Percent / total_inert_percent;
-        }
-            
-        double a_inert = g_buhlmannModel.m_compartments[j].m_aN2 * ratio_n2_he + g_buhlmannModel.m_compartments[j].m_aHe * (1 - ratio_n2_he);
-        double b_inert = g_buhlmannModel.m_compartments[j].m_bN2 * ratio_n2_he + g_buhlmannModel.m_compartments[j].m_bHe * (1 - ratio_n2_he);
-        p_amb_min_inert = (m_ppActual[j].m_pInert - a_inert * GF / 100) /  (1 + (1 / b_inert - 1) * GF / 100);
-        ceiling_inert = std::max(ceiling_inert, getDepthFromPressure(p_amb_min_inert));
-    }
-
-    return std::max(ceiling_n2, std::max(ceiling_he, ceiling_inert));
+    return tissueKernel().ceiling(m_ppActual, m_n2Percent, m_hePercent, GF);
 }
 
-void DiveStep::calculatePPInertGasForStep(DiveStep& previousStep, double time) {
-    double pAmbStart = m_pAmbStartDepth;
-    double pAmbEnd = m_pAmbEndDepth;
-    double inertPercentN2 = m_n2Percent;
-    double inertPercentHe = m_hePercent;
-
-    for (int j = 0; j < NUM_COMPARTMENTS; j++) {
-        double p0N2 = 0.0;
-        double p0He = 0.0;
-            
-        p0N2 = previousStep.m_ppActual[j].m_pN2;
-        p0He = previousStep.m_ppActual[j].m_pHe; 
-
-        double halfTimeN2 = g_buhlmannModel.getCompartment(j).m_halfTimeN2;
-        double halfTimeHe = g_buhlmannModel.getCompartment(j).m_halfTimeHe;
-
-        double pN2 = getSchreinerEquation(p0N2, halfTimeN2, pAmbStart, pAmbEnd, time, inertPercentN2);
-        double pHe = getSchreinerEquation(p0He, halfTimeHe, pAmbStart, pAmbEnd, time, inertPercentHe);
-        double pInert = pN2 + pHe;
-
-        CompartmentPP pp(pN2, pHe, pInert);
-        m_ppActual[j] = pp;
-    }
+void DiveStep::calculatePPInertGasForStep(const DiveStep& previousStep, double time) {
+    tissueKernel().saturate(previousStep.m_ppActual, m_ppActual, m_pAmbStartDepth, m_pAmbEndDepth, time, m_n2Percent, m_hePercent);
 }
 
 void DiveStep::calculatePPInertGasMaxForStep(double& lastRatioN2He) {
@@ -146,17 +81,36 @@ void DiveStep::calculatePPInertGasMaxForStep(double& lastRatioN2He) {
 }
 
 bool DiveStep::getIfBreachingDecoLimits() {
-    bool breached = false;
-    
-    for (int j = 0; j < NUM_COMPARTMENTS; j++){
-         breached = (m_ppActual[j].m_pN2 > m_ppMaxAdjustedGF[j].m_pN2) ||
-                   (m_ppActual[j].m_pHe > m_ppMaxAdjustedGF[j].m_pHe) ||
-                   (m_ppActual[j].m_pInert > m_ppMaxAdjustedGF[j].m_pInert);            
-
-        if (breached) break;
-    }
+    return tissueKernel().breaching(m_ppActual, m_ppMaxAdjustedGF);
+}
+
+// Per-step metrics in one pass: the ambient pressures are computed once and
+// the ceiling, consumption, GF surface, density and END are all derived from them
+void DiveStep::updateMetrics(const DiveStep *stepSurface, double GF){
+    m_pAmbStartDepth = getPressureFromDepth(m_startDepth);
+    m_pAmbEndDepth = getPressureFromDepth(m_endDepth);
+    m_pAmbMax = std::max(m_pAmbStartDepth, m_pAmbEndDepth);
+
+    m_pO2Max = m_pAmbMax * m_o2Percent / 100.0;
+    m_n2Percent = 100.0 - m_o2Percent - m_hePercent;
+
+    // The ceiling at GF, and the compartment holding the ascent back at the GF the step is
+    // planned with, in one pass
+    m_ceiling = tissueKernel().ceiling(m_ppActual, m_n2Percent, m_hePercent, GF, m_gf, m_ceilingLimit);
+
+    m_sacRate = 
+        (m_mode == stepMode::CC) ? 0 : 
+        (m_mode == stepMode::BAILOUT) ? g_parameters.m_sacBailout : 
+        (m_mode == stepMode::OC) ? g_parameters.m_sacBottom : 
+        g_parameters.m_sacDeco;
+    m_ambConsumptionAtDepth = m_sacRate * (m_pAmbStartDepth + m_pAmbEndDepth) / 2.0;
+    m_stepConsumption = m_time * m_ambConsumptionAtDepth;
+
+    m_gfSurface = getGFSurface(stepSurface);
 
-    return breached;
+    m_gasDensity = Gas::densityAtPressure(m_o2Percent, m_hePercent, m_pAmbMax);
+    m_endWithoutO2 = Gas::ENDWithoutO2AtPressure(m_o2Percent, m_hePercent, m_pAmbMax);
+    m_endWithO2 = Gas::ENDWithO2AtPressure(m_hePercent, m_pAmbMax);
 }
 
 void DiveStep::updatePAmb(){
@@ -169,33 +123,33 @@ void DiveStep::updateCeiling(double GF){
     m_ceiling = getCeiling(GF);
 }
 
-void DiveStep::updateOxygenToxicity(DiveStep *previousStep){
+void DiveStep::updateOxygenToxicity(const DiveStep *previousStep){
+    // The O2 fraction is constant over the step, so the ppO2 varies linearly with time
+    double ppO2Start = m_pAmbStartDepth * m_o2Percent / 100.0;
+    double ppO2End = m_pAmbEndDepth * m_o2Percent / 100.0;
 
     m_cnsMaxMinSingleDive = g_oxygenToxicity.getCNSMaxMin(m_pO2Max, true);
-    if(m_cnsMaxMinSingleDive != 0.0) m_cnsStepSingleDive = m_time / m_cnsMaxMinSingleDive * 100;
-    else m_cnsStepSingleDive = 0.0;
+    m_cnsStepSingleDive = g_oxygenToxicity.getCNSForRamp(ppO2Start, ppO2End, m_time, true);
     m_cnsTotalSingleDive = previousStep->m_cnsTotalSingleDive + m_cnsStepSingleDive;
 
     m_cnsMaxMinMultipleDives = g_oxygenToxicity.getCNSMaxMin(m_pO2Max, false);
-    if(m_cnsMaxMinMultipleDives != 0.0) m_cnsStepMultipleDives = m_time / m_cnsMaxMinMultipleDives * 100;
-    else m_cnsStepMultipleDives = 0.0;
+    m_cnsStepMultipleDives = g_oxygenToxicity.getCNSForRamp(ppO2Start, ppO2End, m_time, false);
     m_cnsTotalMultipleDives = previousStep->m_cnsTotalMultipleDives + m_cnsStepMultipleDives;
         
     m_otuPerMin = g_oxygenToxicity.getOTUPerMin(m_pO2Max);
-    m_otuStep = m_time * m_otuPerMin;
+    m_otuStep = g_oxygenToxicity.getOTUForRamp(ppO2Start, ppO2End, m_time);
     m_otuTotal = previousStep->m_otuTotal + m_otuStep;
 
 }
 
 void DiveStep::updateDensity(){
-    Gas tempGas(m_o2Percent, m_hePercent, GasType::BOTTOM, GasStatus::ACTIVE);
-    m_gasDensity = tempGas.Density(std::max(m_startDepth, m_endDepth));
+    m_gasDensity = Gas::densityAtPressure(m_o2Percent, m_hePercent, getPressureFromDepth(std::max(m_startDepth, m_endDepth)));
 }
 
 void DiveStep::updateEND(){
-    Gas tempGas(m_o2Percent, m_hePercent, GasType::BOTTOM, GasStatus::ACTIVE);
-    m_endWithoutO2 = tempGas.ENDWithoutO2(std::max(m_startDepth, m_endDepth));
-    m_endWithO2 = tempGas.ENDWithO2(std::max(m_startDepth, m_endDepth));
+    double pAmb = getPressureFromDepth(std::max(m_startDepth, m_endDepth));
+    m_endWithoutO2 = Gas::ENDWithoutO2AtPressure(m_o2Percent, m_hePercent, pAmb);
+    m_endWithO2 = Gas::ENDWithO2AtPressure(m_hePercent, pAmb);
 }
 
 void DiveStep::updateConsumption(){
@@ -211,13 +165,13 @@ void DiveStep::updateConsumption(){
         m_stepConsumption = m_time * m_ambConsumptionAtDepth;
 }
 
-void DiveStep::updateGFSurface(DiveStep *stepSurface){
+void DiveStep::updateGFSurface(const DiveStep *stepSurface){
 
     m_gfSurface = getGFSurface(stepSurface);
 
 }
 
-void DiveStep::updateRunTime(DiveStep *previousStep){
+void DiveStep::updateRunTime(const DiveStep *previousStep){
     m_runTime = previousStep->m_runTime + m_time;
 }
 
@@ -1,13 +1,15 @@
 #ifndef dive_step_HPP
 #define dive_step_HPP
 
+#include <cstddef>
+#include "enum.hpp"
+#ifndef DIVECOMPUTER_EMBEDDED
 #include <string>
 #include <memory>
 #include <vector>
-#include <cstddef>
-#include "enum.hpp"
 #include <iostream>
 #include <iomanip>
+#endif
 #include "compartments.hpp"
 #include "buhlmann.hpp"
 #include "global.hpp"
@@ -22,7 +24,9 @@ public:
     DiveStep() = default;
     ~DiveStep() = default;
 
+#ifndef DIVECOMPUTER_EMBEDDED
     friend std::ostream& operator<<(std::ostream& os, const DiveStep& step);
+#endif
     
     Phase  m_phase{Phase::STOP}; 
     stepMode m_mode{stepMode::OC};
@@ -42,12 +46,15 @@ public:
     double m_n2Percent{0.0};
     double m_hePercent{0.0};
 
+    // Index of the breathed gas in DivePlan::m_gasAvailable (-1 if none, e.g. surface air)
+    int    m_gasIndex{-1};
+
     double m_gf{0.0};
     double m_gfSurface{0.0};
 
-    std::vector<CompartmentPP> m_ppMax{NUM_COMPARTMENTS};
-    std::vector<CompartmentPP> m_ppMaxAdjustedGF{NUM_COMPARTMENTS};
-    std::vector<CompartmentPP> m_ppActual{NUM_COMPARTMENTS};
+    CompartmentPressures m_ppMax{};
+    CompartmentPressures m_ppMaxAdjustedGF{};
+    CompartmentPressures m_ppActual{};
 
     double m_sacRate{0.0};
     double m_ambConsumptionAtDepth{0.0};
@@ -71,26 +78,33 @@ public:
 
     double m_ceiling{0.0};
 
+    // Compartment and gas driving the ceiling at the GF of the step, and the GF at the surface
+    TissueLimit m_ceilingLimit{};
+    TissueLimit m_gfSurfaceLimit{};
+
     // Core functions    
-    double getGFSurface(DiveStep *stepSurface);
+    double getGFSurface(const DiveStep *stepSurface);
     double getCeiling(double GF);
-    void   calculatePPInertGasForStep(DiveStep& previousStep, double time);
+    void   calculatePPInertGasForStep(const DiveStep& previousStep, double time);
     void   calculatePPInertGasMaxForStep(double& lastRatioN2He);
     bool   getIfBreachingDecoLimits();
 
     // update functions
+    void updateMetrics(const DiveStep *stepSurface, double GF);
     void updatePAmb();
     void updateCeiling(double GF);
-    void updateOxygenToxicity(DiveStep *previousStep);
+    void updateOxygenToxicity(const DiveStep *previousStep);
     void updateConsumption();
-    void updateGFSurface(DiveStep *stepSurface);
+    void updateGFSurface(const DiveStep *stepSurface);
     void updateDensity();
     void updateEND();
-    void updateRunTime(DiveStep *previousDiveStep);
+    void updateRunTime(const DiveStep *previousDiveStep);
 
+#ifndef DIVECOMPUTER_EMBEDDED
     // Print to terminal functions
     void printStepDetails(const int step) const;
     void printCompartmentDetails(const int step, const int compartment) const;
+#endif
 
 };
 
@@ -0,0 +1,74 @@
+# Command-line batch planner and local planning service: the planning core without the windows.
+# Build next to the GUI with: qmake divecomputer-cli.pro && make -f Makefile.cli
+
+TARGET = divecomputer-cli
+TEMPLATE = app
+
+# No windows: the widget headers and functions are left out of the shared sources
+QT = core
+DEFINES += DIVECOMPUTER_HEADLESS
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# zlib writes the rotated log archives as gzip
+LIBS += -lz
+
+MAKEFILE = Makefile.cli
+OBJECTS_DIR = build-cli
+MOC_DIR = build-cli
+
+SOURCES += \
+    divecomputer_cli.cpp \
+    batch_planner.cpp \
+    plan_service.cpp \
+    log_info.cpp \
+    enum.cpp \
+    global.cpp \
+    constants.cpp \
+    parameters.cpp \
+    gas.cpp \
+    gaslist.cpp \
+    buhlmann.cpp \
+    compartments.cpp \
+    dive_site.cpp \
+    oxygen_toxicity.cpp \
+    stop_steps.cpp \
+    set_points.cpp \
+    dive_step.cpp \
+    dive_plan.cpp \
+    dive_plan_file.cpp \
+    compute_pool.cpp
+
+HEADERS += \
+    batch_planner.hpp \
+    plan_service.hpp \
+    log_info.hpp \
+    qtheaders.hpp \
+    error_handler.hpp \
+    global.hpp \
+    core_config.hpp \
+    fixed_vector.hpp \
+    enum.hpp \
+    constants.hpp \
+    parameters.hpp \
+    gas.hpp \
+    gaslist.hpp \
+    buhlmann.hpp \
+    compartments.hpp \
+    dive_site.hpp \
+    tissue_kernel.hpp \
+    oxygen_toxicity.hpp \
+    stop_steps.hpp \
+    set_points.hpp \
+    dive_step.hpp \
+    dive_plan.hpp \
+    dive_plan_file.hpp \
+    compute_pool.hpp
+
+macx {
+    SDK_PATH = $$system(xcrun --show-sdk-path)
+    QMAKE_CXXFLAGS += -isysroot $$SDK_PATH -stdlib=libc++
+    QMAKE_LFLAGS += -isysroot $$SDK_PATH
+    QMAKE_MACOSX_DEPLOYMENT_TARGET = 14.0
+}
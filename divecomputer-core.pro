@@ -0,0 +1,52 @@
+# Planning core for on-device use: a static library without Qt, exceptions or heap allocation
+# once a plan is set up (see core_config.hpp). Link it from the firmware build, or check it with:
+# qmake divecomputer-core.pro && make -f Makefile.core
+# tests/core_alloc_test.pro builds the core with a counting operator new and fails on any allocation
+# made once a plan is set up.
+
+TARGET = divecomputer-core
+TEMPLATE = lib
+CONFIG += staticlib c++17
+CONFIG -= qt
+
+DEFINES += DIVECOMPUTER_EMBEDDED
+QMAKE_CXXFLAGS += -fno-exceptions -fno-rtti
+
+MAKEFILE = Makefile.core
+OBJECTS_DIR = build-core
+
+SOURCES += \
+    enum.cpp \
+    global.cpp \
+    constants.cpp \
+    parameters.cpp \
+    gas.cpp \
+    gaslist.cpp \
+    buhlmann.cpp \
+    compartments.cpp \
+    dive_site.cpp \
+    oxygen_toxicity.cpp \
+    stop_steps.cpp \
+    set_points.cpp \
+    dive_step.cpp \
+    dive_plan.cpp
+
+HEADERS += \
+    core_config.hpp \
+    fixed_vector.hpp \
+    log_info.hpp \
+    global.hpp \
+    enum.hpp \
+    constants.hpp \
+    parameters.hpp \
+    gas.hpp \
+    gaslist.hpp \
+    buhlmann.hpp \
+    compartments.hpp \
+    dive_site.hpp \
+    tissue_kernel.hpp \
+    oxygen_toxicity.hpp \
+    stop_steps.hpp \
+    set_points.hpp \
+    dive_step.hpp \
+    dive_plan.hpp
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include "batch_planner.hpp"
+#include "compute_pool.hpp"
+#include "global.hpp"
+#include "log_info.hpp"
+#include "parameters.hpp"
+#include "plan_service.hpp"
+
+// Batch planner without GUI: no QApplication is created and the standard application
+// data location is never used. Parameters are the defaults, or those saved in --data-dir.
+// The same binary runs the local planning service and its client.
+
+static void printUsage() {
+    std::cerr << "Usage: divecomputer-cli [options] [file ...]\n"
+                 "Reads plan specs (JSON or CSV lines) from the files, or stdin when none or '-',\n"
+                 "and writes one result per plan to stdout, in input order.\n"
+                 "\n"
+                 "Options:\n"
+                 "  --format ndjson|csv   output format (default ndjson)\n"
+                 "  --jobs N              number of threads planning, and of threads calculating\n"
+                 "                        the what-ifs of the summaries (default: all cores)\n"
+                 "  --data-dir DIR        read parameters.dat from DIR and write the log there\n"
+                 "  --verbose             write the log to stderr\n"
+                 "  --help                show this help\n"
+                 "\n"
+                 "Planning service (see plan_service.hpp):\n"
+                 "  --serve SOCKET        serve JSON-RPC plan requests on a Unix domain socket\n"
+                 "  --serve-tcp PORT      serve them on 127.0.0.1:PORT\n"
+                 "  --cache N             results kept by the service (default 4096)\n"
+                 "  --client SOCKET       send the plan specs of the files to a service and write\n"
+                 "  --client-tcp PORT     its responses to stdout\n";
+}
+
+int main(int argc, char *argv[]) {
+    std::ios::sync_with_stdio(false);
+
+    DiveComputer::BatchFormat format = DiveComputer::BatchFormat::NDJSON;
+    int jobs = static_cast<int>(std::thread::hardware_concurrency());
+    std::string dataDirectory;
+    bool verbose = false;
+    std::vector<std::string> inputs;
+
+    enum class RunMode { BATCH, SERVE, CLIENT };
+    RunMode runMode = RunMode::BATCH;
+    DiveComputer::PlanServiceOptions serviceOptions;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--format" && hasValue) {
+            std::string value = argv[++i];
+            if (value == "ndjson" || value == "json") {
+                format = DiveComputer::BatchFormat::NDJSON;
+            } else if (value == "csv") {
+                format = DiveComputer::BatchFormat::CSV;
+            } else {
+                std::cerr << "Unknown format: " << value << "\n";
+                return 2;
+            }
+        } else if (arg == "--jobs" && hasValue) {
+            jobs = std::atoi(argv[++i]);
+        } else if (arg == "--data-dir" && hasValue) {
+            dataDirectory = argv[++i];
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else if ((arg == "--serve" || arg == "--client") && hasValue) {
+            runMode = (arg == "--serve") ? RunMode::SERVE : RunMode::CLIENT;
+            serviceOptions.m_socketPath = argv[++i];
+        } else if ((arg == "--serve-tcp" || arg == "--client-tcp") && hasValue) {
+            runMode = (arg == "--serve-tcp") ? RunMode::SERVE : RunMode::CLIENT;
+            serviceOptions.m_tcpPort = std::atoi(argv[++i]);
+            if (serviceOptions.m_tcpPort <= 0 || serviceOptions.m_tcpPort > 65535) {
+                std::cerr << "Invalid port: " << argv[i] << "\n";
+                return 2;
+            }
+        } else if (arg == "--cache" && hasValue) {
+            serviceOptions.m_cacheSize = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage();
+            return 2;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    // The what-ifs of the summaries run on the compute pool, sized like the planning threads
+    DiveComputer::ComputePool::setInstanceThreads(jobs);
+
+    // stdout only carries results: the log goes to stderr, and to a file only with a data directory
+    DiveComputer::logSetOutputs(verbose ? DiveComputer::LogConsole::STDERR : DiveComputer::LogConsole::NONE,
+                                !dataDirectory.empty());
+
+    if (!dataDirectory.empty()) {
+        DiveComputer::setDataDirectory(dataDirectory);
+        DiveComputer::g_parameters.loadParametersFromFile();
+    }
+
+    if (runMode == RunMode::SERVE) {
+        serviceOptions.m_threads = jobs;
+        DiveComputer::PlanService service(serviceOptions);
+        if (!service.run()) {
+            std::cerr << "Cannot start the service: " << service.error() << "\n";
+            return 2;
+        }
+        return 0;
+    }
+
+    if (inputs.empty()) {
+        inputs.push_back("-");
+    }
+
+    if (runMode == RunMode::CLIENT) {
+        int result = 0;
+        for (const std::string& input : inputs) {
+            std::ifstream file;
+            if (input != "-") {
+                file.open(input);
+                if (!file.is_open()) {
+                    std::cerr << "Cannot open " << input << ": " << std::strerror(errno) << "\n";
+                    return 2;
+                }
+            }
+            std::istream& in = (input == "-") ? std::cin : file;
+            result = std::max(result, DiveComputer::runPlanClient(serviceOptions.m_socketPath, serviceOptions.m_tcpPort, in, std::cout));
+        }
+        return result;
+    }
+
+    // Read all specs first, so the plans can be shared between the threads
+    std::vector<DiveComputer::PlanSpec> specs;
+    for (const std::string& input : inputs) {
+        std::vector<DiveComputer::PlanSpec> fileSpecs;
+        if (input == "-") {
+            fileSpecs = DiveComputer::readPlanSpecs(std::cin, "stdin");
+        } else {
+            std::ifstream file(input);
+            if (!file.is_open()) {
+                std::cerr << "Cannot open " << input << ": " << std::strerror(errno) << "\n";
+                return 2;
+            }
+            fileSpecs = DiveComputer::readPlanSpecs(file, input);
+        }
+        specs.insert(specs.end(), std::make_move_iterator(fileSpecs.begin()), std::make_move_iterator(fileSpecs.end()));
+    }
+
+    std::string header = DiveComputer::batchHeader(format);
+    if (!header.empty()) {
+        std::cout << header << '\n';
+    }
+
+    DiveComputer::BatchPlanner planner(format, jobs);
+    int failed = planner.run(specs, std::cout);
+
+    if (failed > 0) {
+        std::cerr << failed << " of " << specs.size() << " plans failed\n";
+        return 1;
+    }
+    return 0;
+}
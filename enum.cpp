@@ -176,6 +176,47 @@ std::ostream& operator<<(std::ostream& os, const GasStatus& status) {
     return os;
 }
 
+std::string getLimitingGasString(LimitingGas gas) {
+    std::string limitingGasString;
+    switch(gas) {
+        case LimitingGas::N2:
+            limitingGasString = "N2";
+            break;
+        case LimitingGas::HE:
+            limitingGasString = "He";
+            break;
+        case LimitingGas::INERT:
+            limitingGasString = "Inert";
+            break;
+    }
+    return limitingGasString;
+}
+
+std::ostream& operator<<(std::ostream& os, const LimitingGas& gas) {
+    std::string limitingGasString = getLimitingGasString(gas);
+    os << limitingGasString;
+    return os;
+}
+
+std::string getWaterTypeString(WaterType type) {
+    std::string waterTypeString;
+    switch(type) {
+        case WaterType::SALT:
+            waterTypeString = "Salt";
+            break;
+        case WaterType::FRESH:
+            waterTypeString = "Fresh";
+            break;
+    }
+    return waterTypeString;
+}
+
+std::ostream& operator<<(std::ostream& os, const WaterType& type) {
+    std::string waterTypeString = getWaterTypeString(type);
+    os << waterTypeString;
+    return os;
+}
+
 
 
 } // namespace DiveComputer 
\ No newline at end of file
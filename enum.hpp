@@ -62,6 +62,25 @@ enum class GasStatus {
 std::string getGasStatusString(GasStatus status);
 std::ostream& operator<<(std::ostream& os, const GasStatus& status);
 
+// Gas of the M-value limiting a compartment
+enum class LimitingGas {
+    N2,
+    HE,
+    INERT,
+};
+
+std::string getLimitingGasString(LimitingGas gas);
+std::ostream& operator<<(std::ostream& os, const LimitingGas& gas);
+
+// Water of a dive site
+enum class WaterType {
+    SALT,
+    FRESH,
+};
+
+std::string getWaterTypeString(WaterType type);
+std::ostream& operator<<(std::ostream& os, const WaterType& type);
+
 } // namespace DiveComputer
 
 #endif
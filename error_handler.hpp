@@ -22,6 +22,12 @@ public:
     // Display error dialog with appropriate styling based on severity
     static void showErrorDialog(const QString& title, const QString& message, 
                                ErrorSeverity severity = ErrorSeverity::ERROR) {
+#ifdef DIVECOMPUTER_HEADLESS
+        // No windows: the error is logged by the caller
+        Q_UNUSED(title);
+        Q_UNUSED(message);
+        Q_UNUSED(severity);
+#else
         QMessageBox msgBox;
         msgBox.setWindowTitle(title);
         msgBox.setText(message);
@@ -42,6 +48,7 @@ public:
         }
         
         msgBox.exec();
+#endif
     }
     
     // Log error to console
@@ -0,0 +1,140 @@
+#ifndef FIXED_VECTOR_HPP
+#define FIXED_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace DiveComputer {
+
+// Vector holding at most N elements in place, for the embedded build of the core.
+// It has the part of the std::vector interface the core uses, never allocates and never
+// throws: an element added to a full vector is dropped and overflowed() is set until clear().
+template <typename T, size_t N>
+class FixedVector {
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    FixedVector() = default;
+    explicit FixedVector(size_t count) { resize(count); }
+    FixedVector(size_t count, const T& value) { resize(count, value); }
+
+    FixedVector(const FixedVector& other) { copyFrom(other); }
+    FixedVector& operator=(const FixedVector& other) {
+        if (this != &other) {
+            clear();
+            copyFrom(other);
+        }
+        return *this;
+    }
+    ~FixedVector() { clear(); }
+
+    // Capacity
+    size_t size() const { return m_size; }
+    bool   empty() const { return m_size == 0; }
+    bool   full() const { return m_size == N; }
+    bool   overflowed() const { return m_overflowed; }
+    static constexpr size_t capacity() { return N; }
+    static constexpr size_t max_size() { return N; }
+    void   reserve(size_t) {}
+
+    // Access
+    T*       data() { return reinterpret_cast<T*>(m_storage); }
+    const T* data() const { return reinterpret_cast<const T*>(m_storage); }
+    iterator       begin() { return data(); }
+    iterator       end() { return data() + m_size; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + m_size; }
+    T&       operator[](size_t index) { return data()[index]; }
+    const T& operator[](size_t index) const { return data()[index]; }
+    T&       front() { return data()[0]; }
+    const T& front() const { return data()[0]; }
+    T&       back() { return data()[m_size - 1]; }
+    const T& back() const { return data()[m_size - 1]; }
+
+    // Modifiers
+    void push_back(const T& value) {
+        if (full()) { m_overflowed = true; return; }
+        new (data() + m_size) T(value);
+        ++m_size;
+    }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args) {
+        if (full()) { m_overflowed = true; return; }
+        new (data() + m_size) T(std::forward<Args>(args)...);
+        ++m_size;
+    }
+
+    void pop_back() {
+        if (m_size > 0) data()[--m_size].~T();
+    }
+
+    iterator insert(const_iterator position, const T& value) {
+        size_t index = static_cast<size_t>(position - begin());
+        if (full()) { m_overflowed = true; return begin() + index; }
+
+        // The value may be an element of the vector
+        T copy(value);
+        if (index == m_size) {
+            new (data() + m_size) T(std::move(copy));
+        } else {
+            new (data() + m_size) T(std::move(back()));
+            std::move_backward(begin() + index, end() - 1, end());
+            data()[index] = std::move(copy);
+        }
+        ++m_size;
+        return begin() + index;
+    }
+
+    iterator erase(const_iterator position) {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        iterator target = begin() + (first - begin());
+        iterator source = begin() + (last - begin());
+        iterator newEnd = std::move(source, end(), target);
+        for (iterator it = newEnd; it != end(); ++it) it->~T();
+        m_size = static_cast<size_t>(newEnd - begin());
+        return target;
+    }
+
+    void resize(size_t count) {
+        if (count > N) { m_overflowed = true; count = N; }
+        while (m_size > count) pop_back();
+        while (m_size < count) new (data() + m_size++) T();
+    }
+
+    void resize(size_t count, const T& value) {
+        if (count > N) { m_overflowed = true; count = N; }
+        while (m_size > count) pop_back();
+        while (m_size < count) new (data() + m_size++) T(value);
+    }
+
+    void clear() {
+        while (m_size > 0) pop_back();
+        m_overflowed = false;
+    }
+
+private:
+    alignas(T) unsigned char m_storage[N * sizeof(T)];
+    size_t m_size{0};
+    bool   m_overflowed{false};
+
+    void copyFrom(const FixedVector& other) {
+        for (const T& value : other) new (data() + m_size++) T(value);
+        m_overflowed = other.m_overflowed;
+    }
+};
+
+} // namespace DiveComputer
+
+#endif // FIXED_VECTOR_HPP
@@ -2,12 +2,27 @@
 
 namespace DiveComputer {
 
+namespace {
+
+double maxPpO2ForType(GasType gasType) {
+    if (gasType == GasType::BOTTOM) {
+        return g_parameters.m_PpO2Active;
+    } else if (gasType == GasType::DECO) {
+        return g_parameters.m_PpO2Deco;
+    } else if (gasType == GasType::DILUENT) {
+        return g_parameters.m_maxPpO2Diluent;
+    }
+    return 0.0;
+}
+
+} // namespace
+
 Gas::Gas() { // Defaults to Air
     m_o2Percent = g_constants.m_oxygenInAir;
     m_hePercent = 0.0;
     m_gasType = GasType::BOTTOM;
     m_gasStatus = GasStatus::ACTIVE;
-    m_MOD = MOD(g_parameters.m_PpO2Active);
+    getMOD();
 }
 
 Gas::Gas(double o2Percent, double hePercent, GasType gasType, GasStatus gasStatus) {
@@ -15,28 +30,11 @@ Gas::Gas(double o2Percent, double hePercent, GasType gasType, GasStatus gasStatu
     m_hePercent = hePercent;
     m_gasType = gasType;
     m_gasStatus = gasStatus;
-
-    double maxppO2 = 0.0;
-    if (gasType == GasType::BOTTOM) {
-        maxppO2 = g_parameters.m_PpO2Active;
-    } else if (gasType == GasType::DECO) {
-        maxppO2 = g_parameters.m_PpO2Deco;
-    } else if (gasType == GasType::DILUENT) {
-        maxppO2 = g_parameters.m_maxPpO2Diluent;
-    }
-
-    m_MOD = MOD(maxppO2);
+    getMOD();
 }
 
 Gas Gas::bestGasForDepth(double depth, GasType gasType) {
-    double maxppO2 = 0.0;
-    if (gasType == GasType::BOTTOM) {
-        maxppO2 = g_parameters.m_PpO2Active;
-    } else if (gasType == GasType::DECO) {
-        maxppO2 = g_parameters.m_PpO2Deco;
-    } else if (gasType == GasType::DILUENT) {
-        maxppO2 = g_parameters.m_maxPpO2Diluent;
-    }
+    double maxppO2 = maxPpO2ForType(gasType);
 
     // Define O2 and He content of the gas
     double o2Percent = 100.0 * (maxppO2 / getPressureFromDepth(depth));
@@ -50,26 +48,48 @@ double Gas::MOD(double ppO2) const {
     return getDepthFromPressure(ppO2 / (m_o2Percent / 100.0));
 }
 
+double Gas::getMOD() const {
+    const DiveSite& site = currentDiveSite();
+    if (m_modEpoch != g_parameters.epoch() || m_modSurfacePressure != site.m_surfacePressure ||
+        m_modWaterType != site.m_waterType) {
+        m_MOD = MOD(maxPpO2ForType(m_gasType));
+        m_modEpoch = g_parameters.epoch();
+        m_modSurfacePressure = site.m_surfacePressure;
+        m_modWaterType = site.m_waterType;
+    }
+    return m_MOD;
+}
+
 double Gas::Density(double depth) const {
-    double density = getPressureFromDepth(depth) * 
+    return densityAtPressure(m_o2Percent, m_hePercent, getPressureFromDepth(depth));
+}
+
+double Gas::ENDWithoutO2(double depth) const {
+    return ENDWithoutO2AtPressure(m_o2Percent, m_hePercent, getPressureFromDepth(depth));
+}
+
+double Gas::ENDWithO2(double depth) const {
+    return ENDWithO2AtPressure(m_hePercent, getPressureFromDepth(depth));
+}
+
+double Gas::densityAtPressure(double o2Percent, double hePercent, double pAmb) {
+    double density = pAmb * 
                    (g_constants.m_tempStp / (g_parameters.m_tempMin + g_constants.m_tempStp)) * 
-                   (m_o2Percent / 100.0 * g_constants.m_o2Density + 
-                    m_hePercent / 100.0 * g_constants.m_heDensity + 
-                    (100 - m_o2Percent - m_hePercent) / 100.0 * g_constants.m_n2Density);
+                   (o2Percent / 100.0 * g_constants.m_o2Density + 
+                    hePercent / 100.0 * g_constants.m_heDensity + 
+                    (100 - o2Percent - hePercent) / 100.0 * g_constants.m_n2Density);
 
     return density;
 }
 
-double Gas::ENDWithoutO2(double depth) const {
-    double END = (((100 - m_o2Percent - m_hePercent) / 100.0) / (1.0 - g_constants.m_oxygenInAir / 100.0) * getPressureFromDepth(depth) - 
-                g_constants.m_atmPressureStp) * g_constants.m_meterPerBar;
+double Gas::ENDWithoutO2AtPressure(double o2Percent, double hePercent, double pAmb) {
+    double END = getDepthFromPressure(((100 - o2Percent - hePercent) / 100.0) / (1.0 - g_constants.m_oxygenInAir / 100.0) * pAmb);
     
     return std::max(END, 0.0);
 }
 
-double Gas::ENDWithO2(double depth) const {
-    double END = ((100 - m_hePercent) / 100.0 * getPressureFromDepth(depth) - 
-               g_constants.m_atmPressureStp) * g_constants.m_meterPerBar;
+double Gas::ENDWithO2AtPressure(double hePercent, double pAmb) {
+    double END = getDepthFromPressure((100 - hePercent) / 100.0 * pAmb);
 
     return std::max(END, 0.0);
 }
@@ -20,15 +20,25 @@ public:
     double    m_hePercent{0.0};
     GasType   m_gasType{};
     GasStatus m_gasStatus{};
-    double    m_MOD{0.0};
+    mutable double m_MOD{0.0};    // at the max ppO2 of the gas type, read through getMOD()
 
     // Methods
     static Gas bestGasForDepth(double depth, GasType gasType);
     double MOD(double ppO2) const;
+    double getMOD() const;    // m_MOD, derived again after a change of the parameters or of the dive site
     double Density(double depth) const;
     double ENDWithoutO2(double depth) const;
     double ENDWithO2(double depth) const;
 
+    // Same values for a mix at a given ambient pressure, without building a Gas
+    static double densityAtPressure(double o2Percent, double hePercent, double pAmb);
+    static double ENDWithoutO2AtPressure(double o2Percent, double hePercent, double pAmb);
+    static double ENDWithO2AtPressure(double hePercent, double pAmb);
+
+private:
+    mutable uint64_t m_modEpoch{0};    // parameters epoch and dive site m_MOD was derived at
+    mutable double m_modSurfacePressure{0.0};
+    mutable WaterType m_modWaterType{WaterType::SALT};
 };
 
 
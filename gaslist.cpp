@@ -5,10 +5,8 @@ namespace DiveComputer {
 // Define the global GasList instance
 GasList g_gasList;
 
+// Empty: the application loads the saved gas list once it has set up its paths
 GasList::GasList() {
-    // Ensure app info is set before any path operations
-    ensureAppInfoSet();
-    loadGaslistFromFile();
 }
 
 void GasList::addGas(double o2Percent, double hePercent, GasType gasType, GasStatus gasStatus) {
@@ -28,6 +26,7 @@ void GasList::clearGaslist() {
     m_gases.clear();
 }
 
+#ifndef DIVECOMPUTER_EMBEDDED
 bool GasList::loadGaslistFromFile() {
     const std::string filename = getFilePath(GASLIST_FILE_NAME);
     
@@ -52,7 +51,7 @@ bool GasList::loadGaslistFromFile() {
     return ErrorHandler::tryFileOperation([&]() {
         std::ifstream file(filename, std::ios::binary);
         if (!file.is_open()) {
-            logWrite("Failed to open gas list file for reading.");
+            logError("Failed to open gas list file for reading.");
         }
         
         // Clear the list, determine the number of gases and reserve space for them
@@ -74,7 +73,7 @@ bool GasList::loadGaslistFromFile() {
             file.read(reinterpret_cast<char*>(&gasStatus), sizeof(gasStatus));
             
             if (file.fail()) {
-                logWrite("Error reading gas data from file");
+                logError("Error reading gas data from file");
             }
             
             // Add the gas to our list
@@ -88,6 +87,9 @@ bool GasList::loadGaslistFromFile() {
 
 bool GasList::saveGaslistToFile() {
     const std::string filename = getFilePath(GASLIST_FILE_NAME);
+    if (filename.empty()) {
+        return false;    // no data directory to save to
+    }
     
     logWrite("Saving gas list to: ", filename);
     
@@ -98,7 +100,7 @@ bool GasList::saveGaslistToFile() {
         
         std::ofstream file(filename, std::ios::binary | std::ios::trunc);
         if (!file.is_open()) {
-            logWrite("Failed to open file for writing: ", filename);
+            logError("Failed to open file for writing: ", filename);
         }
     
         // First write the number of gases
@@ -106,7 +108,7 @@ bool GasList::saveGaslistToFile() {
         file.write(reinterpret_cast<const char*>(&gasCount), sizeof(gasCount));
         
         if (file.fail()) {
-            logWrite("Error writing gas count to file");
+            logError("Error writing gas count to file");
         }
         
         // Then write each gas
@@ -117,7 +119,7 @@ bool GasList::saveGaslistToFile() {
             file.write(reinterpret_cast<const char*>(&gas.m_gasStatus), sizeof(gas.m_gasStatus));
             
             if (file.fail()) {
-                logWrite("Error writing gas data to file");
+                logError("Error writing gas data to file");
             }
         }
     
@@ -134,8 +136,9 @@ bool GasList::saveGaslistToFile() {
         logWrite("Gas list saved successfully to ", filename, ". File size: ", std::filesystem::file_size(filename), " bytes");
     }, filename, "Error Saving Gas List");
 }
+#endif
 
-const std::vector<Gas>& GasList::getGases() const {
+const CoreVector<Gas, MAX_GASES>& GasList::getGases() const {
     return m_gases;
 }
 
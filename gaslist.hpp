@@ -1,14 +1,16 @@
 #ifndef GASLIST_HPP
 #define GASLIST_HPP
 
+#include "core_config.hpp"
+#ifndef DIVECOMPUTER_EMBEDDED
 #include "qtheaders.hpp"
-#include "log_info.hpp"
 #include "error_handler.hpp"
-#include "gas.hpp"
-#include <vector>
 #include <fstream>
 #include <filesystem>
 #include <memory>
+#endif
+#include "log_info.hpp"
+#include "gas.hpp"
 
 namespace DiveComputer {
 
@@ -29,6 +31,7 @@ public:
     // Clear entire gas list
     void clearGaslist();
     
+#ifndef DIVECOMPUTER_EMBEDDED
     // Load gas list from file
     bool loadGaslistFromFile();
     
@@ -37,12 +40,13 @@ public:
     
     // Print gas list (for debugging)
     void print();
+#endif
     
     // Getter for gases
-    const std::vector<Gas>& getGases() const;
+    const CoreVector<Gas, MAX_GASES>& getGases() const;
 
 private:
-    std::vector<Gas> m_gases;
+    CoreVector<Gas, MAX_GASES> m_gases;
 };
 
 // Declare global instance
@@ -179,19 +179,19 @@ void GasListWindow::addGasToTable(int row, const Gas& gas) {
     gasTable->setItem(row, COL_HE, heItem);
     
     // MOD (calculated value, non-editable)
-    QTableWidgetItem *modItem = TableHelper::createNumericCell(gas.m_MOD, 0, false);
+    QTableWidgetItem *modItem = TableHelper::createNumericCell(gas.getMOD(), 0, false);
     gasTable->setItem(row, COL_MOD, modItem);
     
     // END without O2 (calculated value, non-editable)
-    QTableWidgetItem *endNoO2Item = TableHelper::createNumericCell(gas.ENDWithoutO2(gas.m_MOD), 0, false);
+    QTableWidgetItem *endNoO2Item = TableHelper::createNumericCell(gas.ENDWithoutO2(gas.getMOD()), 0, false);
     gasTable->setItem(row, COL_END_NO_O2, endNoO2Item);
     
     // END with O2 (calculated value, non-editable)
-    QTableWidgetItem *endWithO2Item = TableHelper::createNumericCell(gas.ENDWithO2(gas.m_MOD), 0, false);
+    QTableWidgetItem *endWithO2Item = TableHelper::createNumericCell(gas.ENDWithO2(gas.getMOD()), 0, false);
     gasTable->setItem(row, COL_END_WITH_O2, endWithO2Item);
     
     // Gas density (calculated value, non-editable)
-    QTableWidgetItem *densityItem = TableHelper::createNumericCell(gas.Density(gas.m_MOD), 1, false);
+    QTableWidgetItem *densityItem = TableHelper::createNumericCell(gas.Density(gas.getMOD()), 1, false);
     gasTable->setItem(row, COL_DENSITY, densityItem);
 
     // Delete button
@@ -210,25 +210,25 @@ void GasListWindow::updateTableRow(int row) {
     // MOD
     QTableWidgetItem* modItem = gasTable->item(row, COL_MOD);
     if (modItem) {
-        modItem->setText(QString::number(gas.m_MOD, 'f', 0));
+        modItem->setText(QString::number(gas.getMOD(), 'f', 0));
     }
     
     // END without O2
     QTableWidgetItem* endNoO2Item = gasTable->item(row, COL_END_NO_O2);
     if (endNoO2Item) {
-        endNoO2Item->setText(QString::number(gas.ENDWithoutO2(gas.m_MOD), 'f', 0));
+        endNoO2Item->setText(QString::number(gas.ENDWithoutO2(gas.getMOD()), 'f', 0));
     }
     
     // END with O2
     QTableWidgetItem* endWithO2Item = gasTable->item(row, COL_END_WITH_O2);
     if (endWithO2Item) {
-        endWithO2Item->setText(QString::number(gas.ENDWithO2(gas.m_MOD), 'f', 0));
+        endWithO2Item->setText(QString::number(gas.ENDWithO2(gas.getMOD()), 'f', 0));
     }
     
     // Density
     QTableWidgetItem* densityItem = gasTable->item(row, COL_DENSITY);
     if (densityItem) {
-        densityItem->setText(QString::number(gas.Density(gas.m_MOD), 'f', 1));
+        densityItem->setText(QString::number(gas.Density(gas.getMOD()), 'f', 1));
     }
     
     // Highlight END cells
@@ -238,9 +238,9 @@ void GasListWindow::updateTableRow(int row) {
 void GasListWindow::highlightENDCells() {
     const auto& gases = g_gasList.getGases();
     for (int row = 0; row < gasTable->rowCount(); ++row) {
-        double endNoO2 = gases[row].ENDWithoutO2(gases[row].m_MOD);
-        double endWithO2 = gases[row].ENDWithO2(gases[row].m_MOD);
-        double density = gases[row].Density(gases[row].m_MOD);
+        double endNoO2 = gases[row].ENDWithoutO2(gases[row].getMOD());
+        double endWithO2 = gases[row].ENDWithO2(gases[row].getMOD());
+        double density = gases[row].Density(gases[row].getMOD());
         
         QTableWidgetItem* endNoO2Item = gasTable->item(row, COL_END_NO_O2);
         QTableWidgetItem* endWithO2Item = gasTable->item(row, COL_END_WITH_O2);
@@ -266,6 +266,7 @@ void GasListWindow::addNewGas() {
     
     // Save gas list to file
     g_gasList.saveGaslistToFile();
+    emit gasListChanged();
     
     // Refresh the table
     refreshGasTable();
@@ -289,6 +290,7 @@ void GasListWindow::addBestGas() {
     
     // Save gas list to file
     g_gasList.saveGaslistToFile();
+    emit gasListChanged();
     
     // Refresh the table
     refreshGasTable();
@@ -300,6 +302,7 @@ void GasListWindow::deleteGas(int row) {
         
         // Save gas list to file
         g_gasList.saveGaslistToFile();
+        emit gasListChanged();
         
         // Refresh the table
         refreshGasTable();
@@ -317,6 +320,7 @@ void GasListWindow::cellChanged(int row, int column) {
         
         // Save changes
         g_gasList.saveGaslistToFile();
+        emit gasListChanged();
     }
 }
 
@@ -338,6 +342,7 @@ void GasListWindow::gasTypeChanged(int row, int index) {
         
         // Save changes
         g_gasList.saveGaslistToFile();
+        emit gasListChanged();
     }
 }
 
@@ -356,6 +361,7 @@ void GasListWindow::gasStatusChanged(int row, int state) {
         
         // Save changes
         g_gasList.saveGaslistToFile();
+        emit gasListChanged();
     }
 }
 
@@ -17,6 +17,13 @@ class GasListWindow : public QMainWindow {
     
 public:
     GasListWindow(QWidget *parent = nullptr);
+
+signals:
+    // After each edit saved, for the plans using the gases
+    void gasListChanged();
+
+public slots:
+    void refreshGasTable();
     
 private:
     // Window size
@@ -30,7 +37,6 @@ private:
     
     // Setup functions
     void setupUI();
-    void refreshGasTable();
     void addGasToTable(int row, const Gas& gas);
     void updateTableRow(int row);
     void highlightENDCells();
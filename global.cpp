@@ -2,6 +2,8 @@
 
 namespace DiveComputer {
 
+#ifndef DIVECOMPUTER_EMBEDDED
+#ifndef DIVECOMPUTER_HEADLESS
 // Define the styles as constants
 const QString PLAIN_STYLE = "background-color: transparent; padding: 2px 5px; border: none;";
 const QString EDITABLE_STYLE = "background-color: rgba(100, 100, 100, 0.4); color: white; padding: 2px 5px; border: 1px solid #4aa0ff; border-radius: 3px;";
@@ -14,6 +16,7 @@ void applyEditableCellStyle(QTableWidgetItem* item) {
     item->setBackground(QColor(100, 100, 100, 102)); // 0.4 opacity
     item->setForeground(QColor(255, 255, 255));      // White text
 }
+#endif
 
 // Ensure app info is properly set for path resolution
 void ensureAppInfoSet() {
@@ -27,12 +30,29 @@ void ensureAppInfoSet() {
     }
 }
 
+// Set once at startup, before any file is read
+static std::string s_dataDirectory;
+
+void setDataDirectory(const std::string& directory) {
+    s_dataDirectory = directory;
+}
+
 std::string getFilePath(const std::string& filename) {
     // Ensure app info is set before getting the path
     ensureAppInfoSet();
     
     // Get application data location
-    QString dataLocation = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+#ifdef DIVECOMPUTER_HEADLESS
+    // Never the files of the desktop application: the callers keep the built-in defaults
+    if (s_dataDirectory.empty()) {
+        return std::string();
+    }
+    QString dataLocation = QString::fromStdString(s_dataDirectory);
+#else
+    QString dataLocation = s_dataDirectory.empty()
+        ? QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+        : QString::fromStdString(s_dataDirectory);
+#endif
     
     // Create directory if it doesn't exist
     QDir dir(dataLocation);
@@ -47,6 +67,7 @@ std::string getFilePath(const std::string& filename) {
     return fullPath.toStdString();
 }
 
+#ifndef DIVECOMPUTER_HEADLESS
 void setWindowSizeAndPosition(QWidget* window, int preferredWidth, int preferredHeight, WindowPosition position) {
     
     int margin = 10;
@@ -93,13 +114,17 @@ void setWindowSizeAndPosition(QWidget* window, int preferredWidth, int preferred
     // Move the window to the calculated position
     window->move(x, y);
 }
+#endif
+#endif
 
 double getDepthFromPressure(double pressure) {
-    return (pressure - g_constants.m_atmPressureStp) * g_constants.m_meterPerBar;
+    const DiveSite& site = currentDiveSite();
+    return (pressure - site.m_surfacePressure) * site.m_meterPerBar;
 }
 
 double getPressureFromDepth(double depth) {
-    return g_constants.m_atmPressureStp + (g_constants.m_barPerMeter * depth);
+    const DiveSite& site = currentDiveSite();
+    return site.m_surfacePressure + (site.m_barPerMeter * depth);
 }
 
 double getOptimalHeContent(double depth, double o2Content) {
@@ -129,20 +154,24 @@ double getSchreinerEquation(double p0, double halfTime, double pAmbStartDepth, d
     return pi + r * (time - 1/k) - (pi - p0 - r/k) * exp(-k * time);
 }
 
-double getGF(double depth, double firstDecoDepth) {
+double getGF(double depth, double firstDecoDepth, double gfLow, double gfHigh) {
     double gf;
 
     if (depth > firstDecoDepth) {
-        gf = g_parameters.m_gf[0];
+        gf = gfLow;
+    } else if (firstDecoDepth <= g_parameters.m_lastStopDepth) {
+        // First deco stop at the last stop: no slope, GF high once above it
+        gf = (depth < firstDecoDepth) ? gfHigh : gfLow;
     } else {
-        gf = std::min(g_parameters.m_gf[1], 
-                g_parameters.m_gf[0] + (g_parameters.m_gf[1] - g_parameters.m_gf[0]) * 
+        gf = std::min(gfHigh, 
+                gfLow + (gfHigh - gfLow) * 
                 (depth - firstDecoDepth) / (g_parameters.m_lastStopDepth - firstDecoDepth));
     }
 
     return gf;
 }
 
+#ifndef DIVECOMPUTER_EMBEDDED
 double getDouble(const std::string& prompt) {
     double result;
     bool validInput = false;
@@ -158,7 +187,7 @@ double getDouble(const std::string& prompt) {
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         } else {
             // Input is not valid
-            logWrite("Invalid input. Please enter a valid decimal number.");
+            logWarning("Invalid input. Please enter a valid decimal number.");
             
             // Clear the error state
             std::cin.clear();
@@ -171,4 +200,6 @@ double getDouble(const std::string& prompt) {
     return result;
 }
 
+#endif
+
 }
\ No newline at end of file
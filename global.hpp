@@ -1,11 +1,19 @@
 #ifndef GLOBAL_HPP
 #define GLOBAL_HPP
 
+#include "core_config.hpp"
+#ifndef DIVECOMPUTER_EMBEDDED
 #include "qtheaders.hpp"
+#endif
 #include "log_info.hpp"
 #include "constants.hpp"
 #include "parameters.hpp"
 #include "enum.hpp"
+#include "dive_site.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifndef DIVECOMPUTER_EMBEDDED
 #include <fstream>
 #include <filesystem>
 #include <string>
@@ -15,35 +23,49 @@
 #include <sstream>
 #include <cstdarg>  // For variable arguments
 #include <vector>   // For the buffer
+#endif
 
 namespace DiveComputer {
+#ifndef DIVECOMPUTER_EMBEDDED
     const std::string PARAMETERS_FILE_NAME = "parameters.dat";
     const std::string GASLIST_FILE_NAME = "gaslist.dat";
     const std::string SETPOINTS_FILE_NAME = "setpoints.dat";
+    const std::string PLAN_LIBRARY_FILE_NAME = "plan_library.dat";
     const std::string LOGO_FILE_NAME = "logo.png";
     const int COLUMN_WIDTH = 215;
 
+#ifndef DIVECOMPUTER_HEADLESS
     // Style constants for consistent UI
     extern const QString PLAIN_STYLE;
     extern const QString EDITABLE_STYLE;
     
     // Styling function
     void applyEditableCellStyle(QTableWidgetItem* item);
+#endif
 
     // File functions
     void   ensureAppInfoSet();
     std::string getFilePath(const std::string& filename);
 
+    // Use this directory instead of the standard application data location. Without the
+    // windows there is none: getFilePath returns an empty path until this is called.
+    void   setDataDirectory(const std::string& directory);
+
+#ifndef DIVECOMPUTER_HEADLESS
     // UI Window functions
     void setWindowSizeAndPosition(QWidget* window, int preferredWidth, int preferredHeight, WindowPosition position);
+#endif
+
+    // Console input
+    double getDouble(const std::string& prompt);
+#endif
 
-    // Diving-dedicated standard functions
+    // Diving-dedicated standard functions, at the current dive site
     double getDepthFromPressure(double pressure);
     double getPressureFromDepth(double depth);
     double getOptimalHeContent(double depth, double o2Content);
     double getSchreinerEquation(double p0, double halfTime, double pAmbStartDepth, double pAmbEndDepth, double time, double inertPercent);
-    double getGF(double depth, double firstDecoDepth);
-    double getDouble(const std::string& prompt);
+    double getGF(double depth, double firstDecoDepth, double gfLow, double gfHigh);
 }
 
 
@@ -0,0 +1,50 @@
+#ifndef LOD_LEVELS_HPP
+#define LOD_LEVELS_HPP
+
+#include <algorithm>
+
+namespace DiveComputer {
+
+// Levels of a min/max decimation pyramid are not decimated below this number of points
+constexpr int LOD_MIN_LEVEL_POINTS = 512;
+
+// Run time between the states a graph against time takes between the adaptive samples of a
+// dive, and their maximum number: the series of a dive of an hour has about 3600 points
+constexpr double LOD_DENSE_INTERVAL = 1.0 / 60.0;    // min
+constexpr int LOD_MAX_DENSE_SAMPLES = 4096;
+
+inline double lodDenseInterval(double duration) {
+    return std::max(LOD_DENSE_INTERVAL, duration / LOD_MAX_DENSE_SAMPLES);
+}
+
+// Next level of a min/max pyramid over points sorted by key: the lowest and the highest point
+// of every 4 points of the level below, in key order, and once when the 4 are flat.
+// Points is a std::vector or a QVector, valueOf returns the value of a point.
+template <typename Points, typename ValueOf>
+Points decimateMinMax(const Points& below, ValueOf valueOf) {
+    const int size = static_cast<int>(below.size());
+    Points level;
+    level.reserve(size / 2 + 2);
+
+    for (int i = 0; i < size; i += 4) {
+        int last = std::min(i + 4, size);
+        int low = i;
+        int high = i;
+        for (int k = i; k < last; k++) {
+            if (valueOf(below[k]) < valueOf(below[low])) low = k;
+            if (valueOf(below[k]) > valueOf(below[high])) high = k;
+        }
+
+        if (low == high) {
+            level.push_back(below[low]);
+        } else {
+            level.push_back(below[std::min(low, high)]);
+            level.push_back(below[std::max(low, high)]);
+        }
+    }
+    return level;
+}
+
+} // namespace DiveComputer
+
+#endif // LOD_LEVELS_HPP
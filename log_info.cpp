@@ -4,44 +4,338 @@
 #include <fstream>
 #include <chrono>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <zlib.h>
 
 namespace DiveComputer {
 
+// The writer thread can start during static initialization, before LOG_FILE_NAME is constructed
+constexpr const char* LOG_FILE_LITERAL = "divelog.txt";
+
 // Initialize the constant
-const std::string LOG_FILE_NAME = "divelog.txt";
+const std::string LOG_FILE_NAME = LOG_FILE_LITERAL;
 
-void logWrite(const std::string& message) {
-    // Ensure app info is set for proper path resolution
-    ensureAppInfoSet();
-    
-    // Get the current time
+namespace {
+
+// Set once the writer is destroyed at exit: later messages only go to the console
+std::atomic<bool> s_writerClosed{false};
+
+// Set when there is no output at all, so messages are dropped before being queued
+std::atomic<bool> s_logDisabled{false};
+
+std::string timestamp() {
     auto now = std::chrono::system_clock::now();
     std::time_t time = std::chrono::system_clock::to_time_t(now);
-    
-    // Format the timestamp
+
+    std::tm localTime{};
+    #ifdef _WIN32
+        localtime_s(&localTime, &time);
+    #else
+        localtime_r(&time, &localTime);
+    #endif
+
     char timeBuffer[30];
-    std::strftime(timeBuffer, sizeof(timeBuffer), "[%Y-%m-%d %H:%M:%S]", std::localtime(&time));
-    
+    std::strftime(timeBuffer, sizeof(timeBuffer), "[%Y-%m-%d %H:%M:%S]", &localTime);
+    return timeBuffer;
+}
+
+// Background writer of the log file.
+// logWrite only queues the line; the console, the file and rotation are handled by
+// the writer thread, which hands the rotated segments to a compression thread so
+// gzipping a large log never delays the lines queued behind it.
+class LogWriter {
+public:
+    static LogWriter& instance() {
+        static LogWriter writer;
+        return writer;
+    }
+
+    void push(std::string entry) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(entry));
+        }
+        m_wake.notify_one();
+    }
+
+    void setRotation(uint64_t maxBytes, int maxFiles) {
+        m_maxBytes = maxBytes;
+        m_maxFiles = maxFiles;
+    }
+
+    void setOutputs(LogConsole console, bool toFile) {
+        m_console = console;
+        m_toFile = toFile;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::string> m_queue;
+    bool m_stop = false;
+
+    // Rotated segments waiting to be gzipped into the first archive, oldest first
+    std::mutex m_compressMutex;
+    std::condition_variable m_compressWake;
+    std::deque<std::filesystem::path> m_segments;
+    bool m_compressStop = false;
+
+    std::atomic<uint64_t> m_maxBytes{10ull * 1024 * 1024};
+    std::atomic<int> m_maxFiles{5};
+    std::atomic<LogConsole> m_console{LogConsole::STDOUT};
+    std::atomic<bool> m_toFile{true};
+
+    // Only used by the writer thread
+    std::filesystem::path m_path;
+    std::ofstream m_file;
+    uint64_t m_size = 0;
+    bool m_fileStarted = false;
+    int m_segmentCount = 0;
+
+    std::thread m_thread;
+    std::thread m_compressThread;
+
+    LogWriter() {
+        // Started last: the thread may log through instance() while resolving the path
+        m_compressThread = std::thread(&LogWriter::runCompression, this);
+        m_thread = std::thread(&LogWriter::run, this);
+    }
+
+    ~LogWriter() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+
+        // The segments rotated last are still compressed before exit
+        {
+            std::lock_guard<std::mutex> lock(m_compressMutex);
+            m_compressStop = true;
+        }
+        m_compressWake.notify_one();
+        m_compressThread.join();
+        s_writerClosed = true;
+    }
+
+    void run() {
+        std::deque<std::string> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+                if (m_queue.empty() && m_stop) break;
+                batch.swap(m_queue);
+            }
+
+            // The file is only resolved when first needed, so processes without a
+            // log file never touch the application data location
+            if (m_toFile && !m_fileStarted) {
+                startFile();
+            }
+
+            writeBatch(batch);
+            batch.clear();
+
+            uint64_t maxBytes = m_maxBytes;
+            if (m_file.is_open() && maxBytes > 0 && m_size >= maxBytes) {
+                m_file.close();
+                archiveCurrentFile();
+                openFile();
+            }
+        }
+    }
+
+    void startFile() {
+        m_fileStarted = true;
+        m_path = getFilePath(LOG_FILE_LITERAL);
+
+        // Keep the previous session instead of overwriting it
+        std::error_code ec;
+        if (std::filesystem::exists(m_path, ec) && std::filesystem::file_size(m_path, ec) > 0) {
+            archiveCurrentFile();
+        }
+        openFile();
+    }
+
+    void openFile() {
+        m_file.open(m_path, std::ios::app | std::ios::binary);
+        std::error_code ec;
+        m_size = std::filesystem::file_size(m_path, ec);
+        if (ec) m_size = 0;
+        if (!m_file.is_open()) {
+            std::cerr << timestamp() << " [ERROR] Could not open log file at: " << m_path.string() << std::endl;
+        }
+    }
+
+    void writeBatch(const std::deque<std::string>& batch) {
+        LogConsole console = m_console;
+        std::ostream* out = (console == LogConsole::STDOUT) ? &std::cout :
+                            (console == LogConsole::STDERR) ? &std::cerr : nullptr;
+        bool toFile = m_toFile && m_file.is_open();
+
+        for (const std::string& entry : batch) {
+            if (out) {
+                *out << entry << '\n';
+            }
+            if (toFile) {
+                m_file << entry << '\n';
+                m_size += entry.size() + 1;
+            }
+        }
+        if (out) out->flush();
+        if (toFile) m_file.flush();
+    }
+
+    // divelog.1.txt.gz is the most recent archive
+    std::filesystem::path archivePath(int number) const {
+        std::filesystem::path path = m_path;
+        path.replace_filename(m_path.stem().string() + "." + std::to_string(number) +
+                              m_path.extension().string() + ".gz");
+        return path;
+    }
+
+    // Move the closed log file aside and queue it for compression into the first archive
+    void archiveCurrentFile() {
+        std::error_code ec;
+        if (m_maxFiles <= 0) {
+            std::filesystem::remove(m_path, ec);
+            return;
+        }
+
+        // Free the log name first so the new file can be opened right away
+        std::filesystem::path segment = m_path;
+        segment += "." + std::to_string(++m_segmentCount) + ".rotated";
+        std::filesystem::rename(m_path, segment, ec);
+        if (ec) {
+            std::cerr << timestamp() << " [ERROR] Could not rotate log file: " << ec.message() << std::endl;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_compressMutex);
+            m_segments.push_back(std::move(segment));
+        }
+        m_compressWake.notify_one();
+    }
+
+    // Compression thread: shifts the archives and gzips the segments in rotation order
+    void runCompression() {
+        while (true) {
+            std::filesystem::path segment;
+            {
+                std::unique_lock<std::mutex> lock(m_compressMutex);
+                m_compressWake.wait(lock, [this] { return m_compressStop || !m_segments.empty(); });
+                if (m_segments.empty() && m_compressStop) break;
+                segment = std::move(m_segments.front());
+                m_segments.pop_front();
+            }
+            shiftArchives();
+            compressSegment(segment, archivePath(1));
+        }
+    }
+
+    // Drop the oldest archive and renumber the others to free the first one
+    void shiftArchives() {
+        std::error_code ec;
+        int maxFiles = std::max(1, m_maxFiles.load());
+
+        std::filesystem::remove(archivePath(maxFiles), ec);
+        for (int i = maxFiles - 1; i >= 1; --i) {
+            if (std::filesystem::exists(archivePath(i), ec)) {
+                std::filesystem::rename(archivePath(i), archivePath(i + 1), ec);
+            }
+        }
+    }
+
+    void compressSegment(const std::filesystem::path& segment, const std::filesystem::path& archive) {
+        std::error_code ec;
+        std::filesystem::path temp = archive;
+        temp += ".tmp";
+
+        // Standard gzip stream, readable with gunzip or zcat
+        bool ok = false;
+        std::ifstream in(segment, std::ios::binary);
+        gzFile out = in.is_open() ? gzopen(temp.string().c_str(), "wb") : nullptr;
+        if (out) {
+            ok = true;
+            char buffer[64 * 1024];
+            while (ok && in) {
+                in.read(buffer, sizeof(buffer));
+                std::streamsize count = in.gcount();
+                if (count > 0 && gzwrite(out, buffer, static_cast<unsigned>(count)) != count) {
+                    ok = false;
+                }
+            }
+            ok = (gzclose(out) == Z_OK) && ok && in.eof();
+        }
+        in.close();
+
+        if (ok) {
+            std::filesystem::rename(temp, archive, ec);
+        }
+        if (!ok || ec) {
+            // Keep the plain segment rather than losing it
+            std::cerr << timestamp() << " [ERROR] Could not compress log archive: " << archive.string() << std::endl;
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+        std::filesystem::remove(segment, ec);
+    }
+};
+
+} // namespace
+
+void logWrite(const std::string& message) {
+    if (s_logDisabled) return;
+
+    // Ensure app info is set for proper path resolution
+    ensureAppInfoSet();
+
     // Combine timestamp and message
-    std::string logEntry = std::string(timeBuffer) + " " + message;
-    
-    // Print to console
-    std::cout << logEntry << std::endl;
-    
-    // Get the log file path
-    std::string logFilePath = getFilePath(LOG_FILE_NAME);
-    
-    // Open the file in append mode
-    std::ofstream logFile(logFilePath, std::ios::app);
-    
-    if (logFile.is_open()) {
-        // Write to the log file
-        logFile << logEntry << std::endl;
-        logFile.close();
-    } else {
-        // If we can't open the log file, at least print an error to the console
-        std::cerr << timeBuffer << " [ERROR] Could not open log file at: " << logFilePath << std::endl;
+    std::string logEntry = timestamp() + " " + message;
+
+    if (s_writerClosed) {
+        std::cerr << logEntry << std::endl;
+        return;
     }
+
+    // Written to the console and the log file by the writer thread
+    LogWriter::instance().push(std::move(logEntry));
+}
+
+void logWrite(LogSeverity severity, const std::string& message) {
+    switch (severity) {
+        case LogSeverity::WARNING:
+            logWrite("[WARNING] " + message);
+            break;
+        case LogSeverity::ERROR:
+            logWrite("[ERROR] " + message);
+            break;
+        case LogSeverity::INFO:
+        default:
+            logWrite(message);
+            break;
+    }
+}
+
+void logSetRotation(double maxFileSizeMB, int maxFiles) {
+    if (s_writerClosed) return;
+    LogWriter::instance().setRotation(static_cast<uint64_t>(std::max(0.0, maxFileSizeMB) * 1024 * 1024),
+                                      std::max(0, maxFiles));
+}
+
+void logSetOutputs(LogConsole console, bool toFile) {
+    s_logDisabled = (console == LogConsole::NONE && !toFile);
+    if (s_writerClosed || s_logDisabled) return;
+    LogWriter::instance().setOutputs(console, toFile);
 }
 
 void logClear() {
@@ -54,28 +348,8 @@ void logClear() {
         system("clear");
     #endif
 
-    // Delete log file
-    std::string logFilePath = getFilePath(LOG_FILE_NAME);
-    
-    // First, check if file exists
-    std::ifstream fileCheck(logFilePath);
-    if (fileCheck.good()) {
-        fileCheck.close();
-        
-        // Delete the file
-        if (std::remove(logFilePath.c_str()) == 0) {
-            logWrite("Log file cleared successfully.");
-        } else {
-            logWrite("Error: could not delete log file at: ", logFilePath);
-        }
-    }
-    
-    // Create a new, empty log file
-    std::ofstream newFile(logFilePath);
-    if (newFile.is_open()) {
-        logWrite("Log started");
-        newFile.close();
-    }
+    // The log of the previous session is archived when the writer starts
+    logWrite("Log started");
 }
 
-} // namespace DiveComputer
\ No newline at end of file
+} // namespace DiveComputer
@@ -1,6 +1,25 @@
 #ifndef LOG_INFO_HPP
 #define LOG_INFO_HPP
 
+#ifdef DIVECOMPUTER_EMBEDDED
+
+// The embedded build has no log: messages are dropped without being formatted
+namespace DiveComputer {
+    template<typename... Args>
+    inline void logWrite(const Args&...) {}
+
+    template<typename... Args>
+    inline void logWriteF(const char*, const Args&...) {}
+
+    template<typename... Args>
+    inline void logWarning(const Args&...) {}
+
+    template<typename... Args>
+    inline void logError(const Args&...) {}
+}
+
+#else
+
 #include <string>
 #include <vector>
 #include <cstdio>
@@ -18,6 +37,28 @@ namespace DiveComputer {
     void logWrite(const std::string& message);
     void logClear();
 
+    // Severity of a message, written after the timestamp as [WARNING] or [ERROR] for the
+    // log viewer to filter on; information has no tag
+    enum class LogSeverity {
+        INFO,
+        WARNING,
+        ERROR
+    };
+    void logWrite(LogSeverity severity, const std::string& message);
+
+    // Rotate the log file once it reaches maxFileSizeMB (0 for no limit),
+    // keeping at most maxFiles compressed archives next to it
+    void logSetRotation(double maxFileSizeMB, int maxFiles);
+
+    // Where log lines go; the console is stdout and the file is written by default.
+    // Must be set before the first message to keep a process from creating the log file.
+    enum class LogConsole {
+        NONE,
+        STDOUT,
+        STDERR
+    };
+    void logSetOutputs(LogConsole console, bool toFile);
+
     // Alternative that handles any type that can be converted to string using stringstream
     template<typename T>
     void logWrite(const T& value) {
@@ -55,6 +96,21 @@ namespace DiveComputer {
         logWrite(message, args...);
     }
 
+    // Warnings and errors, built from their values like the messages of logWrite
+    template<typename... Args>
+    void logWarning(const Args&... args) {
+        std::stringstream ss;
+        (ss << ... << args);
+        logWrite(LogSeverity::WARNING, ss.str());
+    }
+
+    template<typename... Args>
+    void logError(const Args&... args) {
+        std::stringstream ss;
+        (ss << ... << args);
+        logWrite(LogSeverity::ERROR, ss.str());
+    }
+
     // Format strings with printf-style formatting
     template<typename... Args>
     void logWriteF(const std::string& format, Args... args) {
@@ -71,4 +127,6 @@ namespace DiveComputer {
     }
 }
 
+#endif // DIVECOMPUTER_EMBEDDED
+
 #endif // LOG_INFO_HPP
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "log_info_gui.hpp"
+#include <QStringView>
 
 namespace DiveComputer {
 
@@ -25,18 +26,35 @@ LogViewerWindow::LogViewerWindow(QWidget *parent) : QMainWindow(parent) {
     // Create buttons
     m_refreshButton = new QPushButton("Refresh", this);
     m_downloadButton = new QPushButton("Download", this);
+
+    // Level filter and search
+    m_levelCombo = new QComboBox(this);
+    m_levelCombo->addItem("All levels", -1);
+    m_levelCombo->addItem("Timings", static_cast<int>(LogLevel::TIMING));
+    m_levelCombo->addItem("Warnings and errors", static_cast<int>(LogLevel::WARNING));
+    m_levelCombo->addItem("Errors", static_cast<int>(LogLevel::ERROR));
+
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText("Search (regular expression)");
+    m_searchEdit->setClearButtonEnabled(true);
+
+    m_countLabel = new QLabel(this);
     
     // Add buttons to layout
     buttonLayout->addWidget(m_refreshButton);
     buttonLayout->addWidget(m_downloadButton);
-    buttonLayout->addStretch(); // Push buttons to the left
+    buttonLayout->addWidget(m_levelCombo);
+    buttonLayout->addWidget(m_searchEdit, 1);
+    buttonLayout->addWidget(m_countLabel);
     
     // Add button layout to main layout
     mainLayout->addLayout(buttonLayout);
     
-    // Create text edit for log display
-    m_logTextEdit = new QTextEdit(this);
+    // Create text view for log display, bounded to the lines of the ring
+    m_logTextEdit = new QPlainTextEdit(this);
     m_logTextEdit->setReadOnly(true); // Make it read-only
+    m_logTextEdit->setMaximumBlockCount(MAX_LOG_LINES);
+    m_logTextEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
     QFont monoFont = QFontDatabase::systemFont(QFontDatabase::FixedFont);
     monoFont.setPointSize(10);
     m_logTextEdit->setFont(monoFont);
@@ -47,6 +65,14 @@ LogViewerWindow::LogViewerWindow(QWidget *parent) : QMainWindow(parent) {
     // Connect signals and slots
     connect(m_refreshButton, &QPushButton::clicked, this, &LogViewerWindow::refreshLog);
     connect(m_downloadButton, &QPushButton::clicked, this, &LogViewerWindow::downloadLog);
+    connect(m_levelCombo, qOverload<int>(&QComboBox::currentIndexChanged), this, &LogViewerWindow::filterChanged);
+    connect(m_searchEdit, &QLineEdit::textChanged, this, &LogViewerWindow::filterChanged);
+
+    // Follow the end of the file
+    m_pollTimer = new QTimer(this);
+    m_pollTimer->setInterval(POLL_INTERVAL_MS);
+    connect(m_pollTimer, &QTimer::timeout, this, &LogViewerWindow::refreshLog);
+    m_pollTimer->start();
     
     // Load log content initially
     loadLogContent();
@@ -58,49 +84,171 @@ LogViewerWindow::~LogViewerWindow() {
     emit windowClosed();
 }
 
+// Read what was appended to the log since the last call
+// Nothing is logged from here: the viewer would keep feeding the file it follows
 void LogViewerWindow::loadLogContent() {
     // Get the log file path
     std::string logFilePath = getFilePath(LOG_FILE_NAME);
     
-    // Clear the text edit
-    m_logTextEdit->clear();
-    
-    // Try to open and read the log file
     QFile logFile(QString::fromStdString(logFilePath));
-    if (logFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        // Read all content
-        QTextStream in(&logFile);
-        QString logContent = in.readAll();
-        
-        // Set the content to the text edit
-        m_logTextEdit->setPlainText(logContent);
-        
-        // Scroll to the bottom to show most recent entries
-        QTextCursor cursor = m_logTextEdit->textCursor();
-        cursor.movePosition(QTextCursor::End);
-        m_logTextEdit->setTextCursor(cursor);
-        
-        // Close the file
-        logFile.close();
-        
-        // Log the action
-        logWrite("Log file loaded for viewing");
-    } else {
-        // Display error message if file couldn't be opened
+    if (!logFile.open(QIODevice::ReadOnly)) {
+        resetLog();
         m_logTextEdit->setPlainText("Error: Could not open log file at " + 
                                    QString::fromStdString(logFilePath));
-        
-        // Log the error
-        logWrite("Error opening log file for viewing: ", logFilePath);
+        return;
+    }
+
+    // The log was cleared or replaced: start over
+    qint64 size = logFile.size();
+    if (size < m_offset) {
+        resetLog();
+    }
+
+    // First read of a large log: only its tail, from the next line start
+    bool skipFirstLine = false;
+    if (m_offset == 0 && size > INITIAL_TAIL_BYTES) {
+        m_offset = size - INITIAL_TAIL_BYTES;
+        skipFirstLine = true;
     }
+
+    if (size == m_offset) {
+        return;
+    }
+
+    logFile.seek(m_offset);
+    QByteArray data = m_partialLine + logFile.read(size - m_offset);
+    m_offset = size;
+    logFile.close();
+
+    if (skipFirstLine) {
+        int firstEnd = data.indexOf('\n');
+        data = (firstEnd < 0) ? QByteArray() : data.mid(firstEnd + 1);
+    }
+
+    // Keep an unterminated last line for the next read
+    int lastEnd = data.lastIndexOf('\n');
+    m_partialLine = data.mid(lastEnd + 1);
+    data.truncate(lastEnd + 1);
+
+    std::vector<LogLine> lines;
+    for (const QByteArray& raw : data.split('\n')) {
+        if (raw.isEmpty()) continue;
+        QString text = QString::fromUtf8(raw);
+        lines.push_back(LogLine{text, levelOf(text)});
+    }
+    appendLines(lines);
+}
+
+void LogViewerWindow::resetLog() {
+    m_lines.clear();
+    m_offset = 0;
+    m_partialLine.clear();
+    m_logTextEdit->clear();
+    updateCountLabel();
+}
+
+void LogViewerWindow::appendLines(const std::vector<LogLine>& lines) {
+    if (lines.empty()) return;
+
+    // Follow the end only if the view was already there
+    QScrollBar* scrollBar = m_logTextEdit->verticalScrollBar();
+    bool atEnd = scrollBar->value() == scrollBar->maximum();
+
+    // Bounded ring of lines; the view drops its oldest blocks by itself
+    QStringList visible;
+    for (const LogLine& line : lines) {
+        m_lines.push_back(line);
+        if (isLineVisible(line)) visible.append(line.m_text);
+    }
+    while (m_lines.size() > static_cast<size_t>(MAX_LOG_LINES)) {
+        m_lines.pop_front();
+    }
+
+    if (!visible.isEmpty()) {
+        m_logTextEdit->appendPlainText(visible.join('\n'));
+        if (atEnd) scrollBar->setValue(scrollBar->maximum());
+    }
+    updateCountLabel();
+}
+
+LogLevel LogViewerWindow::levelOf(const QString& text) {
+    // "[timestamp] [ERROR] message", as written by logWrite; untagged messages are information
+    int messageStart = text.indexOf("] ");
+    QStringView message = QStringView(text).mid(messageStart < 0 ? 0 : messageStart + 2);
+
+    if (message.startsWith(QLatin1String("[ERROR]"))) {
+        return LogLevel::ERROR;
+    }
+    if (message.startsWith(QLatin1String("[WARNING]"))) {
+        return LogLevel::WARNING;
+    }
+    if (message.contains(QLatin1String(" took ")) && message.contains(QLatin1String(" ms"))) {
+        return LogLevel::TIMING;
+    }
+    return LogLevel::INFO;
+}
+
+bool LogViewerWindow::isLineVisible(const LogLine& line) const {
+    if (m_levelFilter >= 0) {
+        // Timings are shown on their own, warnings and errors from the selected level up
+        if (static_cast<LogLevel>(m_levelFilter) == LogLevel::TIMING) {
+            if (line.m_level != LogLevel::TIMING) return false;
+        } else if (line.m_level < static_cast<LogLevel>(m_levelFilter)) {
+            return false;
+        }
+    }
+    return matchesSearch(line);
+}
+
+bool LogViewerWindow::matchesSearch(const LogLine& line) const {
+    if (m_searchExpression.pattern().isEmpty() || !m_searchExpression.isValid()) {
+        return true;
+    }
+
+    // The expression runs once per line and search text, and only on lines the level lets through
+    if (line.m_searchRevision != m_searchRevision) {
+        line.m_matches = m_searchExpression.match(line.m_text).hasMatch();
+        line.m_searchRevision = m_searchRevision;
+    }
+    return line.m_matches;
+}
+
+void LogViewerWindow::rebuildView() {
+    QStringList visible;
+    for (const LogLine& line : m_lines) {
+        if (isLineVisible(line)) visible.append(line.m_text);
+    }
+    m_logTextEdit->setPlainText(visible.join('\n'));
+
+    QScrollBar* scrollBar = m_logTextEdit->verticalScrollBar();
+    scrollBar->setValue(scrollBar->maximum());
+    updateCountLabel();
+}
+
+void LogViewerWindow::updateCountLabel() {
+    // An empty document still holds one block
+    int shown = m_logTextEdit->document()->isEmpty() ? 0 : m_logTextEdit->document()->blockCount();
+    m_countLabel->setText(QString("%1 / %2 lines").arg(shown).arg(m_lines.size()));
+}
+
+void LogViewerWindow::filterChanged() {
+    m_levelFilter = m_levelCombo->currentData().toInt();
+
+    // A new search text invalidates the results kept on the lines
+    if (m_searchEdit->text() != m_searchText) {
+        m_searchText = m_searchEdit->text();
+        m_searchExpression = QRegularExpression(m_searchText, QRegularExpression::CaseInsensitiveOption);
+        m_searchRevision++;
+
+        // Mark an invalid expression instead of filtering everything out
+        m_searchEdit->setStyleSheet(m_searchExpression.isValid() ? QString() : QString("border: 1px solid red;"));
+    }
+    rebuildView();
 }
 
 void LogViewerWindow::refreshLog() {
-    // Simply reload the log content
+    // Read only what was appended since the last read
     loadLogContent();
-    
-    // Log the action
-    logWrite("Log view refreshed");
 }
 
 void LogViewerWindow::downloadLog() {
@@ -146,7 +294,7 @@ void LogViewerWindow::downloadLog() {
                 );
                 
                 // Log the error
-                logWrite("Error saving log file: ", sourceFile.errorString().toStdString());
+                logError("Error saving log file: ", sourceFile.errorString().toStdString());
             }
         } else {
             // Show error message
@@ -157,7 +305,7 @@ void LogViewerWindow::downloadLog() {
             );
             
             // Log the error
-            logWrite("Error: Source log file does not exist at ", logFilePath);
+            logError("Source log file does not exist at ", logFilePath);
         }
     }
 }
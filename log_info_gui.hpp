@@ -1,12 +1,30 @@
 #ifndef LOG_INFO_GUI_HPP
 #define LOG_INFO_GUI_HPP
 
+#include <deque>
 #include "qtheaders.hpp"
 #include "log_info.hpp"
 #include "global.hpp"
 
 namespace DiveComputer {
 
+// Level of a log line, from the severity tag logWrite puts after the timestamp
+enum class LogLevel {
+    INFO,
+    TIMING,
+    WARNING,
+    ERROR
+};
+
+struct LogLine {
+    QString  m_text;
+    LogLevel m_level;
+
+    // Search result, valid while m_searchRevision matches the window's
+    mutable bool m_matches = false;
+    mutable int  m_searchRevision = -1;
+};
+
 class LogViewerWindow : public QMainWindow {
     Q_OBJECT
 
@@ -21,21 +39,49 @@ private:
     // Window size
     const int WindowWidth = 800;
     const int WindowHeight = 600;
-    
+
+    // Tail settings
+    static constexpr int    MAX_LOG_LINES = 20000;             // lines kept in the ring
+    static constexpr qint64 INITIAL_TAIL_BYTES = 2 * 1024 * 1024; // read when opening a large log
+    static constexpr int    POLL_INTERVAL_MS = 1000;
+
     // UI components
-    QTextEdit* m_logTextEdit;
+    QPlainTextEdit* m_logTextEdit;
     QPushButton* m_refreshButton;
     QPushButton* m_downloadButton;
-    
+    QComboBox* m_levelCombo;
+    QLineEdit* m_searchEdit;
+    QLabel* m_countLabel;
+    QTimer* m_pollTimer;
+
+    // Lines read so far, and where the next read starts
+    std::deque<LogLine> m_lines;
+    qint64 m_offset = 0;
+    QByteArray m_partialLine;
+    QRegularExpression m_searchExpression;
+
+    // Filters as last applied; the search revision changes with the search text only
+    int m_levelFilter = -1;
+    QString m_searchText;
+    int m_searchRevision = 0;
+
     // Load log content
     void loadLogContent();
+    void resetLog();
+    void appendLines(const std::vector<LogLine>& lines);
+    bool isLineVisible(const LogLine& line) const;
+    bool matchesSearch(const LogLine& line) const;
+    void rebuildView();
+    void updateCountLabel();
+    static LogLevel levelOf(const QString& text);
     void closeEvent(QCloseEvent* event) override;
 
 private slots:
     void refreshLog();
     void downloadLog();
+    void filterChanged();
 };
 
 } // namespace DiveComputer
 
-#endif // LOG_INFO_GUI_HPP
\ No newline at end of file
+#endif // LOG_INFO_GUI_HPP
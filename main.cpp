@@ -14,6 +14,12 @@ int main(int argc, char *argv[]) {
     QCoreApplication::setOrganizationName("DiveComputer");
     QCoreApplication::setApplicationName("DiveComputer");
 
+    // Load the saved settings
+    DiveComputer::g_parameters.loadParametersFromFile();
+    DiveComputer::g_gasList.loadGaslistFromFile();
+    DiveComputer::logSetRotation(DiveComputer::g_parameters.m_logMaxFileSize,
+                                 static_cast<int>(DiveComputer::g_parameters.m_logMaxFiles));
+
     // Create and show main window
     DiveComputer::MainWindow mainWindow;
     mainWindow.show();
@@ -63,6 +63,11 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     openDivePlanAction->setShortcut(QKeySequence("Ctrl+O")); // Ctrl+O (macOS will show as Command+O)
     connect(openDivePlanAction, SIGNAL(triggered()), this, SLOT(openDivePlan()));
 
+    // Plan library action with Command+Shift+O shortcut
+    QAction *planLibraryAction = new QAction("Plan library", this);
+    planLibraryAction->setShortcut(QKeySequence("Ctrl+Shift+O"));
+    connect(planLibraryAction, SIGNAL(triggered()), this, SLOT(openPlanLibrary()));
+
     // Create dive plan action with Command+D shortcut
     QAction *createDivePlanAction = new QAction("Create a dive plan", this);
     createDivePlanAction->setShortcut(QKeySequence("Ctrl+N")); // Ctrl+N (macOS will show as Command+N)
@@ -73,6 +78,11 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     viewLogAction->setShortcut(QKeySequence("Ctrl+L")); // Ctrl+L (macOS will show as Command+L)
     connect(viewLogAction, SIGNAL(triggered()), this, SLOT(viewLogWindow()));
 
+    // Recalculate all open plans action with Command+R shortcut
+    QAction *recalculatePlansAction = new QAction("Recalculate all open plans", this);
+    recalculatePlansAction->setShortcut(QKeySequence("Ctrl+R"));
+    connect(recalculatePlansAction, SIGNAL(triggered()), this, SLOT(recalculateOpenPlans()));
+
     // Create Tools menu
     QMenu *toolsMenu = QMainWindow::menuBar()->addMenu("Tools");
     
@@ -80,7 +90,9 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     toolsMenu->addAction(parametersAction);
     toolsMenu->addAction(gasMixesAction);
     toolsMenu->addAction(openDivePlanAction);
+    toolsMenu->addAction(planLibraryAction);
     toolsMenu->addAction(createDivePlanAction);
+    toolsMenu->addAction(recalculatePlansAction);
     toolsMenu->addSeparator();
     toolsMenu->addAction(viewLogAction);
     
@@ -142,7 +154,11 @@ void MainWindow::openDivePlan() {
     if (filePath.isEmpty()) {
         return;
     }
-    
+
+    openDivePlanFile(filePath);
+}
+
+void MainWindow::openDivePlanFile(const QString& filePath) {
     // Show progress dialog
     QProgressDialog progress("Loading dive plan...", "Cancel", 0, 0, this);
     progress.setWindowModality(Qt::WindowModal);
@@ -176,12 +192,73 @@ void MainWindow::openDivePlan() {
     activateWindowWithMenu(divePlanWindow);
 }
 
+void MainWindow::openPlanLibrary() {
+    openWindow<PlanLibraryWindow>(&planLibraryWindow);
+    connect(planLibraryWindow, &PlanLibraryWindow::openPlanRequested, this, &MainWindow::openDivePlanFile, Qt::UniqueConnection);
+}
+
 void MainWindow::openGasListWindow() {
     openWindow<GasListWindow>(&gasListWindow);
+    connect(gasListWindow, &GasListWindow::gasListChanged, this, &MainWindow::recalculateOpenPlansWithGases, Qt::UniqueConnection);
 }
 
 void MainWindow::openParameterWindow() {
     openWindow<ParameterWindow>(&parameterWindow);
+    connect(parameterWindow, &ParameterWindow::parametersAboutToChange, this, &MainWindow::stopPlanCalculations, Qt::UniqueConnection);
+    connect(parameterWindow, &ParameterWindow::parametersChanged, this, &MainWindow::recalculateOpenPlans, Qt::UniqueConnection);
+    connect(parameterWindow, &ParameterWindow::parametersChanged, this, &MainWindow::refreshGasListWindow, Qt::UniqueConnection);
+}
+
+void MainWindow::refreshGasListWindow() {
+    // The MODs shown depend on the max ppO2 parameters
+    if (gasListWindow) {
+        gasListWindow->refreshGasTable();
+    }
+}
+
+QList<DivePlanWindow*> MainWindow::openDivePlanWindows() const {
+    QList<DivePlanWindow*> windows;
+    for (QWidget* window : *childWindows) {
+        if (DivePlanWindow* divePlanWindow = qobject_cast<DivePlanWindow*>(window)) {
+            windows.append(divePlanWindow);
+        }
+    }
+    return windows;
+}
+
+void MainWindow::updateComputePriorities() {
+    // Focused plan first, then those on screen, then the hidden and minimized ones
+    for (DivePlanWindow* window : openDivePlanWindows()) {
+        if (window == activeDivePlanWindow) {
+            window->setComputePriority(ComputePriority::FOCUSED);
+        } else if (window->isVisible() && !window->isMinimized()) {
+            window->setComputePriority(ComputePriority::VISIBLE);
+        } else {
+            window->setComputePriority(ComputePriority::BACKGROUND);
+        }
+    }
+}
+
+void MainWindow::stopPlanCalculations() {
+    // Nothing may read the globals while they change
+    for (DivePlanWindow* window : openDivePlanWindows()) {
+        window->stopBackgroundWork();
+    }
+}
+
+void MainWindow::recalculateOpenPlans() {
+    // All plans at once on the compute pool, the focused one first
+    updateComputePriorities();
+    for (DivePlanWindow* window : openDivePlanWindows()) {
+        window->recalculateInBackground(false);
+    }
+}
+
+void MainWindow::recalculateOpenPlansWithGases() {
+    updateComputePriorities();
+    for (DivePlanWindow* window : openDivePlanWindows()) {
+        window->recalculateInBackground(true);
+    }
 }
 
 void MainWindow::viewLogWindow() {
@@ -230,6 +307,10 @@ void MainWindow::quitApplication() {
 }
 
 bool MainWindow::eventFilter(QObject* obj, QEvent* event) {
+    if (event->type() == QEvent::WindowStateChange && qobject_cast<DivePlanWindow*>(obj)) {
+        updateComputePriorities();
+    }
+
     if (event->type() == QEvent::WindowActivate) {
         QWidget* activeWindow = QApplication::activeWindow();
         DivePlanWindow* divePlanWindow = qobject_cast<DivePlanWindow*>(activeWindow);
@@ -245,6 +326,7 @@ bool MainWindow::eventFilter(QObject* obj, QEvent* event) {
             divePlanningMenu->setEnabled(false);
             activeDivePlanWindow = nullptr;
         }
+        updateComputePriorities();
     }
     
     return QMainWindow::eventFilter(obj, event);
@@ -262,6 +344,7 @@ void MainWindow::activateWindowWithMenu(DivePlanWindow* window) {
     window->show();
     window->raise();
     window->activateWindow();
+    updateComputePriorities();
 }
 
 void MainWindow::handleWindowDestroyed() {
@@ -273,6 +356,7 @@ void MainWindow::handleWindowDestroyed() {
         if (gasListWindow == obj) gasListWindow = nullptr;
         else if (parameterWindow == obj) parameterWindow = nullptr;
         else if (logViewerWindow == obj) logViewerWindow = nullptr;
+        else if (planLibraryWindow == obj) planLibraryWindow = nullptr;
     }
 }
 
@@ -6,6 +6,7 @@
 #include "parameters_gui.hpp"
 #include "gaslist_gui.hpp"
 #include "dive_plan_gui.hpp"
+#include "plan_library_gui.hpp"
 
 namespace DiveComputer {
 
@@ -41,6 +42,7 @@ public:
     };
     
     void activateWindowWithMenu(DivePlanWindow* window);
+    void openDivePlanFile(const QString& filePath);
 
 protected:
     bool eventFilter(QObject* obj, QEvent* event) override;
@@ -55,17 +57,27 @@ private:
     ParameterWindow *parameterWindow = nullptr;
     GasListWindow *gasListWindow = nullptr;
     LogViewerWindow *logViewerWindow = nullptr;
+    PlanLibraryWindow *planLibraryWindow = nullptr;
     QList<QWidget*> *childWindows; // List to track all windows we create
 
     QMenu* divePlanningMenu = nullptr;
     DivePlanWindow* activeDivePlanWindow = nullptr;
 
+    // Open plans, and the order in which they get the compute pool
+    QList<DivePlanWindow*> openDivePlanWindows() const;
+    void updateComputePriorities();
+
 private slots:
     void createDivePlan();
     void openDivePlan();
+    void openPlanLibrary();
     void openGasListWindow();
     void openParameterWindow();
     void viewLogWindow();
+    void stopPlanCalculations();
+    void recalculateOpenPlans();
+    void recalculateOpenPlansWithGases();
+    void refreshGasListWindow();
 
     void quitApplication();
     void handleWindowDestroyed();
@@ -1,5 +1,7 @@
 #include "oxygen_toxicity.hpp"
 #include <iostream>
+#include <cmath>
+#include <algorithm>
 
 namespace DiveComputer {
 
@@ -18,6 +20,25 @@ O2Exposure::O2Exposure(double ppO2Start, double ppO2End,
 {
 }
 
+// Exponent of the OTU formula and of its integral
+static constexpr double OTU_EXPONENT = 0.833;
+
+static double otuPerMinFormula(double ppO2Ambient) {
+    return (ppO2Ambient >= 0.5) ? std::pow((ppO2Ambient - 0.5) / 0.5, OTU_EXPONENT) : 0.0;
+}
+
+static double otuIntegralFormula(double ppO2Ambient) {
+    return (ppO2Ambient >= 0.5) ? 0.5 / (OTU_EXPONENT + 1) * std::pow((ppO2Ambient - 0.5) / 0.5, OTU_EXPONENT + 1) : 0.0;
+}
+
+// Integral of 1 / (a * ppO2 + b) between two ppO2 values of the same segment
+static double cnsSegmentIntegral(double a, double b, double ppO2From, double ppO2To) {
+    if (a == 0.0) {
+        return (b != 0.0) ? (ppO2To - ppO2From) / b : 0.0;
+    }
+    return std::log((a * ppO2To + b) / (a * ppO2From + b)) / a;
+}
+
 OxygenToxicity::OxygenToxicity() {
     // Initialize NOAA table linearized values
     // Format: ppO2_start, ppO2_end, CNS_single a & b, CNS_multiple a & b
@@ -29,40 +50,110 @@ OxygenToxicity::OxygenToxicity() {
         O2Exposure(1.1, 1.5, -300, 570, -225, 517.5),
         O2Exposure(1.5, 1.65, -750, 1245, -300, 630)
     }};
-}
+    m_ppO2TableMax = m_o2ExposureParameters[NUM_O2_EXPOSURE_PARAMETERS - 1].m_ppO2End;
 
-double OxygenToxicity::getOTUPerMin(double ppO2Ambient) const {
-    const double exponent = 0.833;
-    
-    return (ppO2Ambient >= 0.5) ? std::pow((ppO2Ambient - 0.5) / 0.5, exponent) : 0.0;
-}
+    // Build the CNS buckets from the segment covering the middle of each bucket
+    for (int mode = 0; mode < 2; mode++) {
+        double integral = 0.0;
+        for (int k = 0; k < NUM_CNS_BUCKETS; k++) {
+            CNSBucket& bucket = m_cnsBuckets[mode][k];
+            double bucketStart = k * CNS_BUCKET_WIDTH;
+            double bucketMiddle = bucketStart + CNS_BUCKET_WIDTH / 2;
 
-double OxygenToxicity::getCNSMaxMin(double ppO2Ambient, bool singleDive) const {
-    double a = 0.0, b = 0.0;
-
-    if (ppO2Ambient >= m_o2ExposureParameters[0].m_ppO2Start) {
-        if (ppO2Ambient > m_o2ExposureParameters[NUM_O2_EXPOSURE_PARAMETERS - 1].m_ppO2End) {
-            logWrite("WARNING: ppO2 is greater than the highest ppO2 value in the NOAA table for oxygen toxicity");
-            a = 0.0;
-            b = 100000.0;
-        } else {
-            for (int i = 0; i < NUM_O2_EXPOSURE_PARAMETERS; i++) {
-                if ((ppO2Ambient >= m_o2ExposureParameters[i].m_ppO2Start) && 
-                    (ppO2Ambient <= m_o2ExposureParameters[i].m_ppO2End)) {
-                    if (singleDive) {
-                        a = m_o2ExposureParameters[i].m_aCNSMaxMinSingleDive;
-                        b = m_o2ExposureParameters[i].m_bCNSMaxMinSingleDive;
-                    } else {
-                        a = m_o2ExposureParameters[i].m_aCNSMaxMinMultipleDives;
-                        b = m_o2ExposureParameters[i].m_bCNSMaxMinMultipleDives;
-                    }
+            for (const auto& segment : m_o2ExposureParameters) {
+                if (bucketMiddle >= segment.m_ppO2Start && bucketMiddle <= segment.m_ppO2End) {
+                    bucket.m_a = (mode == 0) ? segment.m_aCNSMaxMinSingleDive : segment.m_aCNSMaxMinMultipleDives;
+                    bucket.m_b = (mode == 0) ? segment.m_bCNSMaxMinSingleDive : segment.m_bCNSMaxMinMultipleDives;
                     break;
                 }
             }
+            bucket.m_integralAtStart = integral;
+            integral += cnsSegmentIntegral(bucket.m_a, bucket.m_b, bucketStart, bucketStart + CNS_BUCKET_WIDTH);
         }
+        m_cnsIntegralAtTableMax[mode] = integral;
+    }
+
+    // Tabulate the OTU formula and its integral
+    for (int k = 0; k <= NUM_OTU_STEPS; k++) {
+        double ppO2 = OTU_PPO2_MIN + k * OTU_STEP;
+        m_otuPerMin[k] = otuPerMinFormula(ppO2);
+        m_otuIntegral[k] = otuIntegralFormula(ppO2);
+    }
+}
+
+int OxygenToxicity::getCNSBucket(double ppO2Ambient) const {
+    // Small tolerance so that a ppO2 on a table boundary lands in the upper segment
+    int k = (int) (ppO2Ambient / CNS_BUCKET_WIDTH + 1e-9);
+    return std::max(0, std::min(k, NUM_CNS_BUCKETS - 1));
+}
+
+double OxygenToxicity::getOTUPerMin(double ppO2Ambient) const {
+    if (ppO2Ambient < OTU_PPO2_MIN) return 0.0;
+
+    double position = (ppO2Ambient - OTU_PPO2_MIN) / OTU_STEP;
+    int k = (int) position;
+    if (k >= NUM_OTU_STEPS) return otuPerMinFormula(ppO2Ambient);
+
+    double fraction = position - k;
+    return m_otuPerMin[k] + (m_otuPerMin[k + 1] - m_otuPerMin[k]) * fraction;
+}
+
+double OxygenToxicity::getOTUIntegral(double ppO2Ambient) const {
+    if (ppO2Ambient < OTU_PPO2_MIN) return 0.0;
+
+    double position = (ppO2Ambient - OTU_PPO2_MIN) / OTU_STEP;
+    int k = (int) position;
+    if (k >= NUM_OTU_STEPS) return otuIntegralFormula(ppO2Ambient);
+
+    double fraction = position - k;
+    return m_otuIntegral[k] + (m_otuIntegral[k + 1] - m_otuIntegral[k]) * fraction;
+}
+
+double OxygenToxicity::getCNSMaxMin(double ppO2Ambient, bool singleDive) const {
+    // Above the table: capped, the caller reports it once per plan
+    if (ppO2Ambient > m_ppO2TableMax) {
+        return CNS_MAX_MIN_ABOVE_TABLE;
+    }
+
+    const CNSBucket& bucket = m_cnsBuckets[singleDive ? 0 : 1][getCNSBucket(ppO2Ambient)];
+    return bucket.m_a * ppO2Ambient + bucket.m_b;
+}
+
+double OxygenToxicity::getCNSIntegral(double ppO2Ambient, bool singleDive) const {
+    int mode = singleDive ? 0 : 1;
+
+    if (ppO2Ambient > m_ppO2TableMax) {
+        return m_cnsIntegralAtTableMax[mode] + (ppO2Ambient - m_ppO2TableMax) / CNS_MAX_MIN_ABOVE_TABLE;
+    }
+
+    int k = getCNSBucket(ppO2Ambient);
+    const CNSBucket& bucket = m_cnsBuckets[mode][k];
+    return bucket.m_integralAtStart + cnsSegmentIntegral(bucket.m_a, bucket.m_b, k * CNS_BUCKET_WIDTH, ppO2Ambient);
+}
+
+double OxygenToxicity::getCNSForRamp(double ppO2Start, double ppO2End, double time, bool singleDive) const {
+    if (time <= 0.0) return 0.0;
+
+    // Constant ppO2: CNS % = time / CNS max minutes
+    if (std::abs(ppO2End - ppO2Start) < 1e-6) {
+        double cnsMaxMin = getCNSMaxMin((ppO2Start + ppO2End) / 2, singleDive);
+        return (cnsMaxMin != 0.0) ? 100 * time / cnsMaxMin : 0.0;
+    }
+
+    // Linear ppO2 over time: CNS % = 100 * time / (ppO2End - ppO2Start) * integral of 1 / CNS max minutes
+    return 100 * time * (getCNSIntegral(ppO2End, singleDive) - getCNSIntegral(ppO2Start, singleDive)) / (ppO2End - ppO2Start);
+}
+
+double OxygenToxicity::getOTUForRamp(double ppO2Start, double ppO2End, double time) const {
+    if (time <= 0.0) return 0.0;
+
+    // Constant ppO2: OTU = time * OTU per minute
+    if (std::abs(ppO2End - ppO2Start) < 1e-6) {
+        return time * getOTUPerMin((ppO2Start + ppO2End) / 2);
     }
 
-    return a * ppO2Ambient + b;
+    // Linear ppO2 over time: OTU = time / (ppO2End - ppO2Start) * integral of OTU per minute
+    return time * (getOTUIntegral(ppO2End) - getOTUIntegral(ppO2Start)) / (ppO2End - ppO2Start);
 }
 
 } // namespace DiveComputer
@@ -38,10 +38,45 @@ public:
     // Calculate CNS max minutes (single_dive or multiple_dives)
     double getCNSMaxMin(double ppO2Ambient, bool singleDive) const;
 
+    // Exposure over a step where the ppO2 varies linearly from start to end (ascent, descent or stop)
+    double getCNSForRamp(double ppO2Start, double ppO2End, double time, bool singleDive) const;
+    double getOTUForRamp(double ppO2Start, double ppO2End, double time) const;
+
+    // True if the ppO2 is above the NOAA table (CNS max minutes are then capped)
+    bool isAboveTable(double ppO2Ambient) const { return ppO2Ambient > m_ppO2TableMax; }
+
 private:
     // NOAA table linearized in the form of CNS_total = a * ppO2 + b
     static constexpr int NUM_O2_EXPOSURE_PARAMETERS = 6;
     std::array<O2Exposure, NUM_O2_EXPOSURE_PARAMETERS> m_o2ExposureParameters;
+
+    // CNS max minutes used above the table
+    static constexpr double CNS_MAX_MIN_ABOVE_TABLE = 100000.0;
+
+    // The table boundaries are multiples of 0.05 bar: each bucket holds the a & b of its segment
+    // and the integral of 1 / CNS_max_min from 0 bar to the start of the bucket
+    static constexpr double CNS_BUCKET_WIDTH = 0.05;
+    static constexpr int NUM_CNS_BUCKETS = 33; // 0 to 1.65 bar
+    struct CNSBucket {
+        double m_a{0.0};
+        double m_b{0.0};
+        double m_integralAtStart{0.0};
+    };
+    std::array<CNSBucket, NUM_CNS_BUCKETS> m_cnsBuckets[2];  // [0] single dive, [1] multiple dives
+    double m_cnsIntegralAtTableMax[2]{0.0, 0.0};
+    double m_ppO2TableMax{0.0};
+
+    // OTU per minute ((ppO2 - 0.5) / 0.5)^0.833 and its integral over ppO2, tabulated from 0.5 to 3.0 bar
+    // Linear interpolation stays within 0.002 OTU/min of the formula (worst just above 0.5 bar)
+    static constexpr double OTU_PPO2_MIN = 0.5;
+    static constexpr double OTU_STEP = 0.005;
+    static constexpr int NUM_OTU_STEPS = 500;
+    std::array<double, NUM_OTU_STEPS + 1> m_otuPerMin;
+    std::array<double, NUM_OTU_STEPS + 1> m_otuIntegral;
+
+    int    getCNSBucket(double ppO2Ambient) const;
+    double getCNSIntegral(double ppO2Ambient, bool singleDive) const;
+    double getOTUIntegral(double ppO2Ambient) const;
 };
 
 // Global instance - will be defined in oxygen_toxicity.cpp
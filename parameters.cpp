@@ -5,13 +5,10 @@ namespace DiveComputer {
 // Initialize global parameters instance
 Parameters g_parameters;
 
+// Defaults only: the application loads the saved parameters once it has set up its paths
 Parameters::Parameters() {
     // Set to Delfult
     setToDefault();
-
-    // Ensure app info is set before any path operations
-    ensureAppInfoSet();
-    loadParametersFromFile();
 }
 
 void Parameters::setToDefault() {
@@ -44,8 +41,12 @@ void Parameters::setToDefault() {
     m_noFlyPressure = 0.7;
     m_noFlyGf = 50.0;
     m_noFlyTimeIncrement = 30.0;
+    m_logMaxFileSize = 10.0;
+    m_logMaxFiles = 5.0;
+    markChanged();
 }
 
+#ifndef DIVECOMPUTER_EMBEDDED
 bool Parameters::loadParametersFromFile() {
     const std::string filename = getFilePath(PARAMETERS_FILE_NAME);
     
@@ -57,7 +58,7 @@ bool Parameters::loadParametersFromFile() {
         
         std::ifstream file(filename, std::ios::binary);
         if (!file.is_open()) {
-            logWrite("Failed to open parameters file for reading.");
+            logError("Failed to open parameters file for reading.");
             return false;
         } else {
             try {
@@ -89,8 +90,19 @@ bool Parameters::loadParametersFromFile() {
                 file.read(reinterpret_cast<char*>(&m_noFlyPressure), sizeof(m_noFlyPressure));
                 file.read(reinterpret_cast<char*>(&m_noFlyGf), sizeof(m_noFlyGf));
                 file.read(reinterpret_cast<char*>(&m_noFlyTimeIncrement), sizeof(m_noFlyTimeIncrement));
+
+                // Added later: files saved before keep the default values
+                double logMaxFileSize = m_logMaxFileSize;
+                double logMaxFiles = m_logMaxFiles;
+                file.read(reinterpret_cast<char*>(&logMaxFileSize), sizeof(logMaxFileSize));
+                file.read(reinterpret_cast<char*>(&logMaxFiles), sizeof(logMaxFiles));
+                if (file) {
+                    m_logMaxFileSize = logMaxFileSize;
+                    m_logMaxFiles = logMaxFiles;
+                }
                 
                 file.close();
+                markChanged();
                 logWrite("Parameters loaded successfully.");
                 return true;
             }
@@ -112,6 +124,9 @@ bool Parameters::loadParametersFromFile() {
 
 bool Parameters::saveParametersToFile() {
     const std::string filename = getFilePath(PARAMETERS_FILE_NAME);
+    if (filename.empty()) {
+        return false;    // no data directory to save to
+    }
     
     logWrite("Saving parameters to: ", filename);
     
@@ -121,7 +136,7 @@ bool Parameters::saveParametersToFile() {
     
     std::ofstream file(filename, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
-        logWrite("Failed to open file for writing: ", filename);
+        logError("Failed to open file for writing: ", filename);
         return false;
     }
 
@@ -153,6 +168,8 @@ bool Parameters::saveParametersToFile() {
     file.write(reinterpret_cast<const char*>(&g_parameters.m_noFlyPressure), sizeof(g_parameters.m_noFlyPressure));
     file.write(reinterpret_cast<const char*>(&g_parameters.m_noFlyGf), sizeof(g_parameters.m_noFlyGf));
     file.write(reinterpret_cast<const char*>(&g_parameters.m_noFlyTimeIncrement), sizeof(g_parameters.m_noFlyTimeIncrement));
+    file.write(reinterpret_cast<const char*>(&g_parameters.m_logMaxFileSize), sizeof(g_parameters.m_logMaxFileSize));
+    file.write(reinterpret_cast<const char*>(&g_parameters.m_logMaxFiles), sizeof(g_parameters.m_logMaxFiles));
 
     file.close();
     
@@ -161,9 +178,51 @@ bool Parameters::saveParametersToFile() {
         logWrite("Parameters saved successfully to ", filename, ". File size: ", std::filesystem::file_size(filename), " bytes");
         return true;
     } else {
-        logWrite("Error: File does not exist after save operation!");
+        logError("File does not exist after save operation!");
         return false;
     }
 }
 
+uint64_t Parameters::checksum() const {
+    // FNV-1a over the bytes of the values, in the order of the parameters file
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const auto& value) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        for (size_t i = 0; i < sizeof(value); i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    mix(m_gf);
+    mix(m_atmPressure);
+    mix(m_tempMin);
+    mix(m_defaultEnd);
+    mix(m_defaultO2Narcotic);
+    mix(m_maxAscentRate);
+    mix(m_maxDescentRate);
+    mix(m_sacBottom);
+    mix(m_sacBailout);
+    mix(m_sacDeco);
+    mix(m_o2CostPerL);
+    mix(m_heCostPerL);
+    mix(m_bestMixDepthBuffer);
+    mix(m_PpO2Active);
+    mix(m_PpO2Deco);
+    mix(m_maxPpO2Diluent);
+    mix(m_warningPpO2Low);
+    mix(m_warningCnsMax);
+    mix(m_warningOtuMax);
+    mix(m_warningGasDensity);
+    mix(m_depthIncrement);
+    mix(m_lastStopDepth);
+    mix(m_timeIncrementDeco);
+    mix(m_timeIncrementMaxTime);
+    mix(m_noFlyPressure);
+    mix(m_noFlyGf);
+    mix(m_noFlyTimeIncrement);
+    mix(m_calculateAPandTPonOneTank);
+    return hash;
+}
+
+#endif
+
 } // namespace DiveComputer
\ No newline at end of file
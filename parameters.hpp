@@ -3,10 +3,14 @@
 
 #include "log_info.hpp"
 #include "global.hpp"
+#include <cstdint>
+#ifndef DIVECOMPUTER_EMBEDDED
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <string>
+#endif
 
 // If you have a different path definition in a constants file, you'd include it here
 // For now I'll assume PATH_PARAMETERS is defined elsewhere or we'll replace it
@@ -18,8 +22,21 @@ public:
     Parameters();
     
     void setToDefault();
+
+    // Incremented by every change of the parameters. What is derived from them is cached
+    // with the epoch it was derived at, and derived again once the epoch differs.
+    // Callers setting the members directly call markChanged() when done.
+    // Pool threads read it while the GUI thread marks changes.
+    uint64_t epoch() const { return m_epoch; }
+    void markChanged() { m_epoch++; }
+#ifndef DIVECOMPUTER_EMBEDDED
     bool loadParametersFromFile();
     bool saveParametersToFile();
+
+    // Hash of the values the plans are calculated from (all but the log settings),
+    // saved with the cached results of a plan file to know if they can be reused
+    uint64_t checksum() const;
+#endif
     
     // Your parameter variables
     double m_gf[2]; 
@@ -49,8 +66,17 @@ public:
     double m_noFlyPressure;
     double m_noFlyGf;
     double m_noFlyTimeIncrement;
+    double m_logMaxFileSize;    // MB
+    double m_logMaxFiles;
 
     double m_calculateAPandTPonOneTank = true;
+
+private:
+#ifdef DIVECOMPUTER_EMBEDDED
+    uint64_t m_epoch{1};    // 0 is left to caches never filled
+#else
+    std::atomic<uint64_t> m_epoch{1};
+#endif
 };
 
 // Global parameters object
@@ -71,6 +71,7 @@ ParameterWindow::ParameterWindow(QWidget *parent) : QMainWindow(parent) {
     rightColumnLayout->addWidget(createWarningThresholdsGroup());
     rightColumnLayout->addWidget(createStopParametersGroup());
     rightColumnLayout->addWidget(createNoFlyParametersGroup());
+    rightColumnLayout->addWidget(createLogParametersGroup());
     
     // Add stretches to push content to the top
     leftColumnLayout->addStretch(1);
@@ -572,6 +573,47 @@ QGroupBox* ParameterWindow::createNoFlyParametersGroup() {
     
     return noFlyGroup;
 }
+
+QGroupBox* ParameterWindow::createLogParametersGroup() {
+    QGroupBox *logGroup = new QGroupBox("Log Files", this);
+    QGridLayout *gridLayout = new QGridLayout(logGroup);
+    
+    // Create labels with right alignment
+    QLabel *logMaxFileSizeLabel = new QLabel("Rotate Log At:", this);
+    QLabel *logMaxFilesLabel = new QLabel("Archives Kept:", this);
+    
+    logMaxFileSizeLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    logMaxFilesLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    
+    // Create spinboxes with right alignment
+    logMaxFileSizeSpinBox = new QDoubleSpinBox(this);
+    logMaxFileSizeSpinBox->setRange(0.0, 1000.0);
+    logMaxFileSizeSpinBox->setSingleStep(1.0);
+    logMaxFileSizeSpinBox->setDecimals(0);
+    logMaxFileSizeSpinBox->setSuffix(" MB");
+    logMaxFileSizeSpinBox->setSpecialValueText("No limit");
+    logMaxFileSizeSpinBox->setFixedWidth(100);
+    logMaxFileSizeSpinBox->setAlignment(Qt::AlignRight);
+    
+    logMaxFilesSpinBox = new QDoubleSpinBox(this);
+    logMaxFilesSpinBox->setRange(0.0, 50.0);
+    logMaxFilesSpinBox->setSingleStep(1.0);
+    logMaxFilesSpinBox->setDecimals(0);
+    logMaxFilesSpinBox->setFixedWidth(100);
+    logMaxFilesSpinBox->setAlignment(Qt::AlignRight);
+    
+    // Add widgets to grid layout
+    gridLayout->addWidget(logMaxFileSizeLabel, 0, 0);
+    gridLayout->addWidget(logMaxFileSizeSpinBox, 0, 1);
+    gridLayout->addWidget(logMaxFilesLabel, 1, 0);
+    gridLayout->addWidget(logMaxFilesSpinBox, 1, 1);
+    
+    // Configure column stretching
+    gridLayout->setColumnStretch(0, 1);
+    gridLayout->setColumnStretch(1, 1);
+    
+    return logGroup;
+}
     
 void ParameterWindow::loadParameterValues() {
     // Load values from g_parameters
@@ -602,14 +644,22 @@ void ParameterWindow::loadParameterValues() {
     noFlyPressureSpinBox->setValue(g_parameters.m_noFlyPressure);
     noFlyGfSpinBox->setValue(g_parameters.m_noFlyGf);
     noFlyTimeIncrementSpinBox->setValue(g_parameters.m_noFlyTimeIncrement);
+    logMaxFileSizeSpinBox->setValue(g_parameters.m_logMaxFileSize);
+    logMaxFilesSpinBox->setValue(g_parameters.m_logMaxFiles);
 }
 
 void ParameterWindow::resetParameters() {
+    // Same path as a save: the calculations reading the parameters are stopped first,
+    // and the open plans are calculated again with the defaults
+    emit parametersAboutToChange();
     g_parameters.setToDefault();
     loadParameterValues();
+    emit parametersChanged();
 }
 
 void ParameterWindow::saveParameters() {
+    emit parametersAboutToChange();
+
     // Save values back to g_parameters
     g_parameters.m_gf[0] = gfLowSpinBox->value();
     g_parameters.m_gf[1] = gfHighSpinBox->value();
@@ -638,8 +688,13 @@ void ParameterWindow::saveParameters() {
     g_parameters.m_noFlyPressure = noFlyPressureSpinBox->value();
     g_parameters.m_noFlyGf = noFlyGfSpinBox->value();
     g_parameters.m_noFlyTimeIncrement = noFlyTimeIncrementSpinBox->value();
+    g_parameters.m_logMaxFileSize = logMaxFileSizeSpinBox->value();
+    g_parameters.m_logMaxFiles = logMaxFilesSpinBox->value();
+    g_parameters.markChanged();
     
     g_parameters.saveParametersToFile();
+    logSetRotation(g_parameters.m_logMaxFileSize, static_cast<int>(g_parameters.m_logMaxFiles));
+    emit parametersChanged();
     
     // Close the window
     close();
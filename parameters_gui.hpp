@@ -12,6 +12,11 @@ class ParameterWindow : public QMainWindow {
     
 public:
     ParameterWindow(QWidget *parent = nullptr);
+
+signals:
+    // Around the change of g_parameters, for the plans calculated with them
+    void parametersAboutToChange();
+    void parametersChanged();
     
 private:
     // Window size
@@ -63,6 +68,10 @@ private:
     QDoubleSpinBox *noFlyGfSpinBox;
     QDoubleSpinBox *noFlyTimeIncrementSpinBox;
 
+    // Log file parameters
+    QDoubleSpinBox *logMaxFileSizeSpinBox;
+    QDoubleSpinBox *logMaxFilesSpinBox;
+
     // UI Components for each parameter
     QGroupBox* createGradientFactorGroup();
     QGroupBox* createEnvironmentGroup();
@@ -73,6 +82,7 @@ private:
     QGroupBox* createWarningThresholdsGroup();
     QGroupBox* createStopParametersGroup();
     QGroupBox* createNoFlyParametersGroup();
+    QGroupBox* createLogParametersGroup();
 
     void loadParameterValues();
 
@@ -0,0 +1,260 @@
+#include "plan_library.hpp"
+#include "dive_plan_file.hpp"
+#include "log_info.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <QElapsedTimer>
+
+namespace DiveComputer {
+
+static constexpr char     PLAN_INDEX_MAGIC[8] = {'D', 'I', 'V', 'E', 'I', 'D', 'X', '1'};
+static constexpr uint32_t PLAN_INDEX_NAME_MAX = 4096;
+
+static std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+static bool isDiveFile(const std::filesystem::path& path) {
+    return toLower(path.extension().string()) == ".dive";
+}
+
+static int64_t fileStamp(const std::filesystem::file_time_type& time) {
+    return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+static int64_t fileDate(const std::filesystem::file_time_type& time) {
+    // file_time_type has no portable epoch in C++17: go through the current time of both clocks
+    auto systemTime = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        time - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
+    return std::chrono::duration_cast<std::chrono::seconds>(systemTime.time_since_epoch()).count();
+}
+
+std::string PlanIndexEntry::gasesString() const {
+    std::stringstream ss;
+    for (int i = 0; i < m_nbGases; i++) {
+        if (i > 0) ss << " ";
+        ss << static_cast<int>(m_gasO2[i]) << "/" << static_cast<int>(m_gasHe[i]);
+    }
+    return ss.str();
+}
+
+PlanIndex::PlanIndex(const std::string& directory) : m_directory(directory) {}
+
+std::string PlanIndex::filePath(const PlanIndexEntry& entry) const {
+    return (std::filesystem::path(m_directory) / entry.m_fileName).string();
+}
+
+// INDEX FILE
+
+std::string PlanIndex::indexFilePath() const {
+    return (std::filesystem::path(m_directory) / PLAN_INDEX_FILE_NAME).string();
+}
+
+bool PlanIndex::load() {
+    m_entries.clear();
+
+    std::ifstream file(indexFilePath(), std::ios::binary);
+    if (!file.is_open()) return false;
+
+    char magic[8] = {0};
+    uint32_t count = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file.good() || std::memcmp(magic, PLAN_INDEX_MAGIC, sizeof(magic)) != 0) return false;
+
+    m_entries.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        PlanIndexEntry entry;
+        uint32_t nameLength = 0;
+        file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+        if (!file.good() || nameLength > PLAN_INDEX_NAME_MAX) break;
+        entry.m_fileName.resize(nameLength);
+        file.read(&entry.m_fileName[0], nameLength);
+
+        file.read(reinterpret_cast<char*>(&entry.m_fileStamp), sizeof(entry.m_fileStamp));
+        file.read(reinterpret_cast<char*>(&entry.m_fileSize), sizeof(entry.m_fileSize));
+        file.read(reinterpret_cast<char*>(&entry.m_date), sizeof(entry.m_date));
+        file.read(reinterpret_cast<char*>(&entry.m_maxDepth), sizeof(entry.m_maxDepth));
+        file.read(reinterpret_cast<char*>(&entry.m_runTime), sizeof(entry.m_runTime));
+        file.read(reinterpret_cast<char*>(&entry.m_tts), sizeof(entry.m_tts));
+        file.read(reinterpret_cast<char*>(&entry.m_gfLow), sizeof(entry.m_gfLow));
+        file.read(reinterpret_cast<char*>(&entry.m_gfHigh), sizeof(entry.m_gfHigh));
+        file.read(reinterpret_cast<char*>(&entry.m_mode), sizeof(entry.m_mode));
+        file.read(reinterpret_cast<char*>(&entry.m_nbGases), sizeof(entry.m_nbGases));
+        file.read(reinterpret_cast<char*>(entry.m_gasO2), sizeof(entry.m_gasO2));
+        file.read(reinterpret_cast<char*>(entry.m_gasHe), sizeof(entry.m_gasHe));
+        if (!file.good()) break;
+
+        entry.m_nbGases = std::min<uint8_t>(entry.m_nbGases, PLAN_INDEX_MAX_GASES);
+        updateSearchText(entry);
+        m_entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+bool PlanIndex::save() const {
+    std::ofstream file(indexFilePath(), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        logError("Failed to open plan index for writing in: ", m_directory);
+        return false;
+    }
+
+    uint32_t count = static_cast<uint32_t>(m_entries.size());
+    file.write(PLAN_INDEX_MAGIC, sizeof(PLAN_INDEX_MAGIC));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& entry : m_entries) {
+        uint32_t nameLength = static_cast<uint32_t>(entry.m_fileName.size());
+        file.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+        file.write(entry.m_fileName.data(), nameLength);
+
+        file.write(reinterpret_cast<const char*>(&entry.m_fileStamp), sizeof(entry.m_fileStamp));
+        file.write(reinterpret_cast<const char*>(&entry.m_fileSize), sizeof(entry.m_fileSize));
+        file.write(reinterpret_cast<const char*>(&entry.m_date), sizeof(entry.m_date));
+        file.write(reinterpret_cast<const char*>(&entry.m_maxDepth), sizeof(entry.m_maxDepth));
+        file.write(reinterpret_cast<const char*>(&entry.m_runTime), sizeof(entry.m_runTime));
+        file.write(reinterpret_cast<const char*>(&entry.m_tts), sizeof(entry.m_tts));
+        file.write(reinterpret_cast<const char*>(&entry.m_gfLow), sizeof(entry.m_gfLow));
+        file.write(reinterpret_cast<const char*>(&entry.m_gfHigh), sizeof(entry.m_gfHigh));
+        file.write(reinterpret_cast<const char*>(&entry.m_mode), sizeof(entry.m_mode));
+        file.write(reinterpret_cast<const char*>(&entry.m_nbGases), sizeof(entry.m_nbGases));
+        file.write(reinterpret_cast<const char*>(entry.m_gasO2), sizeof(entry.m_gasO2));
+        file.write(reinterpret_cast<const char*>(entry.m_gasHe), sizeof(entry.m_gasHe));
+    }
+
+    return file.good();
+}
+
+// SCANNING
+
+bool PlanIndex::readEntry(const std::string& filePath, PlanIndexEntry& entry) {
+    DivePlanFileInputs inputs;
+    DivePlanFileSummary summary;
+    if (!readDivePlanFileSummary(filePath, inputs, summary)) return false;
+
+    if (summary.m_savedAt > 0) entry.m_date = summary.m_savedAt;
+    entry.m_maxDepth = static_cast<float>(summary.m_maxDepth);
+    entry.m_runTime = static_cast<float>(summary.m_runTime);
+    entry.m_tts = static_cast<float>(summary.m_tts);
+    entry.m_gfLow = static_cast<float>(inputs.m_gf[0]);
+    entry.m_gfHigh = static_cast<float>(inputs.m_gf[1]);
+    entry.m_mode = inputs.m_mode;
+
+    entry.m_nbGases = static_cast<uint8_t>(std::min<size_t>(inputs.m_gases.size(), PLAN_INDEX_MAX_GASES));
+    for (int i = 0; i < entry.m_nbGases; i++) {
+        entry.m_gasO2[i] = static_cast<uint8_t>(std::clamp(inputs.m_gases[i].m_o2Percent, 0.0, 100.0) + 0.5);
+        entry.m_gasHe[i] = static_cast<uint8_t>(std::clamp(inputs.m_gases[i].m_hePercent, 0.0, 100.0) + 0.5);
+    }
+    return true;
+}
+
+void PlanIndex::updateSearchText(PlanIndexEntry& entry) {
+    entry.m_searchText = toLower(entry.m_fileName) + " " + entry.gasesString();
+}
+
+int PlanIndex::refresh() {
+    // Log performance
+    QElapsedTimer timer;
+    timer.start();
+
+    if (m_entries.empty()) load();
+
+    std::unordered_map<std::string, size_t> known;
+    for (size_t i = 0; i < m_entries.size(); i++) known[m_entries[i].m_fileName] = i;
+
+    std::vector<PlanIndexEntry> entries;
+    int filesRead = 0;
+    bool changed = false;
+
+    std::error_code error;
+    for (const auto& item : std::filesystem::directory_iterator(m_directory, error)) {
+        if (!item.is_regular_file(error) || !isDiveFile(item.path())) continue;
+
+        PlanIndexEntry entry;
+        entry.m_fileName = item.path().filename().string();
+        auto writeTime = item.last_write_time(error);
+        entry.m_fileStamp = fileStamp(writeTime);
+        entry.m_fileSize = item.file_size(error);
+
+        // Unchanged files keep their indexed values
+        auto it = known.find(entry.m_fileName);
+        if (it != known.end() && m_entries[it->second].m_fileStamp == entry.m_fileStamp &&
+            m_entries[it->second].m_fileSize == entry.m_fileSize) {
+            entries.push_back(std::move(m_entries[it->second]));
+            known.erase(it);
+            continue;
+        }
+
+        entry.m_date = fileDate(writeTime);
+        filesRead++;
+        changed = true;
+        if (!readEntry(item.path().string(), entry)) {
+            logWarning("Could not index dive plan: ", item.path().string());
+            continue;
+        }
+        updateSearchText(entry);
+        entries.push_back(std::move(entry));
+    }
+
+    // Entries left in known are files that were removed
+    changed = changed || !known.empty();
+    m_entries = std::move(entries);
+    if (changed) save();
+
+    logWrite("PlanIndex::refresh() took ", timer.elapsed(), " ms for ", m_entries.size(), " plans (", filesRead, " read)");
+    return filesRead;
+}
+
+// QUERIES
+
+std::vector<int> PlanIndex::query(const PlanIndexFilter& filter, PlanIndexSortKey sortKey, bool ascending) const {
+    // Split the text filter into lower-case words
+    std::vector<std::string> words;
+    std::stringstream ss(toLower(filter.m_text));
+    std::string word;
+    while (ss >> word) words.push_back(word);
+
+    std::vector<int> rows;
+    rows.reserve(m_entries.size());
+    for (int i = 0; i < static_cast<int>(m_entries.size()); i++) {
+        const PlanIndexEntry& entry = m_entries[i];
+        if (entry.m_maxDepth < filter.m_minDepth || entry.m_maxDepth > filter.m_maxDepth) continue;
+        if (filter.m_mode >= 0 && entry.m_mode != filter.m_mode) continue;
+
+        bool match = true;
+        for (const auto& w : words) {
+            if (entry.m_searchText.find(w) == std::string::npos) { match = false; break; }
+        }
+        if (match) rows.push_back(i);
+    }
+
+    auto less = [&](int a, int b) {
+        const PlanIndexEntry& x = m_entries[a];
+        const PlanIndexEntry& y = m_entries[b];
+        switch (sortKey) {
+            case PlanIndexSortKey::DATE:      return x.m_date < y.m_date;
+            case PlanIndexSortKey::MAX_DEPTH: return x.m_maxDepth < y.m_maxDepth;
+            case PlanIndexSortKey::RUN_TIME:  return x.m_runTime < y.m_runTime;
+            case PlanIndexSortKey::TTS:       return x.m_tts < y.m_tts;
+            case PlanIndexSortKey::MODE:      return x.m_mode < y.m_mode;
+            case PlanIndexSortKey::GF:        return std::make_pair(x.m_gfLow, x.m_gfHigh) < std::make_pair(y.m_gfLow, y.m_gfHigh);
+            case PlanIndexSortKey::GASES:     return std::lexicographical_compare(x.m_gasO2, x.m_gasO2 + x.m_nbGases, y.m_gasO2, y.m_gasO2 + y.m_nbGases);
+            default:                          return x.m_fileName < y.m_fileName;
+        }
+    };
+
+    if (ascending) {
+        std::stable_sort(rows.begin(), rows.end(), less);
+    } else {
+        std::stable_sort(rows.begin(), rows.end(), [&](int a, int b) { return less(b, a); });
+    }
+    return rows;
+}
+
+} // namespace DiveComputer
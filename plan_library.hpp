@@ -0,0 +1,83 @@
+#ifndef PLAN_LIBRARY_HPP
+#define PLAN_LIBRARY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace DiveComputer {
+
+const std::string PLAN_INDEX_FILE_NAME = ".diveplans.idx";
+constexpr int PLAN_INDEX_MAX_GASES = 8;
+
+// Compact description of a .dive file, enough to list, filter and sort a library
+// without opening the plans
+struct PlanIndexEntry {
+    std::string m_fileName;
+    int64_t  m_fileStamp{0};    // last write time, only compared to detect changes
+    uint64_t m_fileSize{0};
+    int64_t  m_date{0};         // seconds since epoch: time saved, or file time for version 1
+    float    m_maxDepth{0.0f};
+    float    m_runTime{0.0f};
+    float    m_tts{0.0f};
+    float    m_gfLow{0.0f};
+    float    m_gfHigh{0.0f};
+    int32_t  m_mode{0};
+    uint8_t  m_nbGases{0};
+    uint8_t  m_gasO2[PLAN_INDEX_MAX_GASES]{};
+    uint8_t  m_gasHe[PLAN_INDEX_MAX_GASES]{};
+
+    // Lower-case file name and gases, built in memory for text filtering
+    std::string m_searchText;
+
+    std::string gasesString() const;
+};
+
+enum class PlanIndexSortKey {
+    NAME,
+    DATE,
+    MAX_DEPTH,
+    RUN_TIME,
+    TTS,
+    MODE,
+    GF,
+    GASES
+};
+
+struct PlanIndexFilter {
+    std::string m_text;           // every word must appear in the name or the gases
+    double m_minDepth{0.0};
+    double m_maxDepth{1000.0};
+    int    m_mode{-1};            // diveMode, or -1 for all
+};
+
+// Index of the .dive files of a directory, kept next to them in PLAN_INDEX_FILE_NAME
+class PlanIndex {
+public:
+    explicit PlanIndex(const std::string& directory);
+
+    const std::string& directory() const { return m_directory; }
+    const std::vector<PlanIndexEntry>& entries() const { return m_entries; }
+    std::string filePath(const PlanIndexEntry& entry) const;
+
+    // Read the stored index, then re-read only the files that are new or changed.
+    // Returns the number of files that were read.
+    int  refresh();
+    bool load();
+    bool save() const;
+
+    // Rows of entries() matching the filter, sorted
+    std::vector<int> query(const PlanIndexFilter& filter, PlanIndexSortKey sortKey, bool ascending) const;
+
+private:
+    std::string m_directory;
+    std::vector<PlanIndexEntry> m_entries;
+
+    std::string indexFilePath() const;
+    static bool readEntry(const std::string& filePath, PlanIndexEntry& entry);
+    static void updateSearchText(PlanIndexEntry& entry);
+};
+
+} // namespace DiveComputer
+
+#endif // PLAN_LIBRARY_HPP
@@ -0,0 +1,339 @@
+#include "plan_library_gui.hpp"
+#include "dive_plan_file.hpp"
+#include "enum.hpp"
+
+namespace DiveComputer {
+
+// Column indices for better readability
+enum PlanLibraryColumns {
+    COL_NAME = 0,
+    COL_DATE,
+    COL_MODE,
+    COL_DEPTH,
+    COL_RUNTIME,
+    COL_TTS,
+    COL_GF,
+    COL_GASES,
+    NUM_PLAN_LIBRARY_COLUMNS
+};
+
+static const PlanIndexSortKey COLUMN_SORT_KEYS[NUM_PLAN_LIBRARY_COLUMNS] = {
+    PlanIndexSortKey::NAME, PlanIndexSortKey::DATE, PlanIndexSortKey::MODE, PlanIndexSortKey::MAX_DEPTH,
+    PlanIndexSortKey::RUN_TIME, PlanIndexSortKey::TTS, PlanIndexSortKey::GF, PlanIndexSortKey::GASES
+};
+
+// MODEL
+
+void PlanLibraryModel::setRows(const PlanIndex* index, std::vector<int> rows) {
+    beginResetModel();
+    m_index = index;
+    m_rows = std::move(rows);
+    endResetModel();
+}
+
+const PlanIndexEntry* PlanLibraryModel::entryAt(int row) const {
+    if (!m_index || row < 0 || row >= static_cast<int>(m_rows.size())) return nullptr;
+    return &m_index->entries()[m_rows[row]];
+}
+
+int PlanLibraryModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int PlanLibraryModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : NUM_PLAN_LIBRARY_COLUMNS;
+}
+
+QVariant PlanLibraryModel::data(const QModelIndex &index, int role) const {
+    const PlanIndexEntry* entry = entryAt(index.row());
+    if (!entry) return QVariant();
+
+    if (role == Qt::TextAlignmentRole) {
+        return (index.column() == COL_NAME) ? int(Qt::AlignLeft | Qt::AlignVCenter) : int(Qt::AlignCenter);
+    }
+    if (role != Qt::DisplayRole) return QVariant();
+
+    // Rows are built on demand, only for the visible part of the table
+    switch (index.column()) {
+        case COL_NAME:    return QString::fromStdString(entry->m_fileName);
+        case COL_DATE:    return QDateTime::fromSecsSinceEpoch(entry->m_date).toString("yyyy-MM-dd HH:mm");
+        case COL_MODE:    return QString::fromStdString(getDiveModeString(static_cast<diveMode>(entry->m_mode)));
+        case COL_DEPTH:   return QString::number(entry->m_maxDepth, 'f', 0);
+        case COL_RUNTIME: return QString::number(entry->m_runTime, 'f', 0);
+        case COL_TTS:     return QString::number(entry->m_tts, 'f', 0);
+        case COL_GF:      return QString("%1/%2").arg(entry->m_gfLow, 0, 'f', 0).arg(entry->m_gfHigh, 0, 'f', 0);
+        case COL_GASES:   return QString::fromStdString(entry->gasesString());
+        default:          return QVariant();
+    }
+}
+
+QVariant PlanLibraryModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+
+    static const char* headers[NUM_PLAN_LIBRARY_COLUMNS] = {
+        "Plan", "Date", "Mode", "Depth", "Runtime", "TTS", "GF", "Gases"
+    };
+    return (section >= 0 && section < NUM_PLAN_LIBRARY_COLUMNS) ? QString(headers[section]) : QVariant();
+}
+
+// WINDOW
+
+PlanLibraryWindow::PlanLibraryWindow(QWidget *parent) : QMainWindow(parent) {
+    setWindowTitle("Plan Library");
+
+    // Re-index once a burst of file system changes is over
+    m_watcher = new QFileSystemWatcher(this);
+    m_rescanTimer = new QTimer(this);
+    m_rescanTimer->setSingleShot(true);
+    m_rescanTimer->setInterval(300);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_rescanTimer, qOverload<>(&QTimer::start));
+    connect(m_rescanTimer, &QTimer::timeout, this, &PlanLibraryWindow::rescan);
+
+    setupUI();
+
+    // Reopen the last directory, or the documents directory the first time
+    QString directory = loadDirectory();
+    if (directory.isEmpty()) {
+        directory = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    }
+    setDirectory(directory);
+
+    // Use the common window sizing and positioning function
+    setWindowSizeAndPosition(this, preferredWidth, preferredHeight, WindowPosition::CENTER);
+}
+
+void PlanLibraryWindow::setupUI() {
+    QWidget *centralWidget = new QWidget(this);
+    setCentralWidget(centralWidget);
+    QVBoxLayout *mainLayout = new QVBoxLayout(centralWidget);
+
+    // Directory selection
+    QHBoxLayout *directoryLayout = new QHBoxLayout();
+    QPushButton *directoryButton = new QPushButton("Folder...", this);
+    m_directoryLabel = new QLabel(this);
+    directoryLayout->addWidget(directoryButton);
+    directoryLayout->addWidget(m_directoryLabel, 1);
+    mainLayout->addLayout(directoryLayout);
+    connect(directoryButton, &QPushButton::clicked, this, &PlanLibraryWindow::chooseDirectory);
+
+    // Filters
+    QHBoxLayout *filterLayout = new QHBoxLayout();
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText("Search name or gases (e.g. 21/35)");
+    m_filterEdit->setClearButtonEnabled(true);
+    filterLayout->addWidget(m_filterEdit, 1);
+
+    filterLayout->addWidget(new QLabel("Depth:", this));
+    m_minDepthSpin = new QSpinBox(this);
+    m_minDepthSpin->setRange(0, 1000);
+    m_minDepthSpin->setSuffix(" m");
+    m_maxDepthSpin = new QSpinBox(this);
+    m_maxDepthSpin->setRange(0, 1000);
+    m_maxDepthSpin->setValue(1000);
+    m_maxDepthSpin->setSuffix(" m");
+    filterLayout->addWidget(m_minDepthSpin);
+    filterLayout->addWidget(new QLabel("-", this));
+    filterLayout->addWidget(m_maxDepthSpin);
+
+    m_modeCombo = new QComboBox(this);
+    m_modeCombo->addItem("All modes", -1);
+    m_modeCombo->addItem("OC", static_cast<int>(diveMode::OC));
+    m_modeCombo->addItem("CC", static_cast<int>(diveMode::CC));
+    filterLayout->addWidget(m_modeCombo);
+    mainLayout->addLayout(filterLayout);
+
+    connect(m_filterEdit, &QLineEdit::textChanged, this, &PlanLibraryWindow::applyFilter);
+    connect(m_minDepthSpin, qOverload<int>(&QSpinBox::valueChanged), this, &PlanLibraryWindow::applyFilter);
+    connect(m_maxDepthSpin, qOverload<int>(&QSpinBox::valueChanged), this, &PlanLibraryWindow::applyFilter);
+    connect(m_modeCombo, qOverload<int>(&QComboBox::currentIndexChanged), this, &PlanLibraryWindow::applyFilter);
+
+    // Plan table and preview side by side
+    QSplitter *splitter = new QSplitter(Qt::Horizontal, this);
+
+    m_model = new PlanLibraryModel(this);
+    m_planTable = new QTableView(splitter);
+    m_planTable->setModel(m_model);
+    m_planTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_planTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_planTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_planTable->verticalHeader()->setVisible(false);
+    m_planTable->verticalHeader()->setDefaultSectionSize(22);
+    m_planTable->horizontalHeader()->setSectionResizeMode(COL_NAME, QHeaderView::Stretch);
+    m_planTable->horizontalHeader()->setSectionsClickable(true);
+    m_planTable->horizontalHeader()->setSortIndicatorShown(true);
+    m_planTable->horizontalHeader()->setSortIndicator(COL_DATE, Qt::DescendingOrder);
+
+    connect(m_planTable->horizontalHeader(), &QHeaderView::sectionClicked, this, &PlanLibraryWindow::sortByColumn);
+    connect(m_planTable->selectionModel(), &QItemSelectionModel::selectionChanged, this, &PlanLibraryWindow::selectionChanged);
+    connect(m_planTable, &QTableView::doubleClicked, this, &PlanLibraryWindow::openSelectedPlan);
+
+    m_previewBrowser = new QTextBrowser(splitter);
+    m_previewBrowser->setMinimumWidth(250);
+
+    splitter->addWidget(m_planTable);
+    splitter->addWidget(m_previewBrowser);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+    mainLayout->addWidget(splitter, 1);
+
+    // Open button
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    QPushButton *openButton = new QPushButton("Open", this);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(openButton);
+    mainLayout->addLayout(buttonLayout);
+    connect(openButton, &QPushButton::clicked, this, &PlanLibraryWindow::openSelectedPlan);
+}
+
+// DIRECTORY
+
+void PlanLibraryWindow::chooseDirectory() {
+    QString directory = QFileDialog::getExistingDirectory(this, "Plan Library Folder",
+        m_index ? QString::fromStdString(m_index->directory()) : QDir::homePath());
+    if (directory.isEmpty()) return;
+
+    setDirectory(directory);
+    saveDirectory(directory);
+}
+
+void PlanLibraryWindow::setDirectory(const QString& directory) {
+    if (!m_watcher->directories().isEmpty()) {
+        m_watcher->removePaths(m_watcher->directories());
+    }
+
+    m_directoryLabel->setText(directory);
+    m_index = std::make_unique<PlanIndex>(directory.toStdString());
+    m_watcher->addPath(directory);
+    rescan();
+}
+
+void PlanLibraryWindow::saveDirectory(const QString& directory) {
+    std::ofstream file(getFilePath(PLAN_LIBRARY_FILE_NAME));
+    if (file.is_open()) {
+        file << directory.toStdString();
+    }
+}
+
+QString PlanLibraryWindow::loadDirectory() {
+    std::ifstream file(getFilePath(PLAN_LIBRARY_FILE_NAME));
+    std::string directory;
+    if (file.is_open()) {
+        std::getline(file, directory);
+    }
+    return QString::fromStdString(directory);
+}
+
+// INDEX AND FILTERING
+
+void PlanLibraryWindow::rescan() {
+    if (!m_index) return;
+    m_index->refresh();
+    applyFilter();
+}
+
+void PlanLibraryWindow::applyFilter() {
+    if (!m_index) return;
+
+    // Keep the selected plan selected across filtering and sorting
+    const PlanIndexEntry* selected = m_model->entryAt(m_planTable->currentIndex().row());
+    std::string selectedName = selected ? selected->m_fileName : std::string();
+
+    PlanIndexFilter filter;
+    filter.m_text = m_filterEdit->text().toStdString();
+    filter.m_minDepth = m_minDepthSpin->value();
+    filter.m_maxDepth = m_maxDepthSpin->value();
+    filter.m_mode = m_modeCombo->currentData().toInt();
+
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<int> rows = m_index->query(filter, m_sortKey, m_sortAscending);
+    double queryTime = timer.nsecsElapsed() / 1.0e6;
+
+    m_model->setRows(m_index.get(), std::move(rows));
+    statusBar()->showMessage(QString("%1 of %2 plans (%3 ms)")
+        .arg(m_model->rowCount()).arg(m_index->entries().size()).arg(queryTime, 0, 'f', 3));
+
+    for (int row = 0; !selectedName.empty() && row < m_model->rowCount(); row++) {
+        if (m_model->entryAt(row)->m_fileName == selectedName) {
+            m_planTable->selectRow(row);
+            return;
+        }
+    }
+    showPreview(nullptr);
+}
+
+void PlanLibraryWindow::sortByColumn(int column) {
+    if (column < 0 || column >= NUM_PLAN_LIBRARY_COLUMNS) return;
+
+    // Clicking the sorted column again reverses the order
+    PlanIndexSortKey sortKey = COLUMN_SORT_KEYS[column];
+    m_sortAscending = (sortKey == m_sortKey) ? !m_sortAscending : true;
+    m_sortKey = sortKey;
+    m_planTable->horizontalHeader()->setSortIndicator(column, m_sortAscending ? Qt::AscendingOrder : Qt::DescendingOrder);
+
+    applyFilter();
+}
+
+// PREVIEW AND OPENING
+
+void PlanLibraryWindow::selectionChanged() {
+    showPreview(m_model->entryAt(m_planTable->currentIndex().row()));
+}
+
+void PlanLibraryWindow::showPreview(const PlanIndexEntry* entry) {
+    if (!entry) {
+        m_previewBrowser->clear();
+        return;
+    }
+
+    // Only the header, inputs and summary are read: the profiles stay on disk
+    DivePlanFileInputs inputs;
+    DivePlanFileSummary summary;
+    if (!readDivePlanFileSummary(m_index->filePath(*entry), inputs, summary)) {
+        m_previewBrowser->setHtml("<p>Could not read this plan.</p>");
+        return;
+    }
+
+    QString html;
+    html += QString("<h3>%1</h3>").arg(QString::fromStdString(entry->m_fileName).toHtmlEscaped());
+    html += QString("<p>%1 - GF %2/%3").arg(QString::fromStdString(getDiveModeString(static_cast<diveMode>(inputs.m_mode))))
+                                        .arg(inputs.m_gf[0], 0, 'f', 0).arg(inputs.m_gf[1], 0, 'f', 0);
+    if (inputs.m_bailout) html += " - bailout";
+    html += "</p>";
+
+    html += "<table>";
+    html += QString("<tr><td>Max depth</td><td>%1 m</td></tr>").arg(summary.m_maxDepth, 0, 'f', 0);
+    html += QString("<tr><td>Runtime</td><td>%1 min</td></tr>").arg(summary.m_runTime, 0, 'f', 0);
+    html += QString("<tr><td>TTS</td><td>%1 min</td></tr>").arg(summary.m_tts, 0, 'f', 0);
+    html += QString("<tr><td>\u0394 TTS +5min</td><td>%1 min</td></tr>").arg(summary.m_ttsDelta, 0, 'f', 0);
+    html += QString("<tr><td>Max time</td><td>%1 min</td></tr>").arg(summary.m_maxTime, 0, 'f', 0);
+    html += QString("<tr><td>Turn TTS</td><td>%1 min</td></tr>").arg(summary.m_turnTts, 0, 'f', 0);
+    html += "</table>";
+
+    html += "<h4>Stops</h4><table>";
+    for (const auto& stopStep : inputs.m_stopSteps) {
+        html += QString("<tr><td>%1 m</td><td>%2 min</td></tr>").arg(stopStep.first, 0, 'f', 0).arg(stopStep.second, 0, 'f', 0);
+    }
+    html += "</table>";
+
+    html += "<h4>Gases</h4><table>";
+    for (const auto& gas : inputs.m_gases) {
+        html += QString("<tr><td>%1/%2</td><td>%3</td><td>%4 x %5 l</td><td>%6 l</td><td>%7 bar</td></tr>")
+            .arg(gas.m_o2Percent, 0, 'f', 0).arg(gas.m_hePercent, 0, 'f', 0)
+            .arg(QString::fromStdString(getGasTypeString(static_cast<GasType>(gas.m_gasType))))
+            .arg(gas.m_nbTanks).arg(gas.m_tankCapacity, 0, 'f', 0)
+            .arg(gas.m_consumption, 0, 'f', 0).arg(gas.m_endPressure, 0, 'f', 0);
+    }
+    html += "</table>";
+
+    m_previewBrowser->setHtml(html);
+}
+
+void PlanLibraryWindow::openSelectedPlan() {
+    const PlanIndexEntry* entry = m_model->entryAt(m_planTable->currentIndex().row());
+    if (!entry) return;
+
+    emit openPlanRequested(QString::fromStdString(m_index->filePath(*entry)));
+}
+
+} // namespace DiveComputer
@@ -0,0 +1,80 @@
+#ifndef PLAN_LIBRARY_GUI_HPP
+#define PLAN_LIBRARY_GUI_HPP
+
+#include <memory>
+#include "qtheaders.hpp"
+#include "global.hpp"
+#include "plan_library.hpp"
+
+namespace DiveComputer {
+
+// Table model over the filtered and sorted rows of a PlanIndex
+class PlanLibraryModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    PlanLibraryModel(QObject *parent = nullptr) : QAbstractTableModel(parent) {}
+
+    void setRows(const PlanIndex* index, std::vector<int> rows);
+    const PlanIndexEntry* entryAt(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    const PlanIndex* m_index = nullptr;
+    std::vector<int> m_rows;
+};
+
+// Browser of the dive plans of a directory
+class PlanLibraryWindow : public QMainWindow {
+    Q_OBJECT
+
+public:
+    PlanLibraryWindow(QWidget *parent = nullptr);
+
+signals:
+    void openPlanRequested(const QString& filePath);
+
+private:
+    // Window size
+    const int preferredWidth = 1000;
+    const int preferredHeight = 600;
+
+    // UI elements
+    QLabel *m_directoryLabel;
+    QLineEdit *m_filterEdit;
+    QSpinBox *m_minDepthSpin;
+    QSpinBox *m_maxDepthSpin;
+    QComboBox *m_modeCombo;
+    QTableView *m_planTable;
+    QTextBrowser *m_previewBrowser;
+    PlanLibraryModel *m_model;
+
+    // Index and watcher of the current directory
+    std::unique_ptr<PlanIndex> m_index;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_rescanTimer;
+    PlanIndexSortKey m_sortKey = PlanIndexSortKey::DATE;
+    bool m_sortAscending = false;
+
+    void setupUI();
+    void setDirectory(const QString& directory);
+    void saveDirectory(const QString& directory);
+    QString loadDirectory();
+    void showPreview(const PlanIndexEntry* entry);
+
+private slots:
+    void chooseDirectory();
+    void rescan();
+    void applyFilter();
+    void sortByColumn(int column);
+    void selectionChanged();
+    void openSelectedPlan();
+};
+
+} // namespace DiveComputer
+
+#endif // PLAN_LIBRARY_GUI_HPP
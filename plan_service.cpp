@@ -0,0 +1,772 @@
+#include "plan_service.hpp"
+#include "compute_pool.hpp"
+#include "log_info.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// SIGPIPE is ignored instead where the flag does not exist
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace DiveComputer {
+
+namespace {
+
+// Set by SIGINT and SIGTERM
+std::atomic<bool> s_signalled{false};
+
+void onSignal(int) {
+    s_signalled = true;
+}
+
+// Longest request line accepted, a plan spec is far smaller
+constexpr size_t MAX_LINE_SIZE = 1024 * 1024;
+
+bool sendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+std::string trimLine(const std::string& line) {
+    size_t first = line.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    size_t last = line.find_last_not_of(" \t\r\n");
+    return line.substr(first, last - first + 1);
+}
+
+std::string toCompactJson(const QJsonObject& object) {
+    return QJsonDocument(object).toJson(QJsonDocument::Compact).toStdString();
+}
+
+// "id":<value>, ready to be put in a response; empty for a notification
+std::string idMember(const QJsonValue& id) {
+    if (id.isUndefined()) return "";
+    QJsonObject object;
+    object["id"] = id;
+    std::string text = toCompactJson(object);
+    return text.substr(1, text.size() - 2);
+}
+
+std::string errorValue(int code, const std::string& message) {
+    QJsonObject error;
+    error["code"] = code;
+    error["message"] = QString::fromStdString(message);
+    return toCompactJson(error);
+}
+
+// JSON-RPC error codes
+constexpr int PARSE_ERROR = -32700;
+constexpr int INVALID_REQUEST = -32600;
+constexpr int METHOD_NOT_FOUND = -32601;
+constexpr int INVALID_PARAMS = -32602;
+
+// Cache key: the inputs as bytes, so that identical plans match whatever the text of their spec,
+// and the parameters epoch, so that results of older parameters are never returned
+std::string inputsKey(const DivePlanFileInputs& inputs) {
+    ByteWriter writer;
+    writer.write(g_parameters.epoch());
+    writer.write(inputs.m_mode);
+    writer.write(static_cast<uint8_t>(inputs.m_bailout));
+    writer.write(static_cast<uint8_t>(inputs.m_boosted));
+    writer.write(inputs.m_diveNumber);
+    writer.write(inputs.m_mission);
+    writer.write(inputs.m_gf[0]);
+    writer.write(inputs.m_gf[1]);
+
+    writer.write(static_cast<uint32_t>(inputs.m_stopSteps.size()));
+    for (const auto& stopStep : inputs.m_stopSteps) {
+        writer.write(stopStep.first);
+        writer.write(stopStep.second);
+    }
+    writer.write(static_cast<uint32_t>(inputs.m_setPoints.size()));
+    for (const auto& setPoint : inputs.m_setPoints) {
+        writer.write(setPoint.first);
+        writer.write(setPoint.second);
+    }
+    writer.write(static_cast<uint32_t>(inputs.m_gases.size()));
+    for (const auto& gas : inputs.m_gases) {
+        writer.write(gas.m_o2Percent);
+        writer.write(gas.m_hePercent);
+        writer.write(gas.m_gasType);
+        writer.write(gas.m_gasStatus);
+        writer.write(gas.m_nbTanks);
+        writer.write(gas.m_tankCapacity);
+        writer.write(gas.m_fillingPressure);
+        writer.write(gas.m_reservePressure);
+    }
+    writer.write(static_cast<uint32_t>(inputs.m_initialPressure.size()));
+    for (const auto& pressure : inputs.m_initialPressure) {
+        writer.write(pressure.m_pN2);
+        writer.write(pressure.m_pHe);
+        writer.write(pressure.m_pInert);
+    }
+    writer.write(inputs.m_waterType);
+    writer.write(inputs.m_surfacePressure);
+    writer.write(static_cast<uint8_t>(inputs.m_waypoints));
+    return std::string(writer.buffer().begin(), writer.buffer().end());
+}
+
+int connectSocket(const std::string& socketPath, int tcpPort) {
+    if (!socketPath.empty()) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(tcpPort));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    int noDelay = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return fd;
+}
+
+} // namespace
+
+// LATENCY HISTOGRAM
+
+void LatencyHistogram::record(int64_t microseconds) {
+    int bucket = 0;
+    for (int64_t value = microseconds; value > 1 && bucket < NB_BUCKETS - 1; value >>= 1) {
+        ++bucket;
+    }
+    ++m_buckets[bucket];
+    ++m_count;
+    m_totalUs += std::max<int64_t>(0, microseconds);
+}
+
+int64_t LatencyHistogram::percentile(double fraction) const {
+    uint64_t count = m_count;
+    if (count == 0) return 0;
+
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * count + 0.5));
+    uint64_t cumulated = 0;
+    for (int i = 0; i < NB_BUCKETS; ++i) {
+        cumulated += m_buckets[i];
+        if (cumulated >= target) return int64_t(1) << (i + 1);
+    }
+    return int64_t(1) << NB_BUCKETS;
+}
+
+QJsonObject LatencyHistogram::toJson() const {
+    uint64_t count = m_count;
+    QJsonObject histogram;
+    histogram["count"] = static_cast<double>(count);
+    histogram["meanUs"] = count ? static_cast<double>(m_totalUs) / count : 0.0;
+    histogram["p50Us"] = static_cast<double>(percentile(0.50));
+    histogram["p90Us"] = static_cast<double>(percentile(0.90));
+    histogram["p99Us"] = static_cast<double>(percentile(0.99));
+
+    // [upper bound in us, count] of the buckets in use
+    QJsonArray buckets;
+    for (int i = 0; i < NB_BUCKETS; ++i) {
+        uint64_t bucketCount = m_buckets[i];
+        if (bucketCount == 0) continue;
+        buckets.append(QJsonArray{static_cast<double>(int64_t(1) << (i + 1)), static_cast<double>(bucketCount)});
+    }
+    histogram["buckets"] = buckets;
+    return histogram;
+}
+
+// CONNECTIONS
+
+struct PlanService::Connection {
+    int m_fd;
+    std::mutex m_writeMutex;
+    std::atomic<int> m_pending{0};        // requests read but not answered yet
+    std::atomic<bool> m_readDone{false};
+
+    explicit Connection(int fd) : m_fd(fd) {}
+    ~Connection() { ::close(m_fd); }
+
+    void send(const std::string& line) {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        sendAll(m_fd, line.data(), line.size());
+    }
+
+    // The client sees the end of the responses once it has sent all its requests
+    // and they have all been answered
+    void closeIfDone() {
+        if (m_readDone && m_pending == 0) {
+            ::shutdown(m_fd, SHUT_WR);
+        }
+    }
+};
+
+// SERVICE
+
+PlanService::PlanService(const PlanServiceOptions& options)
+    : m_options(options) {
+    m_options.m_threads = std::max(1, m_options.m_threads);
+    m_options.m_maxBatchSize = std::max<size_t>(1, m_options.m_maxBatchSize);
+}
+
+PlanService::~PlanService() {
+    stop();
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+    }
+}
+
+bool PlanService::openSocket() {
+    if (!m_options.m_socketPath.empty()) {
+        const std::string& path = m_options.m_socketPath;
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            m_error = "socket path too long: " + path;
+            return false;
+        }
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+        // Remove the socket of a previous run, but never another kind of file
+        struct stat info{};
+        if (::stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+            ::unlink(path.c_str());
+        }
+
+        m_listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_listenFd < 0 || ::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            m_error = "cannot bind " + path + ": " + std::strerror(errno);
+            return false;
+        }
+    } else {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(m_options.m_tcpPort));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        m_listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        if (m_listenFd >= 0) {
+            ::setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        }
+        if (m_listenFd < 0 || ::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            m_error = "cannot bind 127.0.0.1:" + std::to_string(m_options.m_tcpPort) + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+
+    if (::listen(m_listenFd, SOMAXCONN) != 0) {
+        m_error = std::string("cannot listen: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool PlanService::run() {
+    if (!openSocket()) {
+        logWrite("PlanService::run() ", m_error);
+        return false;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    logWrite("PlanService::run() listening on ",
+             m_options.m_socketPath.empty() ? "127.0.0.1:" + std::to_string(m_options.m_tcpPort) : m_options.m_socketPath,
+             " with ", m_options.m_threads, " threads");
+
+    m_dispatcher = std::thread(&PlanService::dispatchLoop, this);
+    acceptLoop();
+
+    ::close(m_listenFd);
+    m_listenFd = -1;
+    if (!m_options.m_socketPath.empty()) {
+        ::unlink(m_options.m_socketPath.c_str());
+    }
+
+    // Unblock the connection threads and wait for them, they use the service
+    {
+        std::unique_lock<std::mutex> lock(m_connectionsMutex);
+        for (const auto& connection : m_connections) {
+            ::shutdown(connection->m_fd, SHUT_RDWR);
+        }
+        m_connectionsDone.wait(lock, [this] { return m_connections.empty(); });
+    }
+    stop();
+
+    logWrite("PlanService::run() stopped: ", statsJson());
+    return true;
+}
+
+void PlanService::stop() {
+    // Called by run() once the signals stopped it, by other threads and by the destructor:
+    // the dispatcher is joined once, the other calls wait for that
+    std::call_once(m_stopOnce, [this]() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_jobReady.notify_all();
+        if (m_dispatcher.joinable()) {
+            m_dispatcher.join();
+            ComputePool::instance().release(this);
+        }
+    });
+}
+
+void PlanService::acceptLoop() {
+    while (!m_stop && !s_signalled) {
+        pollfd listening{m_listenFd, POLLIN, 0};
+        if (::poll(&listening, 1, 200) <= 0) continue;
+
+        int fd = ::accept(m_listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        // Responses are single small writes, they should not wait for more data
+        if (m_options.m_socketPath.empty()) {
+            int noDelay = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
+
+        auto connection = std::make_shared<Connection>(fd);
+        {
+            std::lock_guard<std::mutex> lock(m_connectionsMutex);
+            m_connections.insert(connection);
+        }
+        std::thread(&PlanService::serveConnection, this, connection).detach();
+    }
+}
+
+void PlanService::serveConnection(std::shared_ptr<Connection> connection) {
+    std::string buffer;
+    char chunk[65536];
+
+    while (true) {
+        ssize_t received = ::recv(connection->m_fd, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        buffer.append(chunk, static_cast<size_t>(received));
+
+        size_t start = 0;
+        for (size_t end = buffer.find('\n'); end != std::string::npos; end = buffer.find('\n', start)) {
+            std::string line = trimLine(buffer.substr(start, end - start));
+            start = end + 1;
+            if (!line.empty()) {
+                handleRequest(connection, line);
+            }
+        }
+        buffer.erase(0, start);
+
+        if (buffer.size() > MAX_LINE_SIZE) {
+            connection->send("{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":" + errorValue(INVALID_REQUEST, "request too long") + "}\n");
+            break;
+        }
+    }
+
+    connection->m_readDone = true;
+    connection->closeIfDone();
+
+    std::lock_guard<std::mutex> lock(m_connectionsMutex);
+    m_connections.erase(connection);
+    m_connectionsDone.notify_all();
+}
+
+void PlanService::handleRequest(const std::shared_ptr<Connection>& connection, const std::string& line) {
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromStdString(line), &parseError);
+    if (parseError.error != QJsonParseError::NoError || document.isNull()) {
+        Waiter waiter;
+        waiter.m_timer.start();
+        waiter.m_connection = connection;
+        waiter.m_idText = "\"id\":null";
+        ++connection->m_pending;
+        ++m_invalidRequests;
+        respond(waiter, "error", errorValue(PARSE_ERROR, "invalid JSON: " + parseError.errorString().toStdString()));
+        return;
+    }
+
+    if (document.isObject()) {
+        handleCall(connection, document.object(), nullptr);
+        return;
+    }
+
+    // A batch: every request is handled on its own, the responses are gathered. An empty
+    // batch is a single invalid request.
+    QJsonArray calls = document.array();
+    auto batch = calls.isEmpty() ? nullptr : std::make_shared<RequestBatch>();
+    if (batch) {
+        batch->m_remaining = static_cast<size_t>(calls.size());
+        for (const QJsonValue& call : calls) {
+            handleCall(connection, call, batch);
+        }
+    } else {
+        handleCall(connection, QJsonValue(), nullptr);
+    }
+}
+
+void PlanService::handleCall(const std::shared_ptr<Connection>& connection, const QJsonValue& call,
+                             const std::shared_ptr<RequestBatch>& batch) {
+    Waiter waiter;
+    waiter.m_timer.start();
+    waiter.m_connection = connection;
+    waiter.m_batch = batch;
+    waiter.m_idText = "\"id\":null";
+    ++connection->m_pending;
+
+    if (!call.isObject()) {
+        ++m_invalidRequests;
+        respond(waiter, "error", errorValue(INVALID_REQUEST, "expected a JSON-RPC 2.0 request"));
+        return;
+    }
+
+    QJsonObject request = call.toObject();
+    waiter.m_idText = idMember(request.value("id"));
+    std::string method = request.value("method").toString().toStdString();
+
+    if (request.value("jsonrpc").toString() != "2.0" || method.empty()) {
+        ++m_invalidRequests;
+        respond(waiter, "error", errorValue(INVALID_REQUEST, "expected a JSON-RPC 2.0 request"));
+    } else if (method == "plan") {
+        QJsonValue params = request.value("params");
+        if (!params.isObject()) {
+            ++m_invalidRequests;
+            respond(waiter, "error", errorValue(INVALID_PARAMS, "params must be a plan spec object"));
+            return;
+        }
+        // A CSV spec, or the object itself as a JSON spec
+        QJsonObject spec = params.toObject();
+        QJsonValue csv = spec.value("csv");
+        handlePlan(std::move(waiter), csv.isString() ? csv.toString().toStdString() : toCompactJson(spec));
+    } else if (method == "stats") {
+        ++m_statsRequests;
+        respond(waiter, "result", statsJson());
+        m_statsLatency.record(waiter.m_timer.nsecsElapsed() / 1000);
+    } else {
+        ++m_invalidRequests;
+        respond(waiter, "error", errorValue(METHOD_NOT_FOUND, "unknown method: " + method));
+    }
+}
+
+void PlanService::handlePlan(Waiter waiter, const std::string& specLine) {
+    ++m_planRequests;
+
+    PlanSpec spec;
+    if (!parsePlanSpec(specLine, spec)) {
+        ++m_invalidRequests;
+        respond(waiter, "error", errorValue(INVALID_PARAMS, "empty plan spec"));
+        return;
+    }
+    if (!spec.m_error.empty()) {
+        ++m_invalidRequests;
+        respond(waiter, "error", errorValue(INVALID_PARAMS, spec.m_error));
+        return;
+    }
+
+    // The result is shared by all requests with the same inputs, whatever their id
+    spec.m_id.clear();
+    std::string key = inputsKey(spec.m_inputs);
+
+    std::string cached;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto entry = m_cacheIndex.find(key);
+        if (entry != m_cacheIndex.end()) {
+            m_cache.splice(m_cache.begin(), m_cache, entry->second);
+            cached = entry->second->m_result;
+        } else {
+            auto computing = m_inFlight.find(key);
+            if (computing != m_inFlight.end()) {
+                ++m_coalesced;
+                computing->second.push_back(std::move(waiter));
+                return;
+            }
+            m_inFlight[key].push_back(std::move(waiter));
+            m_jobs.push_back(Job{key, std::move(spec)});
+        }
+    }
+
+    if (cached.empty()) {
+        m_jobReady.notify_one();
+        return;
+    }
+
+    ++m_cacheHits;
+    respond(waiter, "result", cached);
+    m_cachedLatency.record(waiter.m_timer.nsecsElapsed() / 1000);
+}
+
+void PlanService::respond(const Waiter& waiter, const std::string& member, const std::string& value) {
+    // Notifications get no response
+    std::string response;
+    if (!waiter.m_idText.empty()) {
+        response = "{\"jsonrpc\":\"2.0\"," + waiter.m_idText + ",\"" + member + "\":" + value + "}";
+    }
+
+    if (waiter.m_batch) {
+        // The last response of a batch sends them all, as one array
+        std::string responses;
+        {
+            std::lock_guard<std::mutex> lock(waiter.m_batch->m_mutex);
+            if (!response.empty()) {
+                waiter.m_batch->m_responses.push_back(std::move(response));
+            }
+            if (--waiter.m_batch->m_remaining == 0 && !waiter.m_batch->m_responses.empty()) {
+                for (const std::string& batched : waiter.m_batch->m_responses) {
+                    responses += (responses.empty() ? "[" : ",") + batched;
+                }
+                responses += "]";
+            }
+        }
+        if (!responses.empty()) {
+            waiter.m_connection->send(responses + "\n");
+        }
+    } else if (!response.empty()) {
+        waiter.m_connection->send(response + "\n");
+    }
+    --waiter.m_connection->m_pending;
+    waiter.m_connection->closeIfDone();
+}
+
+// BATCHES
+
+void PlanService::dispatchLoop() {
+    std::vector<Job> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobReady.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+            if (m_stop) break;
+
+            // Give the requests arriving together a moment to join the batch
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(m_options.m_batchWindowUs);
+            m_jobReady.wait_until(lock, deadline, [this] {
+                return m_stop || m_jobs.size() >= m_options.m_maxBatchSize;
+            });
+
+            size_t batchSize = std::min(m_jobs.size(), m_options.m_maxBatchSize);
+            for (size_t i = 0; i < batchSize; ++i) {
+                batch.push_back(std::move(m_jobs.front()));
+                m_jobs.pop_front();
+            }
+        }
+
+        computeBatch(batch);
+        batch.clear();
+    }
+}
+
+void PlanService::computeBatch(std::vector<Job>& batch) {
+    ++m_batches;
+    uint64_t maxBatch = m_maxBatch;
+    while (batch.size() > maxBatch && !m_maxBatch.compare_exchange_weak(maxBatch, batch.size())) {
+    }
+
+    // The plans are computed on the compute pool of the process, by at most m_threads tasks
+    // taking the jobs in turn. Each result is sent as soon as it is computed, not at the end
+    // of the batch. The dispatcher is not a pool thread, so it can wait for the tasks.
+    std::atomic<size_t> nextJob{0};
+    auto worker = [this, &batch, &nextJob]() {
+        for (size_t i = nextJob++; i < batch.size(); i = nextJob++) {
+            std::string result;
+            computePlanResult(batch[i].m_spec, BatchFormat::NDJSON, result);
+            finishJob(batch[i].m_key, result);
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    size_t nbWorkers = std::min<size_t>(m_options.m_threads, batch.size());
+    for (size_t i = 0; i < nbWorkers; ++i) {
+        workers.push_back(ComputePool::instance().submit(worker, this));
+    }
+    for (auto& done : workers) {
+        done.wait();
+    }
+}
+
+void PlanService::finishJob(const std::string& key, const std::string& result) {
+    std::vector<Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_options.m_cacheSize > 0) {
+            m_cache.push_front(CacheEntry{key, result});
+            m_cacheIndex[key] = m_cache.begin();
+            if (m_cache.size() > m_options.m_cacheSize) {
+                m_cacheIndex.erase(m_cache.back().m_key);
+                m_cache.pop_back();
+            }
+        }
+        auto computing = m_inFlight.find(key);
+        if (computing != m_inFlight.end()) {
+            waiters.swap(computing->second);
+            m_inFlight.erase(computing);
+        }
+    }
+
+    ++m_computed;
+    for (const Waiter& waiter : waiters) {
+        respond(waiter, "result", result);
+        m_computedLatency.record(waiter.m_timer.nsecsElapsed() / 1000);
+    }
+}
+
+std::string PlanService::statsJson() const {
+    size_t cacheEntries = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        cacheEntries = m_cache.size();
+    }
+    uint64_t batches = m_batches;
+    uint64_t computed = m_computed;
+
+    QJsonObject requests;
+    requests["plan"] = static_cast<double>(m_planRequests);
+    requests["stats"] = static_cast<double>(m_statsRequests);
+    requests["invalid"] = static_cast<double>(m_invalidRequests);
+
+    QJsonObject cache;
+    cache["entries"] = static_cast<double>(cacheEntries);
+    cache["capacity"] = static_cast<double>(m_options.m_cacheSize);
+    cache["hits"] = static_cast<double>(m_cacheHits);
+    cache["coalesced"] = static_cast<double>(m_coalesced);
+    cache["computed"] = static_cast<double>(computed);
+
+    QJsonObject batchStats;
+    batchStats["count"] = static_cast<double>(batches);
+    batchStats["meanSize"] = batches ? static_cast<double>(computed) / batches : 0.0;
+    batchStats["maxSize"] = static_cast<double>(m_maxBatch);
+
+    // Time from reading the request to writing its response
+    QJsonObject latency;
+    latency["computed"] = m_computedLatency.toJson();
+    latency["cached"] = m_cachedLatency.toJson();
+    latency["stats"] = m_statsLatency.toJson();
+
+    QJsonObject stats;
+    stats["requests"] = requests;
+    stats["cache"] = cache;
+    stats["batches"] = batchStats;
+    stats["latency"] = latency;
+    return toCompactJson(stats);
+}
+
+// CLIENT
+
+int runPlanClient(const std::string& socketPath, int tcpPort, std::istream& in, std::ostream& out) {
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int fd = connectSocket(socketPath, tcpPort);
+    if (fd < 0) {
+        std::string address = socketPath.empty() ? "127.0.0.1:" + std::to_string(tcpPort) : socketPath;
+        std::cerr << "Cannot connect to " << address << ": " << std::strerror(errno) << "\n";
+        return 2;
+    }
+
+    // Responses are written as they come, while the requests are still being sent
+    std::atomic<int> failed{0};
+    std::thread reader([&]() {
+        std::string buffer;
+        char chunk[65536];
+        while (true) {
+            ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0) break;
+            buffer.append(chunk, static_cast<size_t>(received));
+
+            size_t start = 0;
+            for (size_t end = buffer.find('\n'); end != std::string::npos; end = buffer.find('\n', start)) {
+                std::string line = buffer.substr(start, end - start);
+                start = end + 1;
+                // A response, or the array of the responses of a batch
+                QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromStdString(line));
+                QJsonArray responses = document.isArray() ? document.array() : QJsonArray{document.object()};
+                for (const QJsonValue& value : responses) {
+                    QJsonObject response = value.toObject();
+                    if (response.contains("error") || response.value("result").toObject().value("ok").toBool(true) == false) {
+                        ++failed;
+                    }
+                }
+                out << line << '\n';
+            }
+            buffer.erase(0, start);
+            out.flush();
+        }
+    });
+
+    std::string line;
+    int sequence = 0;
+    bool sent = true;
+    while (sent && std::getline(in, line)) {
+        std::string text = trimLine(line);
+        if (text.empty() || text[0] == '#' || text.compare(0, 3, "id,") == 0) continue;
+        ++sequence;
+
+        QJsonObject request;
+        QJsonObject object = QJsonDocument::fromJson(QByteArray::fromStdString(text)).object();
+        if ((text[0] == '{' && object.contains("method")) || text[0] == '[') {
+            // Already a request, or a batch of them
+            sent = sendAll(fd, text.data(), text.size()) && sendAll(fd, "\n", 1);
+            continue;
+        } else if (text[0] == '{') {
+            request["id"] = object.contains("id") ? object.value("id") : QJsonValue(sequence);
+            request["params"] = object;
+        } else {
+            // CSV: the id is the first column
+            std::string id = trimLine(text.substr(0, text.find(',')));
+            request["id"] = id.empty() ? QJsonValue(sequence) : QJsonValue(QString::fromStdString(id));
+            QJsonObject params;
+            params["csv"] = QString::fromStdString(text);
+            request["params"] = params;
+        }
+        request["jsonrpc"] = "2.0";
+        request["method"] = "plan";
+
+        std::string requestLine = toCompactJson(request) + "\n";
+        sent = sendAll(fd, requestLine.data(), requestLine.size());
+    }
+
+    // The service closes its side once everything sent has been answered
+    ::shutdown(fd, SHUT_WR);
+    reader.join();
+    ::close(fd);
+
+    if (!sent) {
+        std::cerr << "Connection lost while sending requests\n";
+        return 2;
+    }
+    return failed > 0 ? 1 : 0;
+}
+
+} // namespace DiveComputer
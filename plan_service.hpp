@@ -0,0 +1,162 @@
+#ifndef PLAN_SERVICE_HPP
+#define PLAN_SERVICE_HPP
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iosfwd>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include "batch_planner.hpp"
+
+namespace DiveComputer {
+
+// Local planning service, for tools that plan many dives without starting a process each time.
+//
+// Requests are JSON-RPC 2.0 objects, one per line, over a Unix domain socket or a
+// localhost TCP port (POSIX sockets):
+//   {"jsonrpc": "2.0", "id": 1, "method": "plan", "params": {"stops": [[40, 25]], "gf": [30, 80]}}
+//   {"jsonrpc": "2.0", "id": 2, "method": "plan", "params": {"csv": ",OC,30,80,40:25,21/35"}}
+//   {"jsonrpc": "2.0", "id": 3, "method": "stats"}
+// The params of "plan" are a plan spec of the batch planner (see batch_planner.hpp), and its
+// result is the NDJSON result line of the batch planner, "ok": false included. Malformed
+// requests get a JSON-RPC error. Responses are written as soon as they are ready, so they
+// may come out of order on a connection. A JSON-RPC batch, an array of requests on one line,
+// is answered by one array of their responses, in the order they are ready, once all of them
+// are; a batch of notifications only is not answered.
+//
+// Plan requests of all connections are gathered into batches computed on the compute pool.
+// Identical inputs are computed once: the results are kept in a shared LRU cache, and
+// requests for inputs already being computed wait for that result.
+
+struct PlanServiceOptions {
+    std::string m_socketPath;     // Unix domain socket, or
+    int m_tcpPort{0};             // port on 127.0.0.1 when there is no socket path
+    int m_threads{1};             // pool tasks computing a batch at once
+    size_t m_cacheSize{4096};     // number of results kept
+    int m_batchWindowUs{2000};    // time given to a batch to fill after its first request
+    size_t m_maxBatchSize{64};
+};
+
+// Latency counts in power of two buckets of microseconds: bucket i holds [2^i, 2^(i+1))
+class LatencyHistogram {
+public:
+    static constexpr int NB_BUCKETS = 32;
+
+    void record(int64_t microseconds);
+    uint64_t count() const { return m_count; }
+    // Upper bound of the bucket holding the given fraction of the requests
+    int64_t percentile(double fraction) const;
+    QJsonObject toJson() const;
+
+private:
+    std::array<std::atomic<uint64_t>, NB_BUCKETS> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<int64_t> m_totalUs{0};
+};
+
+class PlanService {
+public:
+    explicit PlanService(const PlanServiceOptions& options);
+    ~PlanService();
+
+    // Serves until stop(), SIGINT or SIGTERM. False if the socket could not be opened.
+    bool run();
+    void stop();
+
+    std::string statsJson() const;
+    const std::string& error() const { return m_error; }
+
+private:
+    struct Connection;
+
+    // Responses of a JSON-RPC batch, sent together when the last one is ready
+    struct RequestBatch {
+        std::mutex m_mutex;
+        std::vector<std::string> m_responses;
+        size_t m_remaining{0};
+    };
+
+    // Request waiting for the result of a plan
+    struct Waiter {
+        std::shared_ptr<Connection> m_connection;
+        std::shared_ptr<RequestBatch> m_batch;    // null outside a batch
+        std::string m_idText;     // "id":<value> of the request
+        QElapsedTimer m_timer;    // started when the request was read
+    };
+
+    struct Job {
+        std::string m_key;
+        PlanSpec m_spec;
+    };
+
+    // Cached results, most recently used first
+    struct CacheEntry {
+        std::string m_key;
+        std::string m_result;
+    };
+
+    PlanServiceOptions m_options;
+    int m_listenFd{-1};
+    std::string m_error;
+    std::atomic<bool> m_stop{false};
+    std::once_flag m_stopOnce;
+
+    // Plan requests: cache, requests being computed and queue of the dispatcher
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobReady;
+    std::list<CacheEntry> m_cache;
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> m_cacheIndex;
+    std::unordered_map<std::string, std::vector<Waiter>> m_inFlight;
+    std::deque<Job> m_jobs;
+    std::thread m_dispatcher;
+
+    // Open connections, shut down on stop
+    std::mutex m_connectionsMutex;
+    std::condition_variable m_connectionsDone;
+    std::set<std::shared_ptr<Connection>> m_connections;
+
+    // Statistics
+    std::atomic<uint64_t> m_planRequests{0};
+    std::atomic<uint64_t> m_statsRequests{0};
+    std::atomic<uint64_t> m_invalidRequests{0};
+    std::atomic<uint64_t> m_cacheHits{0};
+    std::atomic<uint64_t> m_coalesced{0};
+    std::atomic<uint64_t> m_computed{0};
+    std::atomic<uint64_t> m_batches{0};
+    std::atomic<uint64_t> m_maxBatch{0};
+    LatencyHistogram m_computedLatency;
+    LatencyHistogram m_cachedLatency;
+    LatencyHistogram m_statsLatency;
+
+    bool openSocket();
+    void acceptLoop();
+    void serveConnection(std::shared_ptr<Connection> connection);
+    void handleRequest(const std::shared_ptr<Connection>& connection, const std::string& line);
+    void handleCall(const std::shared_ptr<Connection>& connection, const QJsonValue& call,
+                    const std::shared_ptr<RequestBatch>& batch);
+    void handlePlan(Waiter waiter, const std::string& specLine);
+    void dispatchLoop();
+    void computeBatch(std::vector<Job>& batch);
+    void finishJob(const std::string& key, const std::string& result);
+    void respond(const Waiter& waiter, const std::string& member, const std::string& value);
+};
+
+// Sends each line of in to the service and writes the responses to out, until the service
+// has answered them all. JSON-RPC requests are sent as they are, other lines are plan specs
+// (JSON or CSV) sent as "plan" requests with the spec id as request id.
+// Returns the process exit code.
+int runPlanClient(const std::string& socketPath, int tcpPort, std::istream& in, std::ostream& out);
+
+} // namespace DiveComputer
+
+#endif // PLAN_SERVICE_HPP
@@ -0,0 +1,231 @@
+#include "plan_speculator.hpp"
+#include "compute_pool.hpp"
+#include "log_info.hpp"
+
+namespace DiveComputer {
+
+namespace {
+
+// Edits tried on each plan
+constexpr double STOP_TIME_DELTA = 3.0;     // min
+constexpr double STOP_DEPTH_DELTA = 3.0;    // m
+constexpr double GF_DELTA = 5.0;
+constexpr int    MIN_TANKS = 1;             // as accepted by the gas table
+constexpr int    MAX_TANKS = 20;
+
+} // namespace
+
+// RESULT CACHE
+
+std::shared_ptr<const DivePlan> PlanResultCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto entry = m_cacheIndex.find(key);
+    if (entry == m_cacheIndex.end()) {
+        return nullptr;
+    }
+
+    // Calculated before a change of the parameters
+    if (entry->second->m_plan->parametersEpoch() != g_parameters.epoch()) {
+        m_cache.erase(entry->second);
+        m_cacheIndex.erase(entry);
+        return nullptr;
+    }
+    m_cache.splice(m_cache.begin(), m_cache, entry->second);
+    return entry->second->m_plan;
+}
+
+bool PlanResultCache::contains(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto entry = m_cacheIndex.find(key);
+    return entry != m_cacheIndex.end() && entry->second->m_plan->parametersEpoch() == g_parameters.epoch();
+}
+
+void PlanResultCache::insert(const std::string& key, std::shared_ptr<const DivePlan> plan) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_capacity == 0) {
+        return;
+    }
+
+    // A plan of the current parameters replaces one of older parameters
+    auto entry = m_cacheIndex.find(key);
+    if (entry != m_cacheIndex.end()) {
+        if (entry->second->m_plan->parametersEpoch() == plan->parametersEpoch()) {
+            return;
+        }
+        m_cache.erase(entry->second);
+        m_cacheIndex.erase(entry);
+    }
+    m_cache.push_front(CacheEntry{key, std::move(plan)});
+    m_cacheIndex[key] = m_cache.begin();
+    if (m_cache.size() > m_capacity) {
+        m_cacheIndex.erase(m_cache.back().m_key);
+        m_cache.pop_back();
+    }
+}
+
+void PlanResultCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cache.clear();
+    m_cacheIndex.clear();
+}
+
+// SPECULATOR
+
+PlanSpeculator::PlanSpeculator(PlanResultCache& cache)
+    : m_cache(cache) {
+    ComputePool::instance().setPriority(this, ComputePriority::BACKGROUND);
+}
+
+PlanSpeculator::~PlanSpeculator() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation++;
+    }
+    ComputePool::instance().release(this);
+}
+
+void PlanSpeculator::speculate(const DivePlan& plan) {
+    // Copied here, the plan of the window changes as soon as this returns
+    auto basePlan = std::make_shared<const DivePlan>(plan);
+    cancel();
+
+    // The plan itself, for the edits coming back to it
+    std::string baseKey = basePlan->inputsKey();
+    if (!m_cache.contains(baseKey)) {
+        m_cache.insert(baseKey, basePlan);
+    }
+
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_variants = variantsOf(*basePlan);
+        m_basePlan = std::move(basePlan);
+        m_nextVariant = 0;
+        m_computed = 0;
+        m_timer.start();
+        generation = m_generation;
+    }
+    ComputePool::instance().submit([this, generation]() { calculateNext(generation); }, this);
+}
+
+void PlanSpeculator::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation++;
+    }
+    ComputePool::instance().cancel(this);
+}
+
+void PlanSpeculator::calculateNext(uint64_t generation) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_generation == generation && m_nextVariant < m_variants.size()) {
+        PlanVariant variant = m_variants[m_nextVariant++];
+        auto plan = std::make_shared<DivePlan>(*m_basePlan);
+        lock.unlock();
+
+        // Keyed before the calculation, as the window looks it up after the edit
+        std::string key;
+        bool calculated = false;
+        if (applyVariant(*plan, variant)) {
+            key = plan->inputsKey();
+            if (!m_cache.contains(key)) {
+                calculateVariant(*plan, variant);
+                m_cache.insert(key, std::move(plan));
+                calculated = true;
+            }
+        }
+
+        lock.lock();
+        if (calculated) {
+            // One variant per task: the windows get the threads in between
+            m_computed++;
+            if (m_generation == generation && m_nextVariant < m_variants.size()) {
+                ComputePool::instance().submit([this, generation]() { calculateNext(generation); }, this);
+                return;
+            }
+            break;
+        }
+    }
+
+    if (m_generation == generation && m_computed > 0) {
+        logWrite("PlanSpeculator: ", m_computed, " variants calculated in ", m_timer.elapsed(), " ms");
+    }
+}
+
+std::vector<PlanVariant> PlanSpeculator::variantsOf(const DivePlan& plan) {
+    std::vector<PlanVariant> variants;
+    const int nbStopSteps = static_cast<int>(plan.m_stopSteps.m_stopSteps.size());
+
+    for (int i = 0; i < nbStopSteps; i++) {
+        variants.push_back({PlanVariant::Edit::STOP_TIME, i, STOP_TIME_DELTA});
+        variants.push_back({PlanVariant::Edit::STOP_TIME, i, -STOP_TIME_DELTA});
+    }
+    for (int i = 0; i < nbStopSteps; i++) {
+        variants.push_back({PlanVariant::Edit::STOP_DEPTH, i, STOP_DEPTH_DELTA});
+        variants.push_back({PlanVariant::Edit::STOP_DEPTH, i, -STOP_DEPTH_DELTA});
+    }
+    for (PlanVariant::Edit edit : {PlanVariant::Edit::GF_LOW, PlanVariant::Edit::GF_HIGH}) {
+        variants.push_back({edit, 0, GF_DELTA});
+        variants.push_back({edit, 0, -GF_DELTA});
+    }
+    for (int i = 0; i < static_cast<int>(plan.m_gasAvailable.size()); i++) {
+        variants.push_back({PlanVariant::Edit::TANKS, i, 1});
+        variants.push_back({PlanVariant::Edit::TANKS, i, -1});
+    }
+    return variants;
+}
+
+bool PlanSpeculator::applyVariant(DivePlan& plan, const PlanVariant& variant) {
+    switch (variant.m_edit) {
+        case PlanVariant::Edit::STOP_TIME: {
+            const StopStep& stop = plan.m_stopSteps.m_stopSteps[variant.m_index];
+            double time = stop.m_time + variant.m_delta;
+            if (time < 0) return false;
+            plan.m_stopSteps.editStopStep(variant.m_index, stop.m_depth, time);
+            return true;
+        }
+        case PlanVariant::Edit::STOP_DEPTH: {
+            const StopStep& stop = plan.m_stopSteps.m_stopSteps[variant.m_index];
+            double depth = stop.m_depth + variant.m_delta;
+            if (depth <= 0) return false;
+            plan.m_stopSteps.editStopStep(variant.m_index, depth, stop.m_time);
+            return true;
+        }
+        case PlanVariant::Edit::GF_LOW:
+        case PlanVariant::Edit::GF_HIGH: {
+            int k = (variant.m_edit == PlanVariant::Edit::GF_LOW) ? 0 : 1;
+            double gf = plan.m_gf[k] + variant.m_delta;
+            if (gf <= 0 || gf > 100) return false;
+            plan.m_gf[k] = gf;
+            return plan.m_gf[0] <= plan.m_gf[1];
+        }
+        case PlanVariant::Edit::TANKS: {
+            GasAvailable& gas = plan.m_gasAvailable[variant.m_index];
+            int nbTanks = gas.m_nbTanks + static_cast<int>(variant.m_delta);
+            if (nbTanks < MIN_TANKS || nbTanks > MAX_TANKS) return false;
+            gas.m_nbTanks = nbTanks;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PlanSpeculator::calculateVariant(DivePlan& plan, const PlanVariant& variant) {
+    switch (variant.m_edit) {
+        case PlanVariant::Edit::STOP_TIME:
+        case PlanVariant::Edit::STOP_DEPTH:
+            plan.buildDivePlan();
+            plan.calculateDivePlan(false);
+            break;
+        case PlanVariant::Edit::GF_LOW:
+        case PlanVariant::Edit::GF_HIGH:
+            plan.calculateDivePlan(false);
+            break;
+        case PlanVariant::Edit::TANKS:
+            break;
+    }
+    plan.calculateGasConsumption(false);
+    plan.calculateDiveSummary(false);
+}
+
+} // namespace DiveComputer
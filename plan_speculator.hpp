@@ -0,0 +1,97 @@
+#ifndef PLAN_SPECULATOR_HPP
+#define PLAN_SPECULATOR_HPP
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "dive_plan.hpp"
+
+namespace DiveComputer {
+
+// Calculated plans by inputs key (DivePlan::inputsKey), most recently used first.
+// The plans are complete, summary included, and never modified once cached. Plans
+// calculated with other parameters than the current ones are never returned.
+class PlanResultCache {
+public:
+    explicit PlanResultCache(size_t capacity) : m_capacity(capacity) {}
+
+    std::shared_ptr<const DivePlan> find(const std::string& key);
+    bool contains(const std::string& key) const;
+    void insert(const std::string& key, std::shared_ptr<const DivePlan> plan);
+    void clear();
+
+private:
+    struct CacheEntry {
+        std::string m_key;
+        std::shared_ptr<const DivePlan> m_plan;
+    };
+
+    size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::list<CacheEntry> m_cache;
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> m_cacheIndex;
+};
+
+// Edit of a plan tried ahead of the user
+struct PlanVariant {
+    enum class Edit {
+        STOP_TIME,     // time of a stop step, then rebuilt
+        STOP_DEPTH,    // depth of a stop step, then rebuilt
+        GF_LOW,        // then calculated
+        GF_HIGH,
+        TANKS,         // number of tanks of a gas, then consumption and summary only
+    };
+
+    Edit   m_edit;
+    int    m_index;    // stop step or gas
+    double m_delta;
+};
+
+// Idle-time planner of the edits most often tried on a displayed plan: bottom time and depth
+// of each stop step +-3, GF low and high +-5 and one tank more or less of each gas. They are
+// calculated on a copy of the plan, one variant per task of the compute pool at background
+// priority, the way the plan window would calculate them, and kept in the result cache: the
+// next common edit only copies its result. A new plan or cancel() drops the variants not
+// calculated yet.
+class PlanSpeculator {
+public:
+    explicit PlanSpeculator(PlanResultCache& cache);
+    ~PlanSpeculator();
+
+    // Precomputes the variants of the plan, instead of those of the previous one
+    void speculate(const DivePlan& plan);
+
+    // Drops the variants not calculated yet; returns once no task uses the plans,
+    // so the globals the calculation reads can be changed
+    void cancel();
+
+    // Variants of a plan, the most likely edits first
+    static std::vector<PlanVariant> variantsOf(const DivePlan& plan);
+
+private:
+    PlanResultCache& m_cache;
+
+    // Variants left, read by one task at a time
+    std::mutex m_mutex;
+    std::shared_ptr<const DivePlan> m_basePlan;
+    std::vector<PlanVariant> m_variants;
+    size_t m_nextVariant{0};
+    int m_computed{0};
+    CoreTimer m_timer;
+    uint64_t m_generation{0};    // incremented by speculate() and cancel()
+
+    void calculateNext(uint64_t generation);
+
+    // Edit of a calculated plan, false if the edited value is out of range, and the
+    // calculation that follows the edit in the plan window
+    static bool applyVariant(DivePlan& plan, const PlanVariant& variant);
+    static void calculateVariant(DivePlan& plan, const PlanVariant& variant);
+};
+
+} // namespace DiveComputer
+
+#endif // PLAN_SPECULATOR_HPP
@@ -0,0 +1,40 @@
+#include "plot_lod.hpp"
+
+namespace DiveComputer {
+
+PlotLod::PlotLod(const QSharedPointer<QCPGraphDataContainer>& data) {
+    m_levels.push_back(data);
+
+    // Each level from the one below, every 4 points reduced to the lowest and the highest,
+    // from the points of the series in key order
+    QVector<QCPGraphData> points;
+    points.reserve(data->size());
+    for (auto it = data->constBegin(); it != data->constEnd(); ++it) {
+        points.append(*it);
+    }
+
+    while (points.size() > LOD_MIN_LEVEL_POINTS) {
+        points = decimateMinMax(points, [](const QCPGraphData& point) { return point.value; });
+        auto level = QSharedPointer<QCPGraphDataContainer>::create();
+        level->set(points, true);
+        m_levels.push_back(level);
+    }
+}
+
+QSharedPointer<QCPGraphDataContainer> PlotLod::levelFor(const QCPRange& keyRange, int pixelWidth) const {
+    if (m_levels.empty()) {
+        return QSharedPointer<QCPGraphDataContainer>::create();
+    }
+
+    // From the coarsest level, the first one with enough points in view
+    for (int level = levelCount() - 1; level > 0; level--) {
+        const QCPGraphDataContainer& data = *m_levels[level];
+        int visible = static_cast<int>(data.findEnd(keyRange.upper) - data.findBegin(keyRange.lower));
+        if (visible >= 2 * pixelWidth) {
+            return m_levels[level];
+        }
+    }
+    return m_levels.front();
+}
+
+} // namespace DiveComputer
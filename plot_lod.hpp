@@ -0,0 +1,32 @@
+#ifndef PLOT_LOD_HPP
+#define PLOT_LOD_HPP
+
+#include <vector>
+#include "qcustomplot.hpp"
+#include "lod_levels.hpp"
+
+namespace DiveComputer {
+
+// Min/max decimation pyramid of a series sorted by key, for the plots of long dives.
+// Level 0 is the series itself. Each level above keeps the lowest and the highest point of every
+// 4 points of the level below, in key order: half the points, and no peak lost when zoomed out.
+// The series against time are densified (see lod_levels.hpp) so that a dive has levels to show.
+class PlotLod {
+public:
+    PlotLod() = default;
+    explicit PlotLod(const QSharedPointer<QCPGraphDataContainer>& data);
+
+    // Coarsest level keeping a lowest and a highest point per pixel over the key range
+    QSharedPointer<QCPGraphDataContainer> levelFor(const QCPRange& keyRange, int pixelWidth) const;
+
+    const QSharedPointer<QCPGraphDataContainer>& data() const { return m_levels.front(); }
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    bool empty() const { return m_levels.empty(); }
+
+private:
+    std::vector<QSharedPointer<QCPGraphDataContainer>> m_levels;
+};
+
+} // namespace DiveComputer
+
+#endif // PLOT_LOD_HPP
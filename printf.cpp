@@ -122,7 +122,7 @@ void DivePlan::printSummary(){
 
     std::cout << "Dive Number: " << m_diveNumber << std::endl;
     
-    std::cout << "GF " << g_parameters.m_gf[0] << " / " << g_parameters.m_gf[1] << std::endl;
+    std::cout << "GF " << m_gf[0] << " / " << m_gf[1] << std::endl;
     std::cout << "TTS Target: " << getTTS() << std::endl;
     std::cout << "TTS Max: " << result.second << " Max Time: " << result.first << std::endl;
     std::cout << "deltaTTS +5 min: " << getTTSDelta(5) << std::endl;
@@ -2,9 +2,23 @@
 #define QTHEADERS_HPP
 
 // Replace direct Qt includes with their module-specific paths
-#include <QtWidgets/QApplication>
 #include <QCoreApplication>
 #include <QObject>
+#include <QStandardPaths>
+#include <QDir>
+#include <QTextStream>
+#include <QtCore/QTimer>
+#include <QtCore/QMetaObject>
+#include <QVariant>
+#include <QSignalMapper>
+#include <QFileSystemWatcher> // For the plan library
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+
+// Widgets and painting, not in the builds without the windows (see divecomputer-cli.pro)
+#ifndef DIVECOMPUTER_HEADLESS
+#include <QtWidgets/QApplication>
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/QFormLayout>
 #include <QtWidgets/QGroupBox>
@@ -18,11 +32,9 @@
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QStatusBar>
 #include <QTableWidget>
-#include <QStandardPaths>
 #include <QHeaderView>
 #include <QComboBox>
 #include <QLineEdit>
-#include <QDir>
 #include <QDialog>
 #include <QSplitter>
 #include <QHBoxLayout>
@@ -32,7 +44,6 @@
 #include <QTableWidgetItem>
 #include <QTextEdit>
 #include <QTextBrowser>
-#include <QTextStream>
 #include <QTextCursor>
 #include <QTextDocument>
 #include <QTextDocumentFragment>
@@ -43,18 +54,18 @@
 #include <QTextBlockFormat>
 #include <QTextBlockFormat>
 #include <QScrollBar>
-#include <QtCore/QTimer>
-#include <QtCore/QMetaObject>
 #include <QPainter>
 #include <QPainterPath>
-#include <QVariant>
 #include <QDoubleValidator>
-#include <QSignalMapper>
 #include <QProgressDialog>
 #include <QMessageBox>       // For error dialogs
 #include <QInputDialog>      // For input validation dialogs 
 #include <QProgressDialog>   // For progress feedback during operations
 #include <QStatusBar>        // For status updates
 #include <QFileDialog>       // For file operations
+#include <QTableView>
+#include <QAbstractTableModel>
+#include <QPlainTextEdit>
+#endif // DIVECOMPUTER_HEADLESS
 
 #endif
\ No newline at end of file
@@ -2,15 +2,9 @@
 
 namespace DiveComputer {
 
+// Defaults only: the saved setpoints are loaded by the GUI, every plan must not read the file
 SetPoints::SetPoints() {
-    // Ensure app info is set before any path operations
-    ensureAppInfoSet();
-
-    // Try to load from file
-    if (!loadSetPointsFromFile()) {
-        m_setPoints.clear();
-        setToDefault();
-    }
+    setToDefault();
     sortSetPoints();
 }
 
@@ -21,82 +15,94 @@ void SetPoints::setToDefault() {
     addSetPoint(6.0, 1.6);
 }
 
+// Ordering of the setpoints: decreasing depth, then decreasing setpoint
+static bool isBefore(double depthA, double setPointA, double depthB, double setPointB) {
+    if (depthA == depthB) {
+        return setPointA > setPointB;
+    }
+    return depthA > depthB;
+}
+
 // Sort the setpoints by decreasing depth, then decreasing setpoint
+// Only needed after the vectors are edited directly: add, remove and load keep them sorted
 void SetPoints::sortSetPoints() {
-    // Sort the depths and setpoints in descending order
-    std::vector<double> sortedDepths;
-    std::vector<double> sortedSetPoints;
-
-    // Create a vector of pairs of depths and setpoints
-    std::vector<std::pair<double, double>> depthSetpoints;
-    for (size_t i = 0; i < m_depths.size(); ++i) {
-        depthSetpoints.push_back(std::make_pair(m_depths[i], m_setPoints[i]));
-    }   
-
-    // Sort the vector of pairs by decreasing depth, then decreasing setpoint
-    std::sort(depthSetpoints.begin(), depthSetpoints.end(), [](const std::pair<double, double>& a, const std::pair<double, double>& b) {
-        if (a.first == b.first) {
-            return a.second > b.second;
+    // Insertion sort on both vectors in place: a handful of entries, usually already sorted
+    for (size_t i = 1; i < m_depths.size(); ++i) {
+        double depth = m_depths[i];
+        double setPoint = m_setPoints[i];
+        size_t j = i;
+        while (j > 0 && isBefore(depth, setPoint, m_depths[j - 1], m_setPoints[j - 1])) {
+            m_depths[j] = m_depths[j - 1];
+            m_setPoints[j] = m_setPoints[j - 1];
+            j--;
         }
-        return a.first > b.first;
-    });
-
-    // Extract the sorted depths and setpoints
-    for (const auto& pair : depthSetpoints) {
-        sortedDepths.push_back(pair.first);
-        sortedSetPoints.push_back(pair.second);
+        m_depths[j] = depth;
+        m_setPoints[j] = setPoint;
     }
-
-    // Update the member variables with the sorted values
-    m_depths = sortedDepths;
-    m_setPoints = sortedSetPoints;  
 }
 
 // Find the setpoint at a given depth
-double SetPoints::getSetPointAtDepth(double depth, bool boosted) {
-    // First, ensure setpoints are sorted by decreasing depth, then decreasing setpoint
-    sortSetPoints();
-    
+double SetPoints::getSetPointAtDepth(double depth, bool boosted) const {
     // If no setpoints defined, return a default value (Diluent max PpO2)
     if (m_depths.empty()) {
         return g_parameters.m_maxPpO2Diluent;
     }
     
-    // Case A: If depth is greater than or equal to the deepest setpoint
+    // If depth is greater than or equal to the deepest setpoint
     if ((depth >= m_depths[0]) || !boosted){
         return m_setPoints[0]; // Return the setpoint for deepest depth
     }
     
-    // Case B: If depth is less than the shallowest setpoint
-    if (depth < m_depths[m_depths.size() - 1]) {
-        return m_setPoints[m_depths.size() - 1]; // Return the shallowest setpoint
+    // Otherwise use the setpoint with the depth immediately greater than the target depth
+    // (the shallowest setpoint if the depth is above all of them)
+    auto firstNotDeeper = std::partition_point(m_depths.begin(), m_depths.end(),
+                                               [depth](double d) { return d > depth; });
+    return m_setPoints[(firstNotDeeper - m_depths.begin()) - 1];
+}
+
+// Resolve the setpoints for a whole series of depths (e.g. every step of a profile) in one pass
+// The search starts from the previous result, so consecutive depths are resolved in constant time
+void SetPoints::getSetPointsAtDepths(const double* depths, size_t count, bool boosted, double* setPoints) const {
+    if (m_depths.empty() || !boosted) {
+        double setPoint = m_depths.empty() ? g_parameters.m_maxPpO2Diluent : m_setPoints[0];
+        std::fill(setPoints, setPoints + count, setPoint);
+        return;
     }
-    
-    // Case C: Depth is between deepest and shallowest setpoints
-    // Find the setpoint with the depth immediately greater than the target depth
-    for (size_t i = 0; i < m_depths.size() - 1; i++) {
-        if (depth < m_depths[i] && depth >= m_depths[i + 1]) {
-            return m_setPoints[i]; // Return the setpoint with depth immediately greater
+
+    const size_t last = m_depths.size() - 1;
+    size_t index = 0;
+    for (size_t k = 0; k < count; ++k) {
+        double depth = depths[k];
+        if (depth >= m_depths[0]) {
+            index = 0;
+        } else {
+            // Index of the last setpoint deeper than the depth
+            while (index > 0 && !(m_depths[index] > depth)) index--;
+            while (index < last && m_depths[index + 1] > depth) index++;
         }
+        setPoints[k] = m_setPoints[index];
     }
-    
-    // Fallback (should not reach here if all cases are covered properly)
-    return m_setPoints[0];
 }
 
 void SetPoints::addSetPoint(double depth, double setpoint) {
-    m_depths.push_back(depth);
-    m_setPoints.push_back(setpoint);
-    sortSetPoints();
+    // Insert at the sorted position
+    size_t index = 0;
+    while (index < m_depths.size() && !isBefore(depth, setpoint, m_depths[index], m_setPoints[index])) {
+        index++;
+    }
+    m_depths.insert(m_depths.begin() + index, depth);
+    m_setPoints.insert(m_setPoints.begin() + index, setpoint);
 }
 
 void SetPoints::removeSetPoint(size_t index) {
+    // Erasing keeps the remaining setpoints sorted
     if (index < m_depths.size()) {
         m_depths.erase(m_depths.begin() + index);
         m_setPoints.erase(m_setPoints.begin() + index);
     }
 }
 
+#ifndef DIVECOMPUTER_EMBEDDED
 bool SetPoints::loadSetPointsFromFile() {
     const std::string filename = getFilePath(SETPOINTS_FILE_NAME);
     
@@ -108,7 +114,7 @@ bool SetPoints::loadSetPointsFromFile() {
     return ErrorHandler::tryFileOperation([&]() {
         std::ifstream file(filename, std::ios::binary);
         if (!file.is_open()) {
-            logWrite("Failed to open setpoints file for reading");
+            logError("Failed to open setpoints file for reading");
         }
         
         // Clear existing setpoints
@@ -132,7 +138,7 @@ bool SetPoints::loadSetPointsFromFile() {
             file.read(reinterpret_cast<char*>(&setPoint), sizeof(setPoint));
             
             if (file.fail()) {
-                logWrite("Error reading setpoint data");
+                logError("Error reading setpoint data");
             }
             
             // Add to vectors
@@ -151,6 +157,9 @@ bool SetPoints::loadSetPointsFromFile() {
 
 bool SetPoints::saveSetPointsToFile() {
     const std::string filename = getFilePath(SETPOINTS_FILE_NAME);
+    if (filename.empty()) {
+        return false;    // no data directory to save to
+    }
     
     return ErrorHandler::tryFileOperation([&]() {
         // Create directory if it doesn't exist
@@ -159,7 +168,7 @@ bool SetPoints::saveSetPointsToFile() {
         
         std::ofstream file(filename, std::ios::binary | std::ios::trunc);
         if (!file.is_open()) {
-            logWrite("Failed to open file for writing: ", filename);
+            logError("Failed to open file for writing: ", filename);
         }
         
         // Write number of setpoints
@@ -172,7 +181,7 @@ bool SetPoints::saveSetPointsToFile() {
             file.write(reinterpret_cast<const char*>(&m_setPoints[i]), sizeof(m_setPoints[i]));
             
             if (file.fail()) {
-                logWrite("Error writing setpoint data");
+                logError("Error writing setpoint data");
             }
         }
         
@@ -182,4 +191,6 @@ bool SetPoints::saveSetPointsToFile() {
     }, filename, "Error Saving Setpoints");
 }
 
+#endif
+
 } // namespace DiveComputer
\ No newline at end of file
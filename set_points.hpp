@@ -2,7 +2,9 @@
 #define SET_POINTS_HPP
 
 #include "global.hpp"
+#ifndef DIVECOMPUTER_EMBEDDED
 #include "error_handler.hpp"
+#endif
 
 namespace DiveComputer {
 
@@ -10,17 +12,20 @@ class SetPoints {
 public:
     SetPoints();
 
-    // Attributes
-    std::vector<double> m_depths;
-    std::vector<double> m_setPoints;
+    // Attributes, kept sorted by decreasing depth, then decreasing setpoint
+    CoreVector<double, MAX_SET_POINTS> m_depths;
+    CoreVector<double, MAX_SET_POINTS> m_setPoints;
 
     // Methods  
-    double getSetPointAtDepth(double depth, bool boosted);
+    double getSetPointAtDepth(double depth, bool boosted) const;
+    void   getSetPointsAtDepths(const double* depths, size_t count, bool boosted, double* setPoints) const;
 
     // File operations
     void setToDefault();
+#ifndef DIVECOMPUTER_EMBEDDED
     bool loadSetPointsFromFile();
     bool saveSetPointsToFile();
+#endif
     void sortSetPoints();
     size_t nbOfSetPoints() const { return m_depths.size(); }
     void addSetPoint(double depth, double setpoint);
@@ -1,4 +1,5 @@
 #include "stop_steps.hpp"
+#include <algorithm>
 
 namespace DiveComputer {
 
@@ -17,7 +18,6 @@ int StopSteps::nbOfStopSteps() {
 
 void StopSteps::addStopStep(double depth, double time) {
     m_stopSteps.push_back(StopStep(depth, time));
-    sortDescending();
 }
 
 void StopSteps::removeStopStep(int index) {
@@ -30,7 +30,6 @@ void StopSteps::clear() {
 
 void StopSteps::editStopStep(int index, double depth, double time) {
     m_stopSteps[index] = StopStep(depth, time);
-    sortDescending();
 }
 
 double StopSteps::maxDepth() {
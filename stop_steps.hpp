@@ -1,8 +1,10 @@
 #ifndef STOP_STEPS_HPP
 #define STOP_STEPS_HPP
 
-#include <vector>
+#include "core_config.hpp"
+#ifndef DIVECOMPUTER_EMBEDDED
 #include <iostream>
+#endif
 
 namespace DiveComputer {
 
@@ -16,13 +18,14 @@ public:
     double m_time;
 };
 
-// Stop steps class
+// Stop steps of a plan, in the order they were added: the plan sorts them when it is
+// built, unless they are the waypoints of the profile (DivePlan::m_waypoints)
 class StopSteps {
 public:
     StopSteps();
     ~StopSteps() = default;
 
-    std::vector<StopStep> m_stopSteps;
+    CoreVector<StopStep, MAX_STOP_STEPS> m_stopSteps;
     int  nbOfStopSteps();
     void addStopStep(double depth, double time);
     void removeStopStep(int index);
@@ -31,7 +34,9 @@ public:
     double maxDepth();
     void sortDescending();
     void sortAscending();
+#ifndef DIVECOMPUTER_EMBEDDED
     void print();
+#endif
 };
 
 } // namespace DiveComputer
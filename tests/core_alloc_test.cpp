@@ -0,0 +1,118 @@
+// The embedded core does not touch the heap once a plan is set up (see core_config.hpp).
+//
+// operator new is replaced by one that counts: the plans and the gases are set up first, then
+// every call of the core a firmware makes during a dive is run, and any allocation fails the test.
+
+#include "dive_plan.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+bool g_armed = false;
+long g_allocations = 0;
+
+void* allocate(std::size_t size) {
+    if (g_armed) {
+        g_allocations++;
+    }
+    void* pointer = std::malloc(size ? size : 1);
+    if (!pointer) std::abort();
+    return pointer;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+using namespace DiveComputer;
+
+namespace {
+
+DivePlan* g_plan = nullptr;
+int g_failures = 0;
+
+// Runs a step of the test and reports the allocations it made
+template <typename Step>
+void check(const char* name, Step step) {
+    long before = g_allocations;
+    step();
+    long allocations = g_allocations - before;
+    if (allocations != 0 || g_plan->overflowed()) {
+        std::printf("FAIL %s: %ld allocations%s\n", name, allocations, g_plan->overflowed() ? ", overflowed" : "");
+        g_failures++;
+    } else {
+        std::printf("ok   %s\n", name);
+    }
+}
+
+void calculate() {
+    g_plan->buildDivePlan();
+    g_plan->calculateDivePlan(false);
+    g_plan->calculateGasConsumption(false);
+    g_plan->calculateDiveSummary(false);
+    g_plan->getNoFlyTime();
+}
+
+} // namespace
+
+int main() {
+    // Setup: the gases, and in static storage as on the target the plan and the scratch plan of its what-ifs
+    static DivePlan plan(60, 25, diveMode::OC, 1, compartmentPPinitialAir);
+    static DivePlan scratchPlan(60, 25, diveMode::OC, 1, compartmentPPinitialAir);
+    g_plan = &plan;
+    g_gasList.clearGaslist();
+    g_gasList.addGas(18, 45, GasType::BOTTOM, GasStatus::ACTIVE);
+    g_gasList.addGas(50, 0, GasType::DECO, GasStatus::ACTIVE);
+    g_gasList.addGas(100, 0, GasType::DECO, GasStatus::ACTIVE);
+    g_plan->setScratchPlan(&scratchPlan);
+    g_plan->m_mission = 10;
+    g_armed = true;
+
+    check("open circuit", [] {
+        calculate();
+    });
+    check("stop steps edited", [] {
+        g_plan->m_stopSteps.clear();
+        g_plan->m_stopSteps.addStopStep(65, 20);
+        g_plan->m_stopSteps.addStopStep(30, 5);
+        calculate();
+    });
+    check("closed circuit with bailout", [] {
+        g_plan->m_mode = diveMode::CC;
+        g_plan->m_bailout = true;
+        calculate();
+    });
+    check("waypoint profile", [] {
+        g_plan->m_mode = diveMode::OC;
+        g_plan->m_bailout = false;
+        g_plan->m_waypoints = true;
+        g_plan->m_stopSteps.clear();
+        g_plan->m_stopSteps.addStopStep(40, 10);
+        g_plan->m_stopSteps.addStopStep(15, 5);
+        g_plan->m_stopSteps.addStopStep(40, 10);
+        calculate();
+    });
+    check("altitude site", [] {
+        g_plan->m_waypoints = false;
+        g_plan->m_site = DiveSite(WaterType::FRESH, 0.8);
+        calculate();
+    });
+    check("state at time", [] {
+        for (double runTime = 0; runTime < 120; runTime += 7) {
+            g_plan->getStateAtTime(runTime);
+        }
+    });
+
+    g_armed = false;
+    std::printf("%s: %ld allocations after setup\n", g_failures ? "FAILED" : "PASSED", g_allocations);
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+// Level of detail pyramid of the compartment graph against time (lod_levels.hpp, plot_lod.cpp).
+//
+// The inert gas pressures of a real trimix dive are taken every lodDenseInterval() of run time
+// after the bottom time with getStateAtTime, as the graph takes them between its samples, and
+// decimated into levels. The test fails unless the dive has a level above the series itself
+// that a plot of the default window width draws at full view, and unless every level keeps the
+// lowest and the highest pressure of each compartment.
+
+#include "dive_plan.hpp"
+#include "lod_levels.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace DiveComputer;
+
+namespace {
+
+struct Point {
+    double key;
+    double value;
+};
+
+// Width of the plot of the compartment graph window at its default size, about
+constexpr int PLOT_PIXEL_WIDTH = 700;
+
+int g_failures = 0;
+
+void check(const char* name, bool passed) {
+    std::printf("%s %s\n", passed ? "ok  " : "FAIL", name);
+    if (!passed) g_failures++;
+}
+
+double valueOf(const Point& point) {
+    return point.value;
+}
+
+} // namespace
+
+int main() {
+    static DivePlan plan(60, 25, diveMode::OC, 1, compartmentPPinitialAir);
+    g_gasList.clearGaslist();
+    g_gasList.addGas(15, 55, GasType::BOTTOM, GasStatus::ACTIVE);
+    g_gasList.addGas(50, 0, GasType::DECO, GasStatus::ACTIVE);
+    g_gasList.addGas(100, 0, GasType::DECO, GasStatus::ACTIVE);
+    plan.loadAvailableGases();
+    plan.buildDivePlan();
+    plan.calculateDivePlan(false);
+    check("plan fits", !plan.overflowed());
+
+    int bottomStop = plan.bottomStopIndex();
+    double bottomTime = (bottomStop > 0) ? plan.m_diveProfile[bottomStop - 1].m_runTime : 0.0;
+    double endTime = plan.m_diveProfile[plan.m_diveProfile.size() - 1].m_runTime;
+    double interval = lodDenseInterval(endTime - bottomTime);
+
+    std::vector<std::vector<Point>> series(NUM_COMPARTMENTS);
+    for (int k = 1; bottomTime + k * interval <= endTime; k++) {
+        double runTime = bottomTime + k * interval;
+        DiveStep state = plan.getStateAtTime(runTime);
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            series[j].push_back({runTime, state.m_ppActual[j].m_pInert});
+        }
+    }
+
+    bool drawn = true;
+    bool extremes = true;
+    for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+        std::vector<std::vector<Point>> levels(1, series[j]);
+        while ((int) levels.back().size() > LOD_MIN_LEVEL_POINTS) {
+            levels.push_back(decimateMinMax(levels.back(), valueOf));
+        }
+        if (j == 0) {
+            std::printf("     %.0f min after the bottom time, levels of", endTime - bottomTime);
+            for (const auto& level : levels) std::printf(" %d", (int) level.size());
+            std::printf(" points\n");
+        }
+
+        // PlotLod::levelFor draws a level at full view from twice as many points as pixels
+        if (levels.size() < 2 || (int) levels[1].size() < 2 * PLOT_PIXEL_WIDTH) {
+            drawn = false;
+        }
+
+        for (const auto& level : levels) {
+            double low = level[0].value;
+            double high = level[0].value;
+            for (const Point& point : level) {
+                low = std::min(low, point.value);
+                high = std::max(high, point.value);
+            }
+            double seriesLow = series[j][0].value;
+            double seriesHigh = series[j][0].value;
+            for (const Point& point : series[j]) {
+                seriesLow = std::min(seriesLow, point.value);
+                seriesHigh = std::max(seriesHigh, point.value);
+            }
+            if (low != seriesLow || high != seriesHigh) {
+                extremes = false;
+            }
+        }
+    }
+    check("a decimated level drawn at full view for every compartment", drawn);
+    check("every level keeps the lowest and the highest pressure", extremes);
+
+    std::printf("%s\n", g_failures ? "FAILED" : "PASSED");
+    return g_failures ? 1 : 0;
+}
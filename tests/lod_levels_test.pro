@@ -0,0 +1,34 @@
+# Level of detail pyramid of a real dive, see lod_levels_test.cpp.
+# Build and run with: qmake lod_levels_test.pro && make && ./lod_levels_test
+
+TARGET = lod_levels_test
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= qt app_bundle
+
+# The planning core as divecomputer-core.pro builds it
+DEFINES += DIVECOMPUTER_EMBEDDED
+QMAKE_CXXFLAGS += -fno-exceptions -fno-rtti
+
+INCLUDEPATH += ..
+OBJECTS_DIR = build
+
+SOURCES += \
+    lod_levels_test.cpp \
+    ../enum.cpp \
+    ../global.cpp \
+    ../constants.cpp \
+    ../parameters.cpp \
+    ../gas.cpp \
+    ../gaslist.cpp \
+    ../buhlmann.cpp \
+    ../compartments.cpp \
+    ../dive_site.cpp \
+    ../oxygen_toxicity.cpp \
+    ../stop_steps.cpp \
+    ../set_points.cpp \
+    ../dive_step.cpp \
+    ../dive_plan.cpp
+
+HEADERS += \
+    ../lod_levels.hpp
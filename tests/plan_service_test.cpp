@@ -0,0 +1,159 @@
+// Local planning service (plan_service.cpp), through the client of the CLI.
+//
+// A service is started on a Unix domain socket in a temporary directory, with a batch window
+// long enough for the requests sent together to meet in the dispatcher. The test fails unless
+// identical plans are computed once, a plan asked again comes from the cache, malformed
+// requests get their JSON-RPC error, and a batch is answered by one array.
+
+#include "log_info.hpp"
+#include "plan_service.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace DiveComputer;
+
+namespace {
+
+int g_failures = 0;
+
+void check(const char* name, bool passed) {
+    std::printf("%s %s\n", passed ? "ok  " : "FAIL", name);
+    if (!passed) g_failures++;
+}
+
+// Responses written by the client, one per line or one array per batch
+std::vector<QJsonDocument> send(const std::string& socketPath, const std::string& requests) {
+    std::istringstream in(requests);
+    std::ostringstream out;
+    runPlanClient(socketPath, 0, in, out);
+
+    std::vector<QJsonDocument> responses;
+    std::istringstream lines(out.str());
+    std::string line;
+    while (std::getline(lines, line)) {
+        responses.push_back(QJsonDocument::fromJson(QByteArray::fromStdString(line)));
+    }
+    return responses;
+}
+
+// Response of the given id among single responses
+QJsonObject response(const std::vector<QJsonDocument>& responses, const QString& id) {
+    for (const QJsonDocument& document : responses) {
+        if (document.isObject() && document.object().value("id").toString() == id) {
+            return document.object();
+        }
+    }
+    return QJsonObject();
+}
+
+int errorCode(const QJsonObject& response) {
+    return response.value("error").toObject().value("code").toInt();
+}
+
+QJsonObject stats(const std::string& socketPath) {
+    auto responses = send(socketPath, "{\"jsonrpc\":\"2.0\",\"id\":\"stats\",\"method\":\"stats\"}\n");
+    return response(responses, "stats").value("result").toObject();
+}
+
+} // namespace
+
+int main() {
+    // No log file, and nothing but the checks on the console
+    logSetOutputs(LogConsole::NONE, false);
+
+    char directory[] = "/tmp/plan_service_test.XXXXXX";
+    if (!mkdtemp(directory)) {
+        std::printf("FAIL temporary directory\n");
+        return 1;
+    }
+
+    PlanServiceOptions options;
+    options.m_socketPath = std::string(directory) + "/service.sock";
+    options.m_threads = 2;
+    options.m_batchWindowUs = 200000;
+    PlanService service(options);
+    std::thread server([&service]() { service.run(); });
+
+    // Listening once the socket exists
+    struct stat status;
+    for (int i = 0; i < 100 && ::stat(options.m_socketPath.c_str(), &status) != 0; i++) {
+        usleep(10000);
+    }
+    check("service listening", ::stat(options.m_socketPath.c_str(), &status) == 0);
+
+    // The same plan under three ids and two spellings, sent together: computed once
+    const std::string plan = "{\"stops\":[[40,25]],\"gases\":[{\"o2\":21,\"he\":35},{\"o2\":50,\"type\":\"deco\"}]}";
+    auto responses = send(options.m_socketPath,
+                          "{\"id\":\"a\"," + plan.substr(1) + "\n" +
+                          "{\"id\":\"b\"," + plan.substr(1) + "\n" +
+                          "c,OC,,,40:25,21/35 50/0:deco\n");
+    bool planned = responses.size() == 3;
+    for (const char* id : {"a", "b", "c"}) {
+        planned = planned && response(responses, id).value("result").toObject().value("ok").toBool();
+    }
+    check("three requests planned", planned);
+
+    QJsonObject cache = stats(options.m_socketPath).value("cache").toObject();
+    check("identical plans computed once", cache.value("computed").toInt() == 1);
+    check("the plans sent together wait for the one computed", cache.value("coalesced").toInt() == 2);
+
+    // Asked again on another connection
+    responses = send(options.m_socketPath, "{\"id\":\"d\"," + plan.substr(1) + "\n");
+    cache = stats(options.m_socketPath).value("cache").toObject();
+    check("plan asked again answered", response(responses, "d").value("result").toObject().value("ok").toBool());
+    check("plan asked again from the cache", cache.value("hits").toInt() == 1 && cache.value("computed").toInt() == 1);
+
+    // Errors
+    responses = send(options.m_socketPath,
+                     "{\"jsonrpc\":\"2.0\",\"id\":\"method\",\"method\":\"unknown\"}\n"
+                     "{\"jsonrpc\":\"2.0\",\"id\":\"params\",\"method\":\"plan\",\"params\":5}\n"
+                     "{\"jsonrpc\":\"2.0\",\"id\":\"spec\",\"method\":\"plan\",\"params\":{\"stops\":\"deep\"}}\n"
+                     "{\"jsonrpc\":\"1.0\",\"id\":\"version\",\"method\":\"plan\"}\n");
+    check("unknown method", errorCode(response(responses, "method")) == -32601);
+    check("params not an object", errorCode(response(responses, "params")) == -32602);
+    check("invalid plan spec", errorCode(response(responses, "spec")) == -32602);
+    check("not a JSON-RPC 2.0 request", errorCode(response(responses, "version")) == -32600);
+
+    responses = send(options.m_socketPath, "[{\"jsonrpc\":\"2.0\"\n");
+    check("invalid JSON", responses.size() == 1 && errorCode(responses[0].object()) == -32700);
+
+    responses = send(options.m_socketPath, "[]\n");
+    check("empty batch", responses.size() == 1 && errorCode(responses[0].object()) == -32600);
+
+    // A batch of a plan, a notification, a non request and the stats: one array of three
+    responses = send(options.m_socketPath,
+                     "[{\"jsonrpc\":\"2.0\",\"id\":\"e\",\"method\":\"plan\",\"params\":" + plan + "},"
+                     "{\"jsonrpc\":\"2.0\",\"method\":\"stats\"},"
+                     "1,"
+                     "{\"jsonrpc\":\"2.0\",\"id\":\"f\",\"method\":\"stats\"}]\n");
+    bool batch = responses.size() == 1 && responses[0].isArray() && responses[0].array().size() == 3;
+    if (batch) {
+        QJsonArray answers = responses[0].array();
+        int plans = 0;
+        int invalid = 0;
+        int stats = 0;
+        for (const QJsonValue& answer : answers) {
+            QJsonObject object = answer.toObject();
+            if (object.value("id").toString() == "e" && object.value("result").toObject().value("ok").toBool()) plans++;
+            if (object.value("id").isNull() && errorCode(object) == -32600) invalid++;
+            if (object.value("id").toString() == "f" && object.value("result").isObject()) stats++;
+        }
+        batch = plans == 1 && invalid == 1 && stats == 1;
+    }
+    check("batch answered by one array", batch);
+
+    service.stop();
+    server.join();
+    ::rmdir(directory);
+
+    std::printf("%s\n", g_failures ? "FAILED" : "PASSED");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,37 @@
+# Local planning service through the client of the CLI, see plan_service_test.cpp.
+# Build and run with: qmake plan_service_test.pro && make && ./plan_service_test
+
+TARGET = plan_service_test
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# The service as divecomputer-cli.pro builds it
+QT = core
+DEFINES += DIVECOMPUTER_HEADLESS
+LIBS += -lz
+
+INCLUDEPATH += ..
+OBJECTS_DIR = build
+
+SOURCES += \
+    plan_service_test.cpp \
+    ../batch_planner.cpp \
+    ../plan_service.cpp \
+    ../log_info.cpp \
+    ../enum.cpp \
+    ../global.cpp \
+    ../constants.cpp \
+    ../parameters.cpp \
+    ../gas.cpp \
+    ../gaslist.cpp \
+    ../buhlmann.cpp \
+    ../compartments.cpp \
+    ../dive_site.cpp \
+    ../oxygen_toxicity.cpp \
+    ../stop_steps.cpp \
+    ../set_points.cpp \
+    ../dive_step.cpp \
+    ../dive_plan.cpp \
+    ../dive_plan_file.cpp \
+    ../compute_pool.cpp
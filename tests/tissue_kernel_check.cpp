@@ -0,0 +1,210 @@
+// Accuracy and speed of the reduced precision tissue kernels against double (tissue_kernel.hpp).
+//
+// The corpus is 1440 plans: OC, CC and CC with bailout, 30 to 120 m, 10 to 75 min, 8 gradient factors.
+//
+//   tissue_kernel_check                   largest error of the float and Q1.30 kernels along the corpus
+//                                         profiles, the tissues carried from step to step, and ns per step
+//   tissue_kernel_check --schedules       stop schedule of every plan, planned with the kernel of the build
+//   tissue_kernel_check --compare <file>  plans the corpus with the kernel of the build and fails on any
+//                                         schedule differing from those of <file>, written by the double build
+//
+// See tissue_kernel_check.pro for the builds of each kernel.
+
+#include "dive_plan.hpp"
+#include "tissue_kernel.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace DiveComputer;
+
+namespace {
+
+const diveMode MODES[] = {diveMode::OC, diveMode::CC, diveMode::CC};
+const char* const MODE_NAMES[] = {"OC", "CC", "BO"};
+const double DEPTHS[] = {30, 40, 50, 60, 70, 80, 90, 100, 110, 120};
+const double TIMES[] = {10, 20, 30, 45, 60, 75};
+const double GFS[][2] = {{30, 70}, {30, 80}, {40, 80}, {50, 80}, {50, 90}, {70, 85}, {85, 85}, {100, 100}};
+const double CEILING_GFS[] = {30, 80, 100};
+
+// Bottom gas for a ppO2 of 1.3 and an END of 30 m, with 50 % and oxygen for the deco
+void setGases(double depth) {
+    double pAmb = depth / 10.0 + 1.0;
+    double o2 = std::min(21.0, std::floor(130.0 / pAmb));
+    double he = std::max(0.0, std::ceil(100.0 - o2 - 79.0 * 4.0 / pAmb));
+    g_gasList.clearGaslist();
+    g_gasList.addGas(o2, he, GasType::BOTTOM, GasStatus::ACTIVE);
+    g_gasList.addGas(50, 0, GasType::DECO, GasStatus::ACTIVE);
+    g_gasList.addGas(100, 0, GasType::DECO, GasStatus::ACTIVE);
+}
+
+// Step inputs of the kernels
+struct KernelStep {
+    double pAmbStart, pAmbEnd, time, n2Percent, hePercent;
+};
+
+struct Errors {
+    double pressure = 0;    // bar
+    double ceiling = 0;     // m
+};
+
+// Runs the kernel along the profile from the initial pressures, keeping every step's pressures
+template <typename Real>
+void runProfile(const TissueKernel<Real>& kernel, const CompartmentPressures& initial,
+                const std::vector<KernelStep>& steps, std::vector<CompartmentPressures>& pressures) {
+    pressures.assign(steps.size() + 1, initial);
+    for (size_t i = 0; i < steps.size(); i++) {
+        const KernelStep& s = steps[i];
+        kernel.saturate(pressures[i], pressures[i + 1], s.pAmbStart, s.pAmbEnd, s.time, s.n2Percent, s.hePercent);
+    }
+}
+
+template <typename Real>
+void compare(const TissueKernel<Real>& kernel, const TissueKernel<double>& reference, const CompartmentPressures& initial,
+             const std::vector<KernelStep>& steps, const std::vector<CompartmentPressures>& expected, Errors& errors) {
+    std::vector<CompartmentPressures> pressures;
+    runProfile(kernel, initial, steps, pressures);
+    for (size_t i = 1; i < pressures.size(); i++) {
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            errors.pressure = std::max(errors.pressure, std::abs(pressures[i][j].m_pN2 - expected[i][j].m_pN2));
+            errors.pressure = std::max(errors.pressure, std::abs(pressures[i][j].m_pHe - expected[i][j].m_pHe));
+        }
+        const KernelStep& s = steps[i - 1];
+        for (double gf : CEILING_GFS) {
+            double ceiling = kernel.ceiling(pressures[i], s.n2Percent, s.hePercent, gf);
+            double expectedCeiling = reference.ceiling(expected[i], s.n2Percent, s.hePercent, gf);
+            errors.ceiling = std::max(errors.ceiling, std::abs(ceiling - expectedCeiling));
+        }
+    }
+}
+
+template <typename Real>
+double nsPerStep(const TissueKernel<Real>& kernel, const CompartmentPressures& initial, const std::vector<KernelStep>& steps) {
+    const int repeats = 20;
+    CompartmentPressures previous = initial, current;
+    double sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (const KernelStep& s : steps) {
+            kernel.saturate(previous, current, s.pAmbStart, s.pAmbEnd, s.time, s.n2Percent, s.hePercent);
+            sum += kernel.ceiling(current, s.n2Percent, s.hePercent, 80);
+            previous = current;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    volatile double sink = sum;
+    (void) sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(repeats) * steps.size());
+}
+
+std::string formatSchedule(const char* name, const DivePlan& plan) {
+    std::string line = name;
+    char buffer[64];
+    if (plan.overflowed()) {
+        return line + " overflowed";
+    }
+    for (int i = 0; i < (int) plan.m_diveProfile.size(); i++) {
+        const DiveStep& step = plan.m_diveProfile[i];
+        if (step.m_phase == Phase::DECO && step.m_time > 0) {
+            std::snprintf(buffer, sizeof(buffer), " %g:%g", step.m_endDepth, step.m_time);
+            line += buffer;
+        }
+    }
+    const DiveStep& last = plan.m_diveProfile[plan.m_diveProfile.size() - 1];
+    std::snprintf(buffer, sizeof(buffer), " rt %g", last.m_runTime);
+    return line + buffer;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool schedules = argc > 1 && std::strcmp(argv[1], "--schedules") == 0;
+    const bool compareSchedules = argc > 2 && std::strcmp(argv[1], "--compare") == 0;
+
+    std::ifstream reference;
+    if (compareSchedules) {
+        reference.open(argv[2]);
+        if (!reference.is_open()) {
+            std::printf("Could not read %s\n", argv[2]);
+            return 1;
+        }
+    }
+    int differences = 0;
+
+    static DivePlan plan(30, 10, diveMode::OC, 1, compartmentPPinitialAir);
+    TissueKernel<double> exact;
+    TissueKernel<float> single;
+    TissueKernel<Q30> fixed;
+
+    Errors floatErrors, fixedErrors;
+    std::vector<KernelStep> allSteps;
+    int plans = 0, overflowed = 0;
+
+    for (int m = 0; m < 3; m++) {
+        for (double depth : DEPTHS) {
+            setGases(depth);
+            for (double time : TIMES) {
+                for (const auto& gf : GFS) {
+                    g_parameters.m_gf[0] = gf[0];
+                    g_parameters.m_gf[1] = gf[1];
+                    g_parameters.markChanged();
+
+                    plan = DivePlan(depth, time, MODES[m], 1, compartmentPPinitialAir);
+                    plan.m_bailout = (m == 2);
+                    plan.buildDivePlan();
+                    plan.calculateDivePlan(false);
+                    plans++;
+
+                    char name[64];
+                    std::snprintf(name, sizeof(name), "%s %gm %gmin GF%g/%g", MODE_NAMES[m], depth, time, gf[0], gf[1]);
+                    if (schedules) {
+                        std::printf("%s\n", formatSchedule(name, plan).c_str());
+                        continue;
+                    }
+                    if (compareSchedules) {
+                        std::string expected, actual = formatSchedule(name, plan);
+                        if (!std::getline(reference, expected) || expected != actual) {
+                            std::printf("expected %s\n     got %s\n", expected.c_str(), actual.c_str());
+                            differences++;
+                        }
+                        continue;
+                    }
+                    if (plan.overflowed()) {
+                        overflowed++;
+                        continue;
+                    }
+
+                    DiveSiteScope site(plan.m_site);
+                    std::vector<KernelStep> steps;
+                    for (int i = 1; i < (int) plan.m_diveProfile.size(); i++) {
+                        const DiveStep& s = plan.m_diveProfile[i];
+                        steps.push_back({s.m_pAmbStartDepth, s.m_pAmbEndDepth, s.m_time, s.m_n2Percent, s.m_hePercent});
+                    }
+                    std::vector<CompartmentPressures> expected;
+                    runProfile(exact, plan.m_initialPressure, steps, expected);
+                    compare(single, exact, plan.m_initialPressure, steps, expected, floatErrors);
+                    compare(fixed, exact, plan.m_initialPressure, steps, expected, fixedErrors);
+                    allSteps.insert(allSteps.end(), steps.begin(), steps.end());
+                }
+            }
+        }
+    }
+    if (schedules) return 0;
+    if (compareSchedules) {
+        std::printf("%d plans, %d schedules differ\n", plans, differences);
+        return differences == 0 ? 0 : 1;
+    }
+
+    std::printf("%d plans, %d overflowed, %zu steps\n", plans, overflowed, allSteps.size());
+    std::printf("          pressure (bar)  ceiling (mm)  ns/step\n");
+    std::printf("double    0               0             %.0f\n", nsPerStep(exact, compartmentPPinitialAir, allSteps));
+    std::printf("float     %-14.1e  %-12.1e  %.0f\n", floatErrors.pressure, floatErrors.ceiling * 1000,
+                nsPerStep(single, compartmentPPinitialAir, allSteps));
+    std::printf("Q1.30     %-14.1e  %-12.1e  %.0f\n", fixedErrors.pressure, fixedErrors.ceiling * 1000,
+                nsPerStep(fixed, compartmentPPinitialAir, allSteps));
+    return 0;
+}
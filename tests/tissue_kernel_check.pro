@@ -0,0 +1,40 @@
+# Accuracy and speed of the float and fixed point tissue kernels against double, see tissue_kernel_check.cpp.
+# Build and run with: qmake tissue_kernel_check.pro && make && ./tissue_kernel_check
+# The stop schedules of each kernel must be those of double, the check fails on any difference:
+#   qmake tissue_kernel_check.pro && make && ./tissue_kernel_check --schedules > double.txt
+#   qmake CONFIG+=kernel_float tissue_kernel_check.pro && make clean && make && ./tissue_kernel_check --compare double.txt
+#   qmake CONFIG+=kernel_fixed tissue_kernel_check.pro && make clean && make && ./tissue_kernel_check --compare double.txt
+
+TARGET = tissue_kernel_check
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= qt app_bundle
+
+# The planning core as divecomputer-core.pro builds it
+DEFINES += DIVECOMPUTER_EMBEDDED
+QMAKE_CXXFLAGS += -fno-exceptions -fno-rtti
+kernel_float: DEFINES += DIVECOMPUTER_KERNEL_FLOAT
+kernel_fixed: DEFINES += DIVECOMPUTER_KERNEL_FIXED
+
+INCLUDEPATH += ..
+OBJECTS_DIR = build
+
+SOURCES += \
+    tissue_kernel_check.cpp \
+    ../enum.cpp \
+    ../global.cpp \
+    ../constants.cpp \
+    ../parameters.cpp \
+    ../gas.cpp \
+    ../gaslist.cpp \
+    ../buhlmann.cpp \
+    ../compartments.cpp \
+    ../dive_site.cpp \
+    ../oxygen_toxicity.cpp \
+    ../stop_steps.cpp \
+    ../set_points.cpp \
+    ../dive_step.cpp \
+    ../dive_plan.cpp
+
+HEADERS += \
+    ../tissue_kernel.hpp
@@ -0,0 +1,88 @@
+// Gases of a saw-tooth waypoint profile (dive_plan.cpp, buildDivePlan).
+//
+// A leg followed by a descent stays on the gas of the bottom: the deco gases are only switched
+// to on the final ascent, once, in order. Each gas the profile breathes is listed with the depth
+// it is switched to at, and the test fails on any other sequence.
+
+#include "dive_plan.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace DiveComputer;
+
+namespace {
+
+struct GasChange {
+    double depth;
+    double o2Percent;
+    double hePercent;
+};
+
+int g_failures = 0;
+
+void check(const char* name, bool passed) {
+    std::printf("%s %s\n", passed ? "ok  " : "FAIL", name);
+    if (!passed) g_failures++;
+}
+
+} // namespace
+
+int main() {
+    static DivePlan plan(40, 20, diveMode::OC, 1, compartmentPPinitialAir);
+    g_gasList.clearGaslist();
+    g_gasList.addGas(18, 45, GasType::BOTTOM, GasStatus::ACTIVE);
+    g_gasList.addGas(50, 0, GasType::DECO, GasStatus::ACTIVE);
+    g_gasList.addGas(100, 0, GasType::DECO, GasStatus::ACTIVE);
+    plan.loadAvailableGases();
+
+    plan.m_waypoints = true;
+    plan.m_stopSteps.clear();
+    plan.m_stopSteps.addStopStep(40, 20);
+    plan.m_stopSteps.addStopStep(20, 10);
+    plan.m_stopSteps.addStopStep(45, 15);
+    plan.m_stopSteps.addStopStep(15, 5);
+    plan.m_stopSteps.addStopStep(30, 10);
+    plan.buildDivePlan();
+    plan.calculateDivePlan(false);
+    check("plan fits", !plan.overflowed());
+
+    // Gas breathed along the profile, each change with the depth it happens at
+    GasChange changes[MAX_DIVE_STEPS];
+    int count = 0;
+    int lastDescent = 0;
+    for (int i = 1; i < (int) plan.m_diveProfile.size(); i++) {
+        const DiveStep& step = plan.m_diveProfile[i];
+        if (step.m_phase == Phase::DESCENDING) lastDescent = i;
+        if (step.m_startDepth < 0.1 && step.m_endDepth < 0.1) continue;
+        if (count == 0 || std::abs(changes[count - 1].o2Percent - step.m_o2Percent) > 0.1 ||
+            std::abs(changes[count - 1].hePercent - step.m_hePercent) > 0.1) {
+            changes[count++] = {step.m_startDepth, step.m_o2Percent, step.m_hePercent};
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        std::printf("     %g/%g from %g m\n", changes[i].o2Percent, changes[i].hePercent, changes[i].depth);
+    }
+
+    const GasChange expected[] = {{0, 18, 45}, {21, 50, 0}, {6, 100, 0}};
+    bool sequence = (count == 3);
+    for (int i = 0; sequence && i < count; i++) {
+        sequence = std::abs(changes[i].depth - expected[i].depth) < 0.1 &&
+                   std::abs(changes[i].o2Percent - expected[i].o2Percent) < 0.1 &&
+                   std::abs(changes[i].hePercent - expected[i].hePercent) < 0.1;
+    }
+    check("bottom gas, then 50/0 at 21 m and 100/0 at 6 m on the final ascent", sequence);
+
+    // No deco gas mode, and no deco stop after a waypoint, on the legs followed by a descent
+    bool bottomLegs = true;
+    for (int i = 1; i < lastDescent; i++) {
+        const DiveStep& step = plan.m_diveProfile[i];
+        if (step.m_mode == stepMode::DECO ||
+            (step.m_phase == Phase::DECO && plan.m_diveProfile[i - 1].m_phase == Phase::STOP)) {
+            bottomLegs = false;
+        }
+    }
+    check("no deco gas or deco stop after a waypoint before the last descent", bottomLegs);
+
+    std::printf("%s\n", g_failures ? "FAILED" : "PASSED");
+    return g_failures ? 1 : 0;
+}
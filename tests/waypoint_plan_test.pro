@@ -0,0 +1,31 @@
+# Gas sequence of a saw-tooth waypoint profile, see waypoint_plan_test.cpp.
+# Build and run with: qmake waypoint_plan_test.pro && make && ./waypoint_plan_test
+
+TARGET = waypoint_plan_test
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= qt app_bundle
+
+# The planning core as divecomputer-core.pro builds it
+DEFINES += DIVECOMPUTER_EMBEDDED
+QMAKE_CXXFLAGS += -fno-exceptions -fno-rtti
+
+INCLUDEPATH += ..
+OBJECTS_DIR = build
+
+SOURCES += \
+    waypoint_plan_test.cpp \
+    ../enum.cpp \
+    ../global.cpp \
+    ../constants.cpp \
+    ../parameters.cpp \
+    ../gas.cpp \
+    ../gaslist.cpp \
+    ../buhlmann.cpp \
+    ../compartments.cpp \
+    ../dive_site.cpp \
+    ../oxygen_toxicity.cpp \
+    ../stop_steps.cpp \
+    ../set_points.cpp \
+    ../dive_step.cpp \
+    ../dive_plan.cpp
@@ -0,0 +1,275 @@
+#ifndef TISSUE_KERNEL_HPP
+#define TISSUE_KERNEL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "buhlmann.hpp"
+#include "compartments.hpp"
+#include "global.hpp"
+
+namespace DiveComputer {
+
+// Tissue kernel of the Buhlmann model: Schreiner saturation, ceiling and M-value check of the
+// 17 compartments, for a choice of number types given as template parameter:
+// - double, the reference: the same operations and results as the model always had,
+// - float, for batch sweeps and single precision FPUs,
+// - FixedPoint<30>, Q1.30 on 32 bits for cores without FPU.
+// The reduced precision types evaluate the exponential of the Schreiner equation, the costly
+// part of a step, with a polynomial of the reduced argument. The tissue state, the combination
+// of the factors with it, the ceiling and the M-value check stay in double, so the rounding of
+// the factors does not add up from step to step and the stop decisions are taken as in double.
+//
+// Error against double, ZH-L16C, over the 1440 plans of tests/tissue_kernel_check.cpp
+// (OC, CC and bailout, 30 to 120 m, 10 to 75 min, GF 30/70 to 100/100):
+//                         float    Q1.30
+//   compartment pressure  4e-6     7e-8     bar, largest absolute error over all steps
+//   ceiling               0.014    4e-4     mm, at GF 30, 80 and 100
+// The stop schedules of the corpus are identical to those of double, which the check enforces.
+//
+// The build uses double, DIVECOMPUTER_KERNEL_FLOAT or DIVECOMPUTER_KERNEL_FIXED select the others.
+
+// Signed Q-format number with FractionBits fraction bits, on 32 bits with 64 bit products
+template <int FractionBits>
+class FixedPoint {
+public:
+    static constexpr int32_t ONE = int32_t(1) << FractionBits;
+
+    constexpr FixedPoint() = default;
+    explicit FixedPoint(double value)
+        : m_raw(saturate(value * ONE + 0.5)) {}
+
+    static constexpr FixedPoint fromRaw(int32_t raw) { FixedPoint value; value.m_raw = raw; return value; }
+    explicit operator double() const { return static_cast<double>(m_raw) / ONE; }
+    constexpr int32_t raw() const { return m_raw; }
+
+    // Out of range results saturate to the largest or lowest value
+    friend constexpr FixedPoint operator+(FixedPoint a, FixedPoint b) { return fromRaw(saturate(int64_t(a.m_raw) + b.m_raw)); }
+    friend constexpr FixedPoint operator-(FixedPoint a, FixedPoint b) { return fromRaw(saturate(int64_t(a.m_raw) - b.m_raw)); }
+    friend constexpr FixedPoint operator-(FixedPoint a) { return fromRaw(saturate(-int64_t(a.m_raw))); }
+    friend constexpr FixedPoint operator*(FixedPoint a, FixedPoint b) {
+        return fromRaw(saturate((int64_t(a.m_raw) * b.m_raw + (int64_t(1) << (FractionBits - 1))) >> FractionBits));
+    }
+    friend constexpr FixedPoint operator/(FixedPoint a, FixedPoint b) {
+        if (b.m_raw == 0) return fromRaw(a.m_raw < 0 ? RAW_MIN : RAW_MAX);
+        return fromRaw(saturate((int64_t(a.m_raw) * ONE) / b.m_raw));
+    }
+
+    friend constexpr bool operator<(FixedPoint a, FixedPoint b) { return a.m_raw < b.m_raw; }
+    friend constexpr bool operator>(FixedPoint a, FixedPoint b) { return a.m_raw > b.m_raw; }
+    friend constexpr bool operator<=(FixedPoint a, FixedPoint b) { return a.m_raw <= b.m_raw; }
+    friend constexpr bool operator>=(FixedPoint a, FixedPoint b) { return a.m_raw >= b.m_raw; }
+
+private:
+    static constexpr int32_t RAW_MIN = std::numeric_limits<int32_t>::min();
+    static constexpr int32_t RAW_MAX = std::numeric_limits<int32_t>::max();
+
+    static constexpr int32_t saturate(int64_t raw) {
+        return raw < RAW_MIN ? RAW_MIN : raw > RAW_MAX ? RAW_MAX : static_cast<int32_t>(raw);
+    }
+    // Rounded down, NaN to 0
+    static int32_t saturate(double raw) {
+        if (!(raw == raw)) return 0;
+        if (raw <= double(RAW_MIN)) return RAW_MIN;
+        if (raw >= double(RAW_MAX)) return RAW_MAX;
+        return static_cast<int32_t>(std::floor(raw));
+    }
+
+    int32_t m_raw{0};
+};
+
+// Q1.30: up to 2, resolution 1e-9, for the factors of the exponential
+using Q30 = FixedPoint<30>;
+
+// Conversions of the kernel number types
+template <typename Real>
+struct KernelNumber {
+    static Real fromDouble(double value) { return static_cast<Real>(value); }
+    static double toDouble(Real value) { return static_cast<double>(value); }
+};
+
+template <int F>
+struct KernelNumber<FixedPoint<F>> {
+    static FixedPoint<F> fromDouble(double value) { return FixedPoint<F>(value); }
+    static double toDouble(FixedPoint<F> value) { return static_cast<double>(value); }
+};
+
+template <typename Real>
+class TissueKernel {
+public:
+    TissueKernel() {
+        const double ln2 = std::log(2.0);
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            const CompartmentParameters& compartment = g_buhlmannModel.getCompartment(j);
+            m_halfTimeN2[j] = compartment.m_halfTimeN2;
+            m_halfTimeHe[j] = compartment.m_halfTimeHe;
+            m_kN2[j] = ln2 / compartment.m_halfTimeN2;
+            m_kHe[j] = ln2 / compartment.m_halfTimeHe;
+        }
+    }
+
+    // Compartment pressures after a step of the given time, from those of the previous step
+    void saturate(const CompartmentPressures& previous, CompartmentPressures& current,
+                  double pAmbStart, double pAmbEnd, double time, double n2Percent, double hePercent) const {
+        if constexpr (std::is_same<Real, double>::value) {
+            for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+                double pN2 = getSchreinerEquation(previous[j].m_pN2, m_halfTimeN2[j], pAmbStart, pAmbEnd, time, n2Percent);
+                double pHe = getSchreinerEquation(previous[j].m_pHe, m_halfTimeHe[j], pAmbStart, pAmbEnd, time, hePercent);
+                current[j] = CompartmentPP(pN2, pHe, pN2 + pHe);
+            }
+        } else {
+            // Inspired pressure at the start of the step and its change over the step
+            const double pAmb = pAmbStart - g_constants.m_pH2O;
+            const double piN2 = pAmb * n2Percent / 100.0, piHe = pAmb * hePercent / 100.0;
+            const double riseN2 = (pAmbEnd - pAmbStart) * n2Percent / 100.0, riseHe = (pAmbEnd - pAmbStart) * hePercent / 100.0;
+
+            for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+                double eN2, lagN2, eHe, lagHe;
+                factors(time * m_kN2[j], eN2, lagN2);
+                factors(time * m_kHe[j], eHe, lagHe);
+                double pN2 = piN2 + (previous[j].m_pN2 - piN2) * eN2 + riseN2 * lagN2;
+                double pHe = piHe + (previous[j].m_pHe - piHe) * eHe + riseHe * lagHe;
+                current[j] = CompartmentPP(pN2, pHe, pN2 + pHe);
+            }
+        }
+    }
+
+    // Shallowest depth the compartments tolerate at the gradient factor, 0 at the surface
+    double ceiling(const CompartmentPressures& pressures, double n2Percent, double hePercent, double GF) const {
+        return ceilingPass(pressures, n2Percent, hePercent, GF, GF, nullptr);
+    }
+
+    // The same, with in limit the compartment and gas of the highest tolerated pressure at limitGF,
+    // found in the same pass: the ceiling a step shows and what holds it at the GF it is planned with
+    double ceiling(const CompartmentPressures& pressures, double n2Percent, double hePercent, double GF,
+                   double limitGF, TissueLimit& limit) const {
+        return ceilingPass(pressures, n2Percent, hePercent, GF, limitGF, &limit);
+    }
+
+    // Highest percent of the surface M-value over the compartments and gases, 0 when all are
+    // below the surface pressure, with the compartment and gas reaching it in limit.
+    // In double whatever the kernel type: it is shown, not iterated on.
+    double gfSurface(const CompartmentPressures& actual, const CompartmentPressures& surfaceMax, double atmPressure,
+                     TissueLimit& limit) const {
+        limit = TissueLimit();
+        double GF_surface = 0;
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            keepHighest(GF_surface, (actual[j].m_pN2    - atmPressure) / (surfaceMax[j].m_pN2    - atmPressure) * 100, limit, j, LimitingGas::N2);
+            keepHighest(GF_surface, (actual[j].m_pHe    - atmPressure) / (surfaceMax[j].m_pHe    - atmPressure) * 100, limit, j, LimitingGas::HE);
+            keepHighest(GF_surface, (actual[j].m_pInert - atmPressure) / (surfaceMax[j].m_pInert - atmPressure) * 100, limit, j, LimitingGas::INERT);
+        }
+        return GF_surface;
+    }
+
+    // True if a compartment is above its M-value adjusted for the GF, in double as the ceiling
+    bool breaching(const CompartmentPressures& actual, const CompartmentPressures& limits) const {
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            if (actual[j].m_pN2 > limits[j].m_pN2 ||
+                actual[j].m_pHe > limits[j].m_pHe ||
+                actual[j].m_pInert > limits[j].m_pInert) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    double m_halfTimeN2[NUM_COMPARTMENTS];
+    double m_halfTimeHe[NUM_COMPARTMENTS];
+    double m_kN2[NUM_COMPARTMENTS];   // rate constants, ln2 / half-time
+    double m_kHe[NUM_COMPARTMENTS];
+
+    // std::max keeping the first of equal values, recording where the highest comes from
+    template <typename T>
+    static void keepHighest(T& highest, T value, TissueLimit& limit, int compartment, LimitingGas gas) {
+        if (highest < value) {
+            highest = value;
+            limit.m_compartment = compartment;
+            limit.m_gas = gas;
+        }
+    }
+
+    // In double whatever the kernel type: the stop decisions are taken on it
+    double ceilingPass(const CompartmentPressures& pressures, double n2Percent, double hePercent, double GF,
+                       double limitGF, TissueLimit* limit) const {
+        // The ceiling is the depth of the highest tolerated pressure
+        double ratioN2He = 1;
+        double totalInertPercent = n2Percent + hePercent;
+        if (totalInertPercent != 0) {
+            ratioN2He = n2Percent / totalInertPercent;
+        }
+
+        double pAmbMin = -std::numeric_limits<double>::infinity();
+        double pAmbMinLimit = -std::numeric_limits<double>::infinity();
+        if (limit) *limit = TissueLimit();
+        for (int j = 0; j < NUM_COMPARTMENTS; j++) {
+            const CompartmentParameters& compartment = g_buhlmannModel.getCompartment(j);
+            double aInert = compartment.m_aN2 * ratioN2He + compartment.m_aHe * (1 - ratioN2He);
+            double bInert = compartment.m_bN2 * ratioN2He + compartment.m_bHe * (1 - ratioN2He);
+
+            // N2, He and inert, in the order of LimitingGas
+            const double p[3] = {pressures[j].m_pN2, pressures[j].m_pHe, pressures[j].m_pInert};
+            const double a[3] = {compartment.m_aN2, compartment.m_aHe, aInert};
+            const double b[3] = {compartment.m_bN2, compartment.m_bHe, bInert};
+            for (int gas = 0; gas < 3; gas++) {
+                pAmbMin = std::max(pAmbMin, toleratedPressure(p[gas], a[gas], b[gas], GF));
+                if (limit) {
+                    keepHighest(pAmbMinLimit, toleratedPressure(p[gas], a[gas], b[gas], limitGF), *limit, j,
+                                static_cast<LimitingGas>(gas));
+                }
+            }
+        }
+        return std::max(0.0, getDepthFromPressure(pAmbMin));
+    }
+
+    static double toleratedPressure(double p, double a, double b, double GF) {
+        return (p - a * GF / 100) / (1 + (1 / b - 1) * GF / 100);
+    }
+
+    // Factors of the Schreiner equation for x = k t: p = pi + (p0 - pi) e + rise lag,
+    // with e = e^-x and lag = 1 - (1 - e^-x) / x
+    static void factors(double x, double& e, double& lag) {
+        if (x > 700.0) {
+            e = 0.0;
+            lag = 1.0 - 1.0 / x;
+            return;
+        }
+
+        // e^-x = 2^-n e^r with r = n ln2 - x, |r| <= ln2 / 2, and e^r by its series to r^7
+        double n = std::floor(x * 1.4426950408889634 + 0.5);
+        const Real r = KernelNumber<Real>::fromDouble(n * 0.6931471805599453 - x);
+        const Real c1 = KernelNumber<Real>::fromDouble(1.0), c2 = KernelNumber<Real>::fromDouble(1.0 / 2.0),
+                   c3 = KernelNumber<Real>::fromDouble(1.0 / 6.0), c4 = KernelNumber<Real>::fromDouble(1.0 / 24.0),
+                   c5 = KernelNumber<Real>::fromDouble(1.0 / 120.0), c6 = KernelNumber<Real>::fromDouble(1.0 / 720.0),
+                   c7 = KernelNumber<Real>::fromDouble(1.0 / 5040.0);
+        Real p = c1 + r * (c1 + r * (c2 + r * (c3 + r * (c4 + r * (c5 + r * (c6 + r * c7))))));
+        e = std::ldexp(KernelNumber<Real>::toDouble(p), -static_cast<int>(n));
+        if (x < 0.25) {
+            // 1 - (1 - e^-x) / x = x/2 - x^2/6 + x^3/24 - x^4/120 + x^5/720 - x^6/5040, which cancels less
+            const Real y = KernelNumber<Real>::fromDouble(x);
+            lag = KernelNumber<Real>::toDouble(y * (c2 - y * (c3 - y * (c4 - y * (c5 - y * (c6 - y * c7))))));
+        } else {
+            lag = 1.0 - (1.0 - e) / x;
+        }
+    }
+};
+
+#if defined(DIVECOMPUTER_KERNEL_FIXED)
+using TissueReal = Q30;
+#elif defined(DIVECOMPUTER_KERNEL_FLOAT)
+using TissueReal = float;
+#else
+using TissueReal = double;
+#endif
+
+// Kernel of the build, set up on first use from the Buhlmann parameters
+inline const TissueKernel<TissueReal>& tissueKernel() {
+    static const TissueKernel<TissueReal> kernel;
+    return kernel;
+}
+
+} // namespace DiveComputer
+
+#endif // TISSUE_KERNEL_HPP